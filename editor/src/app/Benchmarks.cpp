@@ -0,0 +1,595 @@
+#include "Benchmarks.h"
+#include "../core/compiler/StGenerator.h"
+#include "../core/models/ProjectModel.h"
+#include "../editor/items/FunctionBlockItem.h"
+#include "../editor/items/WireItem.h"
+#include "../editor/scene/BackgroundTiles.h"
+#include "../editor/scene/LadderScene.h"
+#include "../editor/scene/PlcOpenViewer.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// ───────────────────────────────────────────────────────────────────────────
+// 公共工具
+// ───────────────────────────────────────────────────────────────────────────
+
+// 进程峰值 RSS（KB），不支持的平台返回 -1
+static long peakRssKb()
+{
+#if defined(Q_OS_UNIX)
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+#if defined(Q_OS_MACOS)
+    return long(ru.ru_maxrss / 1024);   // macOS 以字节为单位
+#else
+    return long(ru.ru_maxrss);
+#endif
+#else
+    return -1;
+#endif
+}
+
+static QTextStream& out()
+{
+    static QTextStream s(stdout);
+    return s;
+}
+
+// 参数中的正整数列表；为空时用默认值
+static QList<int> sizesOr(const QStringList& args, const QList<int>& defaults)
+{
+    QList<int> r;
+    for (const QString& a : args) {
+        bool ok = false;
+        const int n = a.toInt(&ok);
+        if (ok && n > 0) r << n;
+    }
+    return r.isEmpty() ? defaults : r;
+}
+
+// ───────────────────────────────────────────────────────────────────────────
+// st-fbd：合成 FBD 程序体
+//
+// 每组 4 个图元：inVariable → ADD → MAX → outVariable，5 条连线。
+// ADD 的 IN2 接上一组 ADD 的输出，32 组为一条链；链尾一组的输出改为
+// inOutVariable，并反馈到链首 ADD 的 IN2，构成需要打断的环路。
+// layout = true 时附带 <position>/<relPosition>（每条链一列、每组一行），
+// 供场景类基准在 PlcOpenViewer 中加载。
+// ───────────────────────────────────────────────────────────────────────────
+static void appendFbdGroups(QString& x, int groups, bool layout = false)
+{
+    auto rel = [layout](int rx, int ry) {
+        return layout ? QString("<relPosition x=\"%1\" y=\"%2\"/>").arg(rx).arg(ry) : QString();
+    };
+    auto at = [layout](int px, int py) {
+        return layout ? QString("<position x=\"%1\" y=\"%2\"/>").arg(px).arg(py) : QString();
+    };
+    auto conn = [&rel](int ref, const char* port, int ry) {
+        return port ? QString("<connectionPointIn>%1<connection refLocalId=\"%2\" "
+                              "formalParameter=\"%3\"/></connectionPointIn>")
+                          .arg(rel(0, ry)).arg(ref).arg(port)
+                    : QString("<connectionPointIn>%1<connection refLocalId=\"%2\"/>"
+                              "</connectionPointIn>").arg(rel(0, ry)).arg(ref);
+    };
+    auto dim = [layout](int w, int h) {
+        return layout ? QString(" width=\"%1\" height=\"%2\"").arg(w).arg(h) : QString();
+    };
+    const QString out = layout ? QString("<connectionPointOut>%1</connectionPointOut>").arg(rel(60, 10))
+                               : QString();
+
+    for (int g = 0; g < groups; ++g) {
+        const int base = g * 4 + 1;
+        const bool head = g % 32 == 0;
+        const bool tail = g % 32 == 31;
+        const int  px   = (g / 32) * 400;
+        const int  py   = (g % 32) * 60;
+
+        x += QString("<inVariable localId=\"%1\"%2>%3%4"
+                     "<expression>i%5</expression></inVariable>\n")
+             .arg(base).arg(dim(60, 20), at(px, py), out).arg(g);
+
+        // ADD：IN2 接上一组 ADD；链首接链尾的反馈变量（不足一条链时接本组输入）
+        QString in2;
+        if (!head)                 in2 = conn(base - 3, "OUT", 30);
+        else if (g + 31 < groups)  in2 = conn(base + 31 * 4 + 3, nullptr, 30);
+        else                       in2 = conn(base, nullptr, 30);
+        x += QString("<block localId=\"%1\" typeName=\"ADD\"%2>%3"
+                     "<inputVariables>"
+                     "<variable formalParameter=\"IN1\">%4</variable>"
+                     "<variable formalParameter=\"IN2\">%5</variable>"
+                     "</inputVariables><outputVariables>"
+                     "<variable formalParameter=\"OUT\">%6</variable></outputVariables></block>\n")
+             .arg(base + 1).arg(dim(60, 40), at(px + 100, py), conn(base, nullptr, 10), in2, out);
+
+        x += QString("<block localId=\"%1\" typeName=\"MAX\"%2>%3"
+                     "<inputVariables>"
+                     "<variable formalParameter=\"IN1\">%4</variable>"
+                     "<variable formalParameter=\"IN2\">%5</variable>"
+                     "</inputVariables><outputVariables>"
+                     "<variable formalParameter=\"OUT\">%6</variable></outputVariables></block>\n")
+             .arg(base + 2).arg(dim(60, 40), at(px + 200, py), conn(base + 1, "OUT", 10),
+                                conn(base, nullptr, 30), out);
+
+        x += QString("<%1 localId=\"%2\"%3>%4%5"
+                     "<expression>%6%7</expression></%1>\n")
+             .arg(tail ? "inOutVariable" : "outVariable").arg(base + 3)
+             .arg(dim(60, 20), at(px + 300, py), conn(base + 2, "OUT", 10),
+                  tail ? QStringLiteral("fb") : QStringLiteral("q")).arg(g);
+    }
+}
+
+static QString syntheticFbdProject(int elements)
+{
+    const int groups = std::max(1, elements / 4);
+    QString x;
+    x.reserve(groups * 1024);
+    x += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         "<project xmlns=\"http://www.plcopen.org/xml/tc6_0201\">\n"
+         "<types><dataTypes/><pous>\n"
+         "<pou name=\"bench\" pouType=\"program\"><interface/><body><FBD>\n";
+    appendFbdGroups(x, groups);
+    x += "</FBD></body></pou>\n</pous></types>\n"
+         "<instances><configurations/></instances>\n</project>\n";
+    return x;
+}
+
+static int benchStFbd(const QStringList& args)
+{
+    for (int n : sizesOr(args, {10000, 100000})) {
+        const QString xml = syntheticFbdProject(n);
+
+        QElapsedTimer t;
+        t.start();
+        const QString st = StGenerator::fromXml(xml);
+        const qint64 ms = t.elapsed();
+
+        if (st.isEmpty()) {
+            out() << "st-fbd elements=" << n << " error=" << StGenerator::lastError() << Qt::endl;
+            return 1;
+        }
+        out() << "st-fbd elements=" << (n / 4) * 4
+              << " xml_kb=" << xml.size() / 1024
+              << " ms=" << ms
+              << " st_lines=" << st.count('\n') + 1
+              << " peak_rss_kb=" << peakRssKb() << Qt::endl;
+    }
+    return 0;
+}
+
+// ───────────────────────────────────────────────────────────────────────────
+// plcopen-load：合成多 MB PLCopen 工程
+//
+// ST 与 FBD 程序交替（各带 32 个有注释的接口变量），边生成边写入临时文件，
+// 生成过程不占用与文件同量级的内存。依次计时：
+//   StGenerator::fromFile → ProjectModel::loadFromFile → ProjectModel::saveToFile
+// 每步之后输出一次峰值 RSS。
+// ───────────────────────────────────────────────────────────────────────────
+static bool writeSyntheticProject(const QString& path, qint64 bytes, int* pouCount,
+                                  int pouLimit = 0, int fbdGroups = 64)
+{
+    QFile f(path);
+    if (!f.open(QFile::WriteOnly)) return false;
+
+    f.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<project xmlns=\"http://www.plcopen.org/xml/tc6_0201\" "
+            "xmlns:xhtml=\"http://www.w3.org/1999/xhtml\">\n"
+            "<fileHeader companyName=\"bench\" productVersion=\"1\" "
+            "creationDateTime=\"2024-01-01T00:00:00\"/>\n"
+            "<contentHeader name=\"bench\" modificationDateTime=\"2024-01-01T00:00:00\"/>\n"
+            "<types><dataTypes/><pous>\n");
+
+    int n = 0;
+    QString x;
+    while (pouLimit > 0 ? n < pouLimit : f.size() < bytes) {
+        const bool fbd = n % 2;
+        x.clear();
+        x += QString("<pou name=\"p%1\" pouType=\"program\"><interface><localVars>\n").arg(n);
+        for (int v = 0; v < 32; ++v)
+            x += QString("<variable name=\"v%1\"><type><INT/></type>"
+                         "<initialValue><simpleValue value=\"%1\"/></initialValue>"
+                         "<documentation><xhtml:p><![CDATA[variable %1 of p%2]]></xhtml:p>"
+                         "</documentation></variable>\n").arg(v).arg(n);
+        x += "</localVars></interface><body>";
+        if (fbd) {
+            x += "<FBD>\n";
+            appendFbdGroups(x, fbdGroups);
+            x += "</FBD>";
+        } else {
+            x += "<ST><xhtml:p><![CDATA[";
+            for (int l = 0; l < 200; ++l)
+                x += QString("v%1 := v%2 + %3;\n").arg(l % 32).arg((l + 1) % 32).arg(l);
+            x += "]]></xhtml:p></ST>";
+        }
+        x += "</body></pou>\n";
+        f.write(x.toUtf8());
+        ++n;
+    }
+
+    f.write("</pous></types>\n<instances><configurations>\n"
+            "<configuration name=\"config\"><resource name=\"res\">\n"
+            "<task name=\"main\" interval=\"T#10ms\" priority=\"0\">"
+            "<pouInstance name=\"inst0\" typeName=\"p0\"/></task>\n"
+            "</resource></configuration>\n"
+            "</configurations></instances>\n</project>\n");
+    *pouCount = n;
+    return true;
+}
+
+static int benchPlcOpenLoad(const QStringList& args)
+{
+    for (int mb : sizesOr(args, {8})) {
+        QTemporaryDir dir;
+        const QString src = dir.filePath("bench.tizi");
+        int pous = 0;
+        if (!dir.isValid() || !writeSyntheticProject(src, qint64(mb) << 20, &pous)) {
+            out() << "plcopen-load mb=" << mb << " error=cannot write " << src << Qt::endl;
+            return 1;
+        }
+        const qint64 kb = QFileInfo(src).size() / 1024;
+        out() << "plcopen-load xml_kb=" << kb << " pous=" << pous
+              << " stage=generate peak_rss_kb=" << peakRssKb() << Qt::endl;
+
+        QElapsedTimer t;
+        t.start();
+        const QString st = StGenerator::fromFile(src);
+        out() << "plcopen-load xml_kb=" << kb << " stage=st ms=" << t.elapsed()
+              << " st_kb=" << st.size() / 1024
+              << " threads=" << QThreadPool::globalInstance()->maxThreadCount()
+              << " peak_rss_kb=" << peakRssKb() << Qt::endl;
+        if (st.isEmpty()) {
+            out() << "plcopen-load error=" << StGenerator::lastError() << Qt::endl;
+            return 1;
+        }
+
+        ProjectModel model;
+        t.restart();
+        if (!model.loadFromFile(src)) {
+            out() << "plcopen-load error=cannot load " << src << Qt::endl;
+            return 1;
+        }
+        out() << "plcopen-load xml_kb=" << kb << " stage=load ms=" << t.elapsed()
+              << " pous=" << model.pous.size()
+              << " peak_rss_kb=" << peakRssKb() << Qt::endl;
+
+        const QString dst = dir.filePath("saved.tizi");
+        t.restart();
+        if (!model.saveToFile(dst)) {
+            out() << "plcopen-load error=cannot save " << dst << Qt::endl;
+            return 1;
+        }
+        out() << "plcopen-load xml_kb=" << kb << " stage=save ms=" << t.elapsed()
+              << " out_kb=" << QFileInfo(dst).size() / 1024
+              << " peak_rss_kb=" << peakRssKb() << Qt::endl;
+    }
+    return 0;
+}
+
+// ───────────────────────────────────────────────────────────────────────────
+// project-open：500 个 POU（ST / FBD 交替）的工程读档、打开单个 POU 与存档
+//
+// 每个 FBD 程序体含 G 组（默认 8 / 64 / 256）功能块。读档只扫描图形程序体并
+// 压缩保存其源文本切片，打开 POU 时才序列化并构建场景；未打开的程序体存档时
+// 原样写回。load_rss_kb 为读档后的峰值 RSS（峰值只增不减，比较时每次只跑一个 G）。
+// ───────────────────────────────────────────────────────────────────────────
+static int benchProjectOpen(const QStringList& args)
+{
+    constexpr int kPous = 500;
+
+    for (int groups : sizesOr(args, {8, 64, 256})) {
+        QTemporaryDir dir;
+        const QString src = dir.filePath("bench.tizi");
+        int pous = 0;
+        if (!dir.isValid() || !writeSyntheticProject(src, 0, &pous, kPous, groups)) {
+            out() << "project-open groups=" << groups << " error=cannot write " << src << Qt::endl;
+            return 1;
+        }
+
+        ProjectModel model;
+        QElapsedTimer t;
+        t.start();
+        if (!model.loadFromFile(src)) {
+            out() << "project-open error=cannot load " << src << Qt::endl;
+            return 1;
+        }
+        const qint64 loadMs  = t.elapsed();
+        const long   loadRss = peakRssKb();
+
+        // p1 为第一个 FBD 程序：取程序体 + 构建场景，与编辑器打开标签页相同
+        PouModel* pou = model.findPou("p1");
+        if (!pou || !pou->hasGraphical()) {
+            out() << "project-open error=p1 has no graphical body" << Qt::endl;
+            return 1;
+        }
+        PlcOpenViewer viewer;
+        t.restart();
+        viewer.loadFromXmlString(pou->graphicalXml());
+        const qint64 openMs = t.elapsed();
+
+        const QString dst = dir.filePath("saved.tizi");
+        t.restart();
+        if (!model.saveToFile(dst)) {
+            out() << "project-open error=cannot save " << dst << Qt::endl;
+            return 1;
+        }
+        const qint64 saveMs = t.elapsed();
+
+        out() << "project-open pous=" << pous << " groups=" << groups
+              << " xml_kb=" << QFileInfo(src).size() / 1024
+              << " load_ms=" << loadMs
+              << " load_rss_kb=" << loadRss
+              << " open_pou_ms=" << openMs
+              << " save_ms=" << saveMs
+              << " peak_rss_kb=" << peakRssKb() << Qt::endl;
+    }
+    return 0;
+}
+
+// ───────────────────────────────────────────────────────────────────────────
+// wire-move：在 W 条连线的 FBD 图中反复移动同一个功能块
+//
+// 每次移动后立即 flushWires()，只重排该块相连的导线；同时给出一次全量
+// updateAllWires() 的耗时作对照。移动耗时应与 W 无关。
+// ───────────────────────────────────────────────────────────────────────────
+static int benchWireMove(const QStringList& args)
+{
+    constexpr int kMoves = 1000;
+    constexpr int kFull  = 20;
+
+    for (int wires : sizesOr(args, {1000, 5000, 20000})) {
+        QString body = "FBD\n<FBD>\n";
+        appendFbdGroups(body, std::max(1, wires / 5), true);
+        body += "</FBD>\n";
+
+        PlcOpenViewer viewer;
+        QElapsedTimer t;
+        t.start();
+        viewer.loadFromXmlString(body);
+        const qint64 loadMs = t.elapsed();
+
+        // 第一条链中间一组的 ADD（localId 4k+2）：IN1、IN2 与 OUT 的两条去向，共 4 条导线
+        QGraphicsItem* block = nullptr;
+        int wireCount = 0;
+        const int target = std::min(std::max(1, wires / 5) - 1, 16) * 4 + 2;
+        for (QGraphicsItem* gi : viewer.items()) {
+            if (qgraphicsitem_cast<WireItem*>(gi)) ++wireCount;
+            else if (qgraphicsitem_cast<FunctionBlockItem*>(gi) && gi->data(0).toInt() == target)
+                block = gi;
+        }
+        if (!block) {
+            out() << "wire-move wires=" << wires << " error=block not found" << Qt::endl;
+            return 1;
+        }
+
+        const QPointF p0 = block->pos();
+        t.restart();
+        for (int k = 0; k < kMoves; ++k) {
+            block->setPos(p0 + QPointF((k % 2) ? 20 : 40, 0));
+            viewer.flushWires();
+        }
+        const double moveUs = t.nsecsElapsed() / 1000.0 / kMoves;
+
+        t.restart();
+        for (int k = 0; k < kFull; ++k)
+            viewer.updateAllWires();
+        const double fullUs = t.nsecsElapsed() / 1000.0 / kFull;
+
+        out() << "wire-move wires=" << wireCount
+              << " load_ms=" << loadMs
+              << " move_us=" << QString::number(moveUs, 'f', 1)
+              << " full_reroute_us=" << QString::number(fullUs, 'f', 1)
+              << " peak_rss_kb=" << peakRssKb() << Qt::endl;
+    }
+    return 0;
+}
+
+// ───────────────────────────────────────────────────────────────────────────
+// fbd-save：N 个图元的 FBD 图序列化（toXmlString）
+//
+// 图元坐标与导线折点按 localId 写回 body DOM，耗时应随 N 线性增长。
+// 首次调用含导线落定，单独列出；之后取 kSaves 次平均。
+// ───────────────────────────────────────────────────────────────────────────
+static int benchFbdSave(const QStringList& args)
+{
+    constexpr int kSaves = 5;
+
+    for (int n : sizesOr(args, {5000, 20000})) {
+        QString body = "FBD\n<FBD>\n";
+        appendFbdGroups(body, std::max(1, n / 4), true);
+        body += "</FBD>\n";
+
+        PlcOpenViewer viewer;
+        QElapsedTimer t;
+        t.start();
+        viewer.loadFromXmlString(body);
+        const qint64 loadMs = t.elapsed();
+
+        t.restart();
+        qint64 xmlBytes = viewer.toXmlString().toUtf8().size();
+        const qint64 firstMs = t.elapsed();
+
+        t.restart();
+        for (int k = 0; k < kSaves; ++k)
+            xmlBytes = viewer.toXmlString().toUtf8().size();
+        const double saveMs = t.nsecsElapsed() / 1e6 / kSaves;
+
+        out() << "fbd-save elements=" << std::max(1, n / 4) * 4
+              << " load_ms=" << loadMs
+              << " first_save_ms=" << firstMs
+              << " save_ms=" << QString::number(saveMs, 'f', 1)
+              << " xml_kb=" << xmlBytes / 1024
+              << " peak_rss_kb=" << peakRssKb() << Qt::endl;
+    }
+    return 0;
+}
+
+// ───────────────────────────────────────────────────────────────────────────
+// ladder-scroll：LD 背景逐帧滚动
+//
+// 1280×800（逻辑像素）的视口从梯形图顶端滚到底端（整个 sceneRect，约 2000
+// 场景单位高），每帧 40 逻辑像素，经 QGraphicsScene::render 绘入 QImage，
+// 与视图重绘背景走同一路径。每个缩放比例 × DPR 分别给出直接绘制与瓦片缓存的
+// 平均 / 最大帧耗时；瓦片模式的首轮含预渲染，单独列出。
+// ───────────────────────────────────────────────────────────────────────────
+static int benchLadderScroll(const QStringList& args)
+{
+    constexpr int kW = 1280, kH = 800, kStep = 40, kFrames = 200;
+
+    LadderScene scene;
+    const QRectF full = scene.sceneRect();
+
+    for (int pct : sizesOr(args, {25, 50, 100, 200})) {
+        const qreal z    = pct / 100.0;
+        const qreal visH = kH / z;
+        QList<qreal> tops;                  // 一轮滚动中各帧视口顶端
+        for (qreal y = full.top(); ; y += kStep / z) {
+            tops << std::max(full.top(), std::min(y, full.bottom() - visH));
+            if (y + visH >= full.bottom()) break;
+        }
+
+        for (qreal dpr : {1.0, 2.0}) {
+            QImage img(int(kW * dpr), int(kH * dpr), QImage::Format_ARGB32_Premultiplied);
+            img.setDevicePixelRatio(dpr);
+
+            auto frames = [&](int n, double& avgUs, double& maxUs) {
+                QElapsedTimer t;
+                qint64 sum = 0, worst = 0;
+                for (int k = 0; k < n; ++k) {
+                    const QRectF src(full.left(), tops[k % tops.size()], kW / z, visH);
+                    t.start();
+                    {
+                        QPainter p(&img);
+                        p.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing);
+                        scene.render(&p, QRectF(0, 0, kW, kH), src, Qt::IgnoreAspectRatio);
+                    }
+                    const qint64 ns = t.nsecsElapsed();
+                    sum  += ns;
+                    worst = std::max(worst, ns);
+                }
+                avgUs = sum / 1000.0 / n;
+                maxUs = worst / 1000.0;
+            };
+            auto line = [&](const char* mode) -> QTextStream& {
+                return out() << "ladder-scroll zoom=" << pct << " dpr=" << dpr
+                             << " mode=" << mode << " frames=" << kFrames;
+            };
+            double avgUs = 0, maxUs = 0, coldUs = 0, coldMaxUs = 0;
+
+            BackgroundTiles::setEnabled(false);
+            frames(kFrames, avgUs, maxUs);
+            line("direct") << " frame_us=" << QString::number(avgUs, 'f', 1)
+                           << " max_us=" << QString::number(maxUs, 'f', 1) << Qt::endl;
+
+            BackgroundTiles::setEnabled(true);
+            frames(tops.size(), coldUs, coldMaxUs);
+            frames(kFrames, avgUs, maxUs);
+            line("tiles") << " frame_us=" << QString::number(avgUs, 'f', 1)
+                          << " max_us=" << QString::number(maxUs, 'f', 1)
+                          << " cold_frame_us=" << QString::number(coldUs, 'f', 1)
+                          << " peak_rss_kb=" << peakRssKb() << Qt::endl;
+        }
+    }
+    return 0;
+}
+
+// ───────────────────────────────────────────────────────────────────────────
+// fbd-pan：大型 FBD 图在不同缩放下的平移帧耗时
+//
+// N 个图元的 FBD 图（默认 20000）载入 PlcOpenViewer，1280×800 视口沿图的
+// 对角线平移 kFrames 帧，经 QGraphicsScene::render 绘入 QImage。缩放 10% / 25%
+// 落在只画实心轮廓的细节层级，50% 只画名称，100% 完整绘制。
+// ───────────────────────────────────────────────────────────────────────────
+static int benchFbdPan(const QStringList& args)
+{
+    constexpr int kW = 1280, kH = 800, kFrames = 120;
+
+    for (int n : sizesOr(args, {20000})) {
+        QString body = "FBD\n<FBD>\n";
+        appendFbdGroups(body, std::max(1, n / 4), true);
+        body += "</FBD>\n";
+
+        PlcOpenViewer viewer;
+        viewer.loadFromXmlString(body);
+        const QRectF bounds = viewer.itemsBoundingRect();
+        QImage img(kW, kH, QImage::Format_ARGB32_Premultiplied);
+
+        for (int pct : {10, 25, 50, 100}) {
+            const qreal z = pct / 100.0;
+            const QSizeF vis(kW / z, kH / z);
+            const QPointF span(std::max(0.0, bounds.width()  - vis.width()),
+                               std::max(0.0, bounds.height() - vis.height()));
+            QElapsedTimer t;
+            qint64 sum = 0, worst = 0;
+            for (int k = 0; k < kFrames; ++k) {
+                const qreal f = qreal(k) / (kFrames - 1);
+                const QRectF src(bounds.topLeft() + span * f, vis);
+                t.start();
+                {
+                    QPainter p(&img);
+                    p.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing);
+                    viewer.render(&p, QRectF(0, 0, kW, kH), src, Qt::IgnoreAspectRatio);
+                }
+                const qint64 ns = t.nsecsElapsed();
+                sum  += ns;
+                worst = std::max(worst, ns);
+            }
+            out() << "fbd-pan elements=" << std::max(1, n / 4) * 4 << " zoom=" << pct
+                  << " frames=" << kFrames
+                  << " frame_us=" << QString::number(sum / 1000.0 / kFrames, 'f', 1)
+                  << " max_us=" << QString::number(worst / 1000.0, 'f', 1)
+                  << " peak_rss_kb=" << peakRssKb() << Qt::endl;
+        }
+    }
+    return 0;
+}
+
+// ───────────────────────────────────────────────────────────────────────────
+// 基准表
+// ───────────────────────────────────────────────────────────────────────────
+struct Bench {
+    const char* name;
+    const char* usage;
+    std::function<int(const QStringList&)> run;
+};
+
+static const QList<Bench>& benches()
+{
+    static const QList<Bench> list = {
+        { "st-fbd",       "[N...]   FBD -> ST conversion of a synthetic N-element body", benchStFbd },
+        { "plcopen-load", "[MB...]  stream load / ST / save of a synthetic MB-sized project", benchPlcOpenLoad },
+        { "project-open", "[G...] open a 500-POU project with G FBD groups per body, open one POU, save", benchProjectOpen },
+        { "wire-move",    "[W...]   move one block in a W-wire FBD diagram (incremental re-routing)", benchWireMove },
+        { "fbd-save",     "[N...]   serialize an N-element FBD diagram (toXmlString)", benchFbdSave },
+        { "ladder-scroll", "[Z%...] scroll the LD background at zoom Z% (direct vs cached tiles)", benchLadderScroll },
+        { "fbd-pan",      "[N...]   pan across an N-element FBD diagram at 10/25/50/100% zoom", benchFbdPan },
+    };
+    return list;
+}
+
+} // namespace
+
+int Benchmarks::run(const QStringList& args)
+{
+    const QString name = args.value(0);
+    for (const Bench& b : benches())
+        if (name == b.name) return b.run(args.mid(1));
+
+    out() << "usage: TiZi --bench <name> [args...]" << Qt::endl;
+    for (const Bench& b : benches())
+        out() << "  " << b.name << " " << b.usage << Qt::endl;
+    return name.isEmpty() ? 0 : 2;
+}
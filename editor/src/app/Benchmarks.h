@@ -0,0 +1,23 @@
+#pragma once
+#include <QStringList>
+
+// ─────────────────────────────────────────────────────────────
+// Benchmarks — 命令行性能基准（TiZi --bench <名称> [参数...]）
+//
+// 不创建主窗口，结果逐行输出到 stdout（key=value，便于脚本比较）。
+// 每行附带进程峰值 RSS；峰值只增不减，比较内存时每次只跑一个规模。
+// 需要 QGraphicsScene 的基准在无显示环境下用 QT_QPA_PLATFORM=offscreen 运行。
+//
+//   st-fbd [N...]         合成 FBD 程序体（默认 10000 / 100000 图元）→ ST 的转换耗时
+//   plcopen-load [MB...]  合成 MB 级 PLCopen 工程（默认 8 MB）的 ST 生成 / 读档 / 存档耗时
+//   project-open [G...]   500 个 POU、每个 FBD 程序体 G 组（默认 8 / 64 / 256）的工程读档 / 打开单个 POU / 存档耗时及读档后峰值 RSS
+//   wire-move [W...]      W 条连线（默认 1000 / 5000 / 20000）的 FBD 图中移动单个功能块的导线重排耗时
+//   fbd-save [N...]       N 图元（默认 5000 / 20000）的 FBD 图序列化（toXmlString）耗时
+//   ladder-scroll [Z%...] 缩放 Z%（默认 25 / 50 / 100 / 200）下整幅梯形图背景滚动的单帧耗时
+//   fbd-pan [N...]        N 图元（默认 20000）的 FBD 图在 10% … 100% 缩放下平移的单帧耗时
+// ─────────────────────────────────────────────────────────────
+class Benchmarks {
+public:
+    /// args 为 --bench 之后的参数；返回进程退出码
+    static int run(const QStringList& args);
+};
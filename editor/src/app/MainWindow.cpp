@@ -36,7 +36,6 @@
 #include <QFile>
 #include <QDir>
 #include <QFileInfo>
-#include <QProcess>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -50,6 +49,7 @@
 #include <QGroupBox>
 #include <QApplication>
 #include <QDrag>
+#include <QSet>
 #include <QMimeData>
 
 #include "../editor/scene/LadderScene.h"
@@ -58,7 +58,7 @@
 #include "../utils/StHighlighter.h"
 #include "../utils/TreeBranchStyle.h"
 #include "../core/compiler/CodeGenerator.h"
-#include "../core/compiler/StGenerator.h"
+#include "../core/compiler/BuildPipeline.h"
 #include "BlockPropertiesDialog.h"
 #include "../comm/DownloadDialog.h"
 
@@ -92,7 +92,9 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_projectManager, &ProjectManager::projectCreated,
             this, [this](ProjectModel* newProj) {
         closeAllPouTabs();
+        qDeleteAll(m_sceneMap);
         m_sceneMap.clear();
+        m_sceneLru.clear();
         if (m_projPropSubWin) m_projPropSubWin->close();
 
         delete m_project;
@@ -111,6 +113,16 @@ MainWindow::MainWindow(QWidget *parent)
         statusBar()->showMessage(msg, ms);
     });
 
+    // ── BuildPipeline：异步构建，输出逐行进入控制台 ─────────────────
+    m_buildPipeline = new BuildPipeline(this);
+    connect(m_buildPipeline, &BuildPipeline::output,
+            m_consoleEdit, &QPlainTextEdit::appendPlainText);
+    connect(m_buildPipeline, &BuildPipeline::finished,
+            this, [this](bool ok, const QString&, const QString& summary) {
+        m_aCancelBuild->setEnabled(false);
+        statusBar()->showMessage(summary, ok ? 5000 : 4000);
+    });
+
     // 创建启动示例项目（触发上面的信号链）
     m_projectManager->buildDefaultProject();
 
@@ -134,6 +146,12 @@ MainWindow::~MainWindow()
         for (QMdiSubWindow* sw : m_mdiArea->subWindowList())
             sw->disconnect(this);
     }
+    // 构建进行中退出：先断开再终止子进程，避免 finished 回调访问已析构的状态栏
+    if (m_buildPipeline) {
+        m_buildPipeline->disconnect(this);
+        m_buildPipeline->disconnect(m_consoleEdit);
+        m_buildPipeline->cancel();
+    }
 }
 
 // ============================================================
@@ -179,14 +197,16 @@ void MainWindow::setupMenuBar()
     auto* aBuildActive = plcMenu->addAction(
         QIcon(":/images/Build.png"), "Build Active Resource\tCtrl+B");
     aBuildActive->setShortcut(QKeySequence("Ctrl+B"));
-    connect(aBuildActive, &QAction::triggered, this, &MainWindow::buildProject);
+    connect(aBuildActive, &QAction::triggered, this, [this]{ buildProject(); });
 
+    // Rebuild：忽略构建缓存，重新执行 matiec 并编译全部目标文件
     auto* aRebuild = plcMenu->addAction(
         QIcon(":/images/Clean.png"), "Rebuild Active Resource");
-    connect(aRebuild, &QAction::triggered, this, [this]{
-        m_consoleEdit->clear();
-        buildProject();
-    });
+    connect(aRebuild, &QAction::triggered, this, [this]{ buildProject(true); });
+
+    m_aCancelBuild = plcMenu->addAction("Cancel Build");
+    m_aCancelBuild->setEnabled(false);
+    connect(m_aCancelBuild, &QAction::triggered, this, &MainWindow::cancelBuild);
 
     plcMenu->addSeparator();
 
@@ -580,7 +600,7 @@ void MainWindow::setupToolBar()
     // ══════════════════════════════════════════════════════════
     auto* aBuild = tb->addAction(makeLdIcon("build"), "Build / Compile  [Ctrl+B]");
     auto* aClean = tb->addAction(makeLdIcon("clean"), "Clean Build");
-    connect(aBuild, &QAction::triggered, this, &MainWindow::buildProject);
+    connect(aBuild, &QAction::triggered, this, [this]{ buildProject(); });
     connect(aClean, &QAction::triggered, this, [this]{
         m_consoleEdit->clear();
         m_consoleEdit->appendPlainText("[ Clean ] Build output cleared.");
@@ -991,7 +1011,9 @@ void MainWindow::setupCentralArea()
             return;
         }
         PouModel* pou = m_subWinPouMap.value(sw, nullptr);
-        m_scene = pou ? m_sceneMap.value(pou, nullptr) : nullptr;
+        // 图形标签页：场景可能已被拆除，重新激活时重建
+        auto* view = pou && sw->widget() ? sw->widget()->findChild<LadderView*>() : nullptr;
+        m_scene = view ? bindScene(pou, view) : nullptr;
 
         // 图形语言（LD / FBD / SFC）显示 LD 工具栏，文本语言（ST / IL）隐藏
         const bool isGraphical = pou &&
@@ -1410,6 +1432,80 @@ QWidget* MainWindow::createProjectPropertiesWidget()
     return w;
 }
 
+// ============================================================
+// 图形场景按需构建 / 拆除
+// ============================================================
+PlcOpenViewer* MainWindow::bindScene(PouModel* pou, LadderView* view)
+{
+    PlcOpenViewer* scene = m_sceneMap.value(pou, nullptr);
+    if (!scene) {
+        scene = new PlcOpenViewer(this);
+        if (pou->hasGraphical())
+            scene->loadFromXmlString(pou->graphicalXml());
+        else {
+            // 传入语言字符串，scene 据此初始化正确的 body DOM
+            QString langStr = "LD";
+            if (pou->language == PouLanguage::FBD) langStr = "FBD";
+            else if (pou->language == PouLanguage::SFC) langStr = "SFC";
+            scene->initEmpty(langStr);
+        }
+        m_sceneMap[pou] = scene;
+        connect(scene, &PlcOpenViewer::modeChanged,
+                this,  &MainWindow::onLdModeChanged);
+    }
+
+    // 视图所挂场景已被拆除（或新建视图）时重新挂接
+    if (view->scene() != scene) {
+        view->setScene(scene);
+        connect(scene, &PlcOpenViewer::modeChanged,
+                view,  &LadderView::onModeChanged);
+    }
+
+    m_sceneLru.removeOne(pou);
+    m_sceneLru.append(pou);
+    evictScenes(pou);
+    return scene;
+}
+
+void MainWindow::evictScenes(PouModel* keep)
+{
+    qsizetype total = 0;
+    for (PlcOpenViewer* scene : std::as_const(m_sceneMap))
+        total += scene->items().size();
+    if (total <= kSceneItemBudget) return;
+
+    QSet<PouModel*> open;
+    for (PouModel* pou : std::as_const(m_subWinPouMap))
+        if (pou) open.insert(pou);
+
+    // 先拆无标签页的场景，仍超预算再拆后台标签页（重新激活时重建）
+    for (int pass = 0; pass < 2 && total > kSceneItemBudget; ++pass) {
+        const QList<PouModel*> order = m_sceneLru;
+        for (PouModel* pou : order) {
+            if (total <= kSceneItemBudget) break;
+            PlcOpenViewer* scene = m_sceneMap.value(pou, nullptr);
+            if (pou == keep || !scene || scene == m_scene) continue;
+            if (pass == 0 && open.contains(pou)) continue;
+            total -= scene->items().size();
+            releaseScene(pou);
+        }
+    }
+}
+
+void MainWindow::releaseScene(PouModel* pou)
+{
+    PlcOpenViewer* scene = m_sceneMap.take(pou);
+    m_sceneLru.removeOne(pou);
+    if (!scene) return;
+
+    // 写回当前内容；撤销历史随场景一并丢弃
+    const QString xml = scene->toXmlString();
+    if (!xml.isEmpty())
+        pou->setGraphicalXml(xml);
+    if (m_scene == scene) m_scene = nullptr;
+    delete scene;                   // 挂接的视图自动脱离
+}
+
 // ============================================================
 // 创建 POU 编辑器控件
 // ============================================================
@@ -1427,32 +1523,19 @@ QWidget* MainWindow::createPouEditorWidget(PouModel* pou)
     const bool isGraphical = (pou->language == PouLanguage::LD  ||
                                pou->language == PouLanguage::FBD ||
                                pou->language == PouLanguage::SFC ||
-                               !pou->graphicalXml.isEmpty());
+                               pou->hasGraphical());
 
     if (isGraphical) {
         // ── 统一图形编辑器（LD / FBD / SFC，含 PLCopen 导入）──────
-        PlcOpenViewer* scene = m_sceneMap.value(pou, nullptr);
-        if (!scene) {
-            scene = new PlcOpenViewer(this);
-            if (!pou->graphicalXml.isEmpty())
-                scene->loadFromXmlString(pou->graphicalXml);
-            else {
-                // 传入语言字符串，scene 据此初始化正确的 body DOM
-                QString langStr = "LD";
-                if (pou->language == PouLanguage::FBD) langStr = "FBD";
-                else if (pou->language == PouLanguage::SFC) langStr = "SFC";
-                scene->initEmpty(langStr);
-            }
-            m_sceneMap[pou] = scene;
-        }
-
         auto* view = new LadderView();
-        view->setScene(scene);
+        PlcOpenViewer* scene = bindScene(pou, view);
 
         if (!m_scene) m_scene = scene;
 
         // 延迟 fitInView，等 MDI 子窗口完成布局后再缩放（0ms 有时不够）
-        QTimer::singleShot(50, view, [view, scene](){
+        QTimer::singleShot(50, view, [view](){
+            auto* scene = view->scene();
+            if (!scene) return;
             QRectF r = scene->itemsBoundingRect().adjusted(-40, -40, 40, 40);
             if (r.isEmpty())
                 r = QRectF(0, 0, 800, 600);
@@ -1462,11 +1545,6 @@ QWidget* MainWindow::createPouEditorWidget(PouModel* pou)
             view->fitInView(r, Qt::KeepAspectRatio);
         });
 
-        connect(scene, &PlcOpenViewer::modeChanged,
-                this,  &MainWindow::onLdModeChanged);
-        connect(scene, &PlcOpenViewer::modeChanged,
-                view,  &LadderView::onModeChanged);
-
         editorArea = view;
 
     } else if (pou->language == PouLanguage::ST ||
@@ -1652,8 +1730,13 @@ void MainWindow::saveProjectAs() { m_projectManager->saveProjectAs(); }
 // ============================================================
 // 编译：将整个项目 PLCopen XML 转换为 ST 中间代码，显示到控制台
 // ============================================================
-void MainWindow::buildProject()
+
+void MainWindow::buildProject(bool rebuild)
 {
+    if (m_buildPipeline->isRunning()) {
+        statusBar()->showMessage("Build already in progress.", 3000);
+        return;
+    }
     if (!m_project) {
         m_consoleEdit->appendPlainText("[ Build ] No project loaded.");
         m_consoleTabs->setCurrentWidget(m_consoleEdit);
@@ -1678,30 +1761,14 @@ void MainWindow::buildProject()
     ProjectManager::syncScenesBeforeSave(m_sceneMap);
     m_project->saveToFile(m_project->filePath);
 
-    // ── Step 1/3: 生成 IEC 61131-3 ST ──────────────────────────────
-    m_consoleEdit->appendPlainText("[ 1/5 ] Generating IEC 61131-3 ST ...");
-
-    QString xmlContent;
-    {
-        QFile f(m_project->filePath);
-        if (f.open(QFile::ReadOnly | QFile::Text))
-            xmlContent = QString::fromUtf8(f.readAll());
-    }
-    if (xmlContent.isEmpty()) {
+    BuildPipeline::Config cfg;
+    cfg.projectFile = m_project->filePath;
+    if (!QFileInfo(cfg.projectFile).isReadable()) {
         m_consoleEdit->appendPlainText("       Error: cannot read project file.");
         statusBar()->showMessage("Build failed.", 4000);
         return;
     }
 
-    QString stCode = StGenerator::fromXml(xmlContent);
-    if (stCode.isEmpty()) {
-        m_consoleEdit->appendPlainText("       Error: " + StGenerator::lastError());
-        statusBar()->showMessage("Build failed.", 4000);
-        return;
-    }
-    m_consoleEdit->appendPlainText(
-        QString("       OK — %1 lines").arg(stCode.count('\n') + 1));
-
     // ── 查找 matiec 工具目录 ────────────────────────────────────────
     auto findMatiecDir = []() -> QString {
         QStringList candidates = {
@@ -1720,95 +1787,24 @@ void MainWindow::buildProject()
         return {};
     };
 
-    const QString matiecDir = findMatiecDir();
-    if (matiecDir.isEmpty()) {
+    cfg.matiecDir = findMatiecDir();
+    if (cfg.matiecDir.isEmpty()) {
         m_consoleEdit->appendPlainText(
             "       Error: matiec tools not found.\n"
             "       Expected at: " + QString(MATIEC_DIR));
         statusBar()->showMessage("Build failed.", 4000);
         return;
     }
-    const QString libDir = matiecDir + "/lib";
 
-    // ── 准备临时构建目录 ────────────────────────────────────────────
+    // ── 构建目录 ────────────────────────────────────────────────────
     // 安全化项目名（仅保留字母/数字/下划线）
     QString safeProj;
     for (QChar c : m_project->projectName)
         safeProj += (c.isLetterOrNumber() ? c : QChar('_'));
-
-    const QString buildDir = QCoreApplication::applicationDirPath() + "/output/" + safeProj;
-    const QString outDir   = buildDir + "/out_c";
-    QDir().mkpath(outDir);
-
-    // 写入临时 ST 文件
-    const QString stFile = buildDir + "/project.st";
-    {
-        QFile f(stFile);
-        if (!f.open(QFile::WriteOnly | QFile::Text | QFile::Truncate)) {
-            m_consoleEdit->appendPlainText("       Error: cannot write " + stFile);
-            statusBar()->showMessage("Build failed.", 4000);
-            return;
-        }
-        f.write(stCode.toUtf8());
-    }
-
-    // ── Step 2/3: iec2iec — 语法校验 ───────────────────────────────
-    m_consoleEdit->appendPlainText("[ 2/5 ] Validating ST (iec2iec) ...");
-    {
-        QProcess proc;
-        // -p: 允许前向引用  -i: 允许无参数 POU（PROGRAM 通常无 I/O 参数）
-        QStringList args = {"-p", "-i", "-I", libDir, stFile};
-        proc.start(matiecDir + "/iec2iec", args);
-        if (!proc.waitForFinished(30000)) {
-            m_consoleEdit->appendPlainText("       Error: iec2iec timed out.");
-            statusBar()->showMessage("Build failed.", 4000);
-            return;
-        }
-        const QString errOut = QString::fromUtf8(proc.readAllStandardError()).trimmed();
-        if (!errOut.isEmpty())
-            m_consoleEdit->appendPlainText(errOut);
-        if (proc.exitCode() != 0) {
-            m_consoleEdit->appendPlainText("       Validation FAILED.");
-            statusBar()->showMessage("Build failed.", 4000);
-            return;
-        }
-        m_consoleEdit->appendPlainText("       OK");
-    }
-
-    // ── Step 3/5: iec2c — 编译 ST → C ──────────────────────────────
-    m_consoleEdit->appendPlainText("[ 3/5 ] Compiling to C (iec2c) ...");
-    {
-        QProcess proc;
-        QStringList args = {"-p", "-i", "-I", libDir, "-T", outDir, stFile};
-        proc.start(matiecDir + "/iec2c", args);
-        if (!proc.waitForFinished(30000)) {
-            m_consoleEdit->appendPlainText("       Error: iec2c timed out.");
-            statusBar()->showMessage("Build failed.", 4000);
-            return;
-        }
-        const QString errOut = QString::fromUtf8(proc.readAllStandardError()).trimmed();
-        if (!errOut.isEmpty())
-            m_consoleEdit->appendPlainText(errOut);
-        if (proc.exitCode() != 0) {
-            m_consoleEdit->appendPlainText("       Compilation FAILED.");
-            statusBar()->showMessage("Build failed.", 4000);
-            return;
-        }
-    }
-
-    m_consoleEdit->appendPlainText("       OK");
+    cfg.buildDir = QCoreApplication::applicationDirPath() + "/output/" + safeProj;
 
     const QString target = m_project->targetType;  // "Linux" / "Mac" / "Embedded"
 
-    // ── 收集 matiec 生成的 C 源文件（resource*.c 已 #include POUS.c，勿重复编译）
-    QStringList iecSources = {outDir + "/config.c"};
-    for (const QFileInfo& fi : QDir(outDir).entryInfoList({"resource*.c"}, QDir::Files))
-        iecSources << fi.absoluteFilePath();
-
-    // ─────────────────────────────────────────────────────────────────
-    // Step 4/5 + 5/5: 通过 driver 配置生成 wrapper 并编译
-    // ─────────────────────────────────────────────────────────────────
-
     // 查找 driver 目录：
     //   1. 优先使用 m_project->driver（用户在 Project Settings 中明确选择的 driver 名）
     //   2. 回退到 targetType 的默认映射（向后兼容）
@@ -1845,8 +1841,8 @@ void MainWindow::buildProject()
         return {};
     };
 
-    const QString driverDir = findDriverDir(m_project->driver, target);
-    if (driverDir.isEmpty()) {
+    cfg.driverDir = findDriverDir(m_project->driver, target);
+    if (cfg.driverDir.isEmpty()) {
         m_consoleEdit->appendPlainText(
             QString("       Error: no driver found for target \"%1\".\n"
                     "       Expected in: %2").arg(target, QString(DRIVERS_DIR)));
@@ -1855,11 +1851,10 @@ void MainWindow::buildProject()
     }
 
     // 加载 driver.json
-    QJsonObject driver, compObj;
     {
-        QFile driverFile(driverDir + "/driver.json");
+        QFile driverFile(cfg.driverDir + "/driver.json");
         if (!driverFile.open(QFile::ReadOnly)) {
-            m_consoleEdit->appendPlainText("       Error: cannot read driver.json at " + driverDir);
+            m_consoleEdit->appendPlainText("       Error: cannot read driver.json at " + cfg.driverDir);
             statusBar()->showMessage("Build failed.", 4000);
             return;
         }
@@ -1870,272 +1865,43 @@ void MainWindow::buildProject()
             statusBar()->showMessage("Build failed.", 4000);
             return;
         }
-        driver  = doc.object();
+        cfg.driver = doc.object();
         // 根据项目编译模式（NCC/XCODE）读取对应的 compiler 子节
         const QString modeKey = m_project->mode.toLower(); // "ncc" or "xcode"
-        compObj = driver["compiler"][modeKey].toObject();
-        if (compObj.isEmpty()) {
+        cfg.compiler = cfg.driver["compiler"][modeKey].toObject();
+        if (cfg.compiler.isEmpty()) {
             // 回退：driver 可能仍用旧的扁平 compiler 结构
-            compObj = driver["compiler"].toObject();
+            cfg.compiler = cfg.driver["compiler"].toObject();
         }
     }
 
-    // ─────────────────────────────────────────────────────────────────
-    // ══ XCODE 模式：wasi-clang → .wasm 字节码 ══
-    // ─────────────────────────────────────────────────────────────────
     if (m_project->mode == "XCODE") {
-
-        const QString wasiSdkDir = findWasiSdkDir();
-        if (wasiSdkDir.isEmpty()) {
+        cfg.wasiSdkDir = findWasiSdkDir();
+        if (cfg.wasiSdkDir.isEmpty()) {
             m_consoleEdit->appendPlainText(
                 "       Error: WASI-SDK not found.\n"
                 "       Expected at: " + QString(WASI_SDK_DIR));
             statusBar()->showMessage("Build failed.", 4000);
             return;
         }
-        m_consoleEdit->appendPlainText(QString("       WASI-SDK: %1").arg(wasiSdkDir));
-
-        // Step 4/5: 读取 WASM wrapper 模板
-        m_consoleEdit->appendPlainText("[ 4/5 ] Generating WASM wrapper from driver template ...");
-        m_consoleEdit->appendPlainText(QString("       Driver: %1  [XCODE]").arg(driver["name"].toString()));
-
-        const QString templatePath = driverDir + "/" + compObj["template"].toString();
-        QString wrapperContent;
-        {
-            QFile tmpl(templatePath);
-            if (!tmpl.open(QFile::ReadOnly | QFile::Text)) {
-                m_consoleEdit->appendPlainText("       Error: cannot read template: " + templatePath);
-                statusBar()->showMessage("Build failed.", 4000);
-                return;
-            }
-            wrapperContent = QString::fromUtf8(tmpl.readAll());
-        }
-
-        const QString outputName   = compObj["output_name"].toString("plc_program");
-        const QString outputSuffix = compObj["output_suffix"].toString(".wasm");
-        const QString wrapperFile  = buildDir + "/" + outputName + "_main.c";
-        const QString wasmFile     = buildDir + "/" + outputName + outputSuffix;
-        {
-            QFile f(wrapperFile);
-            if (!f.open(QFile::WriteOnly | QFile::Text | QFile::Truncate)) {
-                m_consoleEdit->appendPlainText("       Error: cannot write wrapper file.");
-                statusBar()->showMessage("Build failed.", 4000);
-                return;
-            }
-            f.write(wrapperContent.toUtf8());
-        }
-        m_consoleEdit->appendPlainText("       OK");
-
-        // Step 5/5: wasi-clang → .wasm
-        m_consoleEdit->appendPlainText("[ 5/5 ] Compiling to WASM (wasi-clang) ...");
-        {
-            const QString wasiClang   = wasiSdkDir + "/bin/clang";
-            const QString wasiSysroot = wasiSdkDir + "/share/wasi-sysroot";
-
-            QProcess proc;
-            QStringList args;
-
-            // sysroot + target
-            args << "--sysroot=" + wasiSysroot;
-
-            // driver cflags（含 --target=wasm32-wasi）
-            for (const QJsonValue& v : compObj["cflags"].toArray())
-                args << v.toString();
-
-            // driver include_dirs（相对 driverDir，通常为空）
-            for (const QJsonValue& v : compObj["include_dirs"].toArray())
-                args << "-I" << (driverDir + "/" + v.toString());
-
-            // matiec 头文件 + iec2c 生成的头文件
-            args << "-I" << matiecDir + "/lib/C"
-                 << "-I" << outDir;
-            // 注意：WASI sysroot 自带 time.h，不需要 -include time.h
-
-            // 源文件
-            args << wrapperFile << iecSources;
-
-            // 输出
-            args << "-o" << wasmFile;
-
-            // driver ldflags（--no-entry / --export=...）
-            for (const QJsonValue& v : compObj["ldflags"].toArray())
-                args << v.toString();
-
-            // 项目自定义标志
-            if (!m_project->cflags.isEmpty())
-                args << m_project->cflags.split(' ', Qt::SkipEmptyParts);
-            if (!m_project->ldflags.isEmpty())
-                args << m_project->ldflags.split(' ', Qt::SkipEmptyParts);
-
-            proc.start(wasiClang, args);
-            if (!proc.waitForFinished(60000)) {
-                m_consoleEdit->appendPlainText("       Error: wasi-clang timed out.");
-                statusBar()->showMessage("Build failed.", 4000);
-                return;
-            }
-            const QString ccOut = QString::fromUtf8(proc.readAllStandardOutput()).trimmed();
-            const QString ccErr = QString::fromUtf8(proc.readAllStandardError()).trimmed();
-            if (!ccOut.isEmpty()) m_consoleEdit->appendPlainText(ccOut);
-            if (!ccErr.isEmpty()) m_consoleEdit->appendPlainText(ccErr);
-            if (proc.exitCode() != 0) {
-                m_consoleEdit->appendPlainText("       WASM compilation FAILED.");
-                statusBar()->showMessage("Build failed.", 4000);
-                return;
-            }
-        }
-
-        qint64 wasmSize = QFileInfo(wasmFile).size();
-        m_consoleEdit->appendPlainText("─────────────────────────────────────────");
-        m_consoleEdit->appendPlainText(
-            QString("[ Build ] SUCCESS  -->  %1  (%2 bytes)")
-            .arg(QFileInfo(wasmFile).fileName()).arg(wasmSize));
-        statusBar()->showMessage(
-            QString("Build complete -- %1 (%2 bytes)")
-            .arg(QFileInfo(wasmFile).fileName()).arg(wasmSize), 5000);
-        return;
     }
 
-    // ─────────────────────────────────────────────────────────────────
-    // ══ NCC 模式：原生编译（arm-gcc / gcc）══
-    // ─────────────────────────────────────────────────────────────────
-
-    // Step 4/5: 读取 wrapper 模板，写入构建目录
-    m_consoleEdit->appendPlainText("[ 4/5 ] Generating wrapper from driver template ...");
-    m_consoleEdit->appendPlainText(QString("       Driver: %1  [NCC]").arg(driver["name"].toString()));
-
-    const QString templatePath = driverDir + "/" + compObj["template"].toString();
-    QString wrapperContent;
-    {
-        QFile tmpl(templatePath);
-        if (!tmpl.open(QFile::ReadOnly | QFile::Text)) {
-            m_consoleEdit->appendPlainText("       Error: cannot read template: " + templatePath);
-            statusBar()->showMessage("Build failed.", 4000);
-            return;
-        }
-        wrapperContent = QString::fromUtf8(tmpl.readAll());
-    }
-
-    const QString outputName   = compObj["output_name"].toString("plc_program");
-    const QString outputSuffix = compObj["output_suffix"].toString();
-    const QString wrapperFile  = buildDir + "/" + outputName + "_main.c";
-    {
-        QFile f(wrapperFile);
-        if (!f.open(QFile::WriteOnly | QFile::Text | QFile::Truncate)) {
-            m_consoleEdit->appendPlainText("       Error: cannot write wrapper file.");
-            statusBar()->showMessage("Build failed.", 4000);
-            return;
-        }
-        f.write(wrapperContent.toUtf8());
-    }
-    m_consoleEdit->appendPlainText("       OK");
-
-    // Step 5/5: 编译
-    const QString cc      = compObj["cc"].toString("gcc");
-    const QString elfFile = buildDir + "/" + outputName + outputSuffix;
-    m_consoleEdit->appendPlainText(
-        QString("[ 5/5 ] Compiling for \"%1\" (%2) ...").arg(target, cc));
-    {
-        QProcess proc;
-        QStringList args;
-
-        // driver 定义的 cflags
-        for (const QJsonValue& v : compObj["cflags"].toArray())
-            args << v.toString();
-
-        // driver 定义的 include_dirs（相对于 driverDir）
-        for (const QJsonValue& v : compObj["include_dirs"].toArray())
-            args << "-I" << (driverDir + "/" + v.toString());
-
-        // matiec lib/C 头文件 + iec2c 生成的头文件
-        args << "-I" << matiecDir + "/lib/C"
-             << "-I" << outDir
-             << "-include" << "time.h";
-
-        // linker script（可选，Embedded 专用）
-        const QString ldRel = compObj["linker_script"].toString();
-        if (!ldRel.isEmpty())
-            args << "-Wl,-T," + driverDir + "/" + ldRel;
-
-        // 源文件：wrapper + matiec 生成的 C 文件
-        args << wrapperFile << iecSources;
-
-        // 输出
-        args << "-o" << elfFile;
-
-        // driver 定义的 ldflags
-        for (const QJsonValue& v : compObj["ldflags"].toArray())
-            args << v.toString();
-
-        // 项目级别自定义标志（可覆盖 driver 默认值）
-        if (!m_project->cflags.isEmpty())
-            args << m_project->cflags.split(' ', Qt::SkipEmptyParts);
-        if (!m_project->ldflags.isEmpty())
-            args << m_project->ldflags.split(' ', Qt::SkipEmptyParts);
-
-        proc.start(cc, args);
-        if (!proc.waitForFinished(60000)) {
-            m_consoleEdit->appendPlainText("       Error: compiler timed out.");
-            statusBar()->showMessage("Build failed.", 4000);
-            return;
-        }
-        const QString ccOut = QString::fromUtf8(proc.readAllStandardOutput()).trimmed();
-        const QString ccErr = QString::fromUtf8(proc.readAllStandardError()).trimmed();
-        if (!ccOut.isEmpty()) m_consoleEdit->appendPlainText(ccOut);
-        if (!ccErr.isEmpty()) m_consoleEdit->appendPlainText(ccErr);
-        if (proc.exitCode() != 0) {
-            m_consoleEdit->appendPlainText("       Compilation FAILED.");
-            statusBar()->showMessage("Build failed.", 4000);
-            return;
-        }
-    }
-
-    // post_build（可选，如 Embedded 的 objcopy .elf -> .bin）
-    // 在新的嵌套 compiler 结构中，post_build 在 compiler.ncc 内；
-    // 旧扁平结构中在顶层 driver。两处都检查，优先 compObj。
-    QString finalOutput = elfFile;
-    if (compObj.contains("post_build") || driver.contains("post_build")) {
-        QJsonObject pb = compObj.contains("post_build")
-            ? compObj["post_build"].toObject()
-            : driver["post_build"].toObject();
-        const QString objcopy   = pb["objcopy"].toString();
-        const QString format    = pb["format"].toString("binary");
-        const QString binSuffix = pb["output_suffix"].toString(".bin");
-        const QString binFile   = buildDir + "/" + outputName + binSuffix;
-
-        m_consoleEdit->appendPlainText(
-            QString("       Post-build: %1 -O %2 ...").arg(objcopy, format));
-        {
-            QProcess proc;
-            proc.start(objcopy, {"-O", format, elfFile, binFile});
-            if (!proc.waitForFinished(15000)) {
-                m_consoleEdit->appendPlainText("       Error: " + objcopy + " timed out.");
-                statusBar()->showMessage("Build failed.", 4000);
-                return;
-            }
-            if (proc.exitCode() != 0) {
-                const QString err = QString::fromUtf8(proc.readAllStandardError()).trimmed();
-                m_consoleEdit->appendPlainText("       " + objcopy + " FAILED: " + err);
-                statusBar()->showMessage("Build failed.", 4000);
-                return;
-            }
-        }
-        finalOutput = binFile;
-
-        // 显示 .bin 大小与容量限制
-        qint64 sz    = QFileInfo(binFile).size();
-        qint64 maxSz = pb["max_size_bytes"].toInteger(0);
-        QString sizeStr = maxSz > 0
-            ? QString("%1 bytes / %2 max").arg(sz).arg(maxSz)
-            : QString("%1 bytes").arg(sz);
-        m_consoleEdit->appendPlainText(
-            QString("       %1%2  (%3)").arg(outputName, binSuffix, sizeStr));
-    }
+    cfg.mode     = m_project->mode;
+    cfg.target   = target;
+    cfg.cflags   = m_project->cflags.split(' ', Qt::SkipEmptyParts);
+    cfg.ldflags  = m_project->ldflags.split(' ', Qt::SkipEmptyParts);
+    cfg.useCache = !rebuild;
+
+    // 其余步骤（ST 生成 → matiec → 编译链接）在 BuildPipeline 中异步执行，
+    // 输出经 output() 逐行追加到控制台，结束时 finished() 更新状态栏
+    statusBar()->showMessage("Building ...");
+    m_aCancelBuild->setEnabled(true);
+    m_buildPipeline->start(cfg);
+}
 
-    m_consoleEdit->appendPlainText("─────────────────────────────────────────");
-    m_consoleEdit->appendPlainText(
-        QString("[ Build ] SUCCESS  -->  %1").arg(finalOutput));
-    statusBar()->showMessage(
-        QString("Build complete -- %1").arg(QFileInfo(finalOutput).fileName()), 5000);
+void MainWindow::cancelBuild()
+{
+    m_buildPipeline->cancel();
 }
 
 // ============================================================
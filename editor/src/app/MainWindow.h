@@ -17,6 +17,7 @@ class QPlainTextEdit;
 class QLabel;
 class PlcOpenViewer;
 class LadderView;
+class BuildPipeline;
 
 // ─────────────────────────────────────────────────────────────
 // PLC 连接状态
@@ -63,7 +64,8 @@ private:
     void openProject();
     void saveProject();
     void saveProjectAs();
-    void buildProject();     // 编译：生成 C 代码
+    void buildProject(bool rebuild = false);  // 编译：异步执行 BuildPipeline；rebuild 忽略缓存
+    void cancelBuild();
     void downloadProject();  // 下载：打开下载对话框
     void connectToPlc();     // 连接/断开 PLC
 
@@ -101,6 +103,11 @@ private:
     static QIcon makeLdIcon(const QString& type, int size = 24);
     void onLdModeChanged(EditorMode mode);
 
+    // ---- 图形场景按需构建 / 拆除 ----
+    PlcOpenViewer* bindScene(PouModel* pou, LadderView* view);
+    void evictScenes(PouModel* keep);
+    void releaseScene(PouModel* pou);
+
     // ---- 状态栏辅助 ----
     static QString ledStyle(const QString& color);  // 生成圆形 LED 样式
 
@@ -109,6 +116,7 @@ private:
 
     // ---- 成员变量 ----
     ProjectManager* m_projectManager = nullptr;
+    BuildPipeline*  m_buildPipeline  = nullptr;
     ProjectModel*   m_project        = nullptr;
     PlcOpenViewer*  m_scene       = nullptr;   // 当前活跃图形场景
     QMdiArea*       m_mdiArea     = nullptr;
@@ -134,8 +142,12 @@ private:
 
     // 每个 MDI 子窗口对应的 PouModel
     QMap<QMdiSubWindow*, PouModel*> m_subWinPouMap;
-    // 每个 PouModel 对应的图形场景（LD / FBD / SFC，关闭后保留复用）
+    // 每个 PouModel 对应的图形场景（LD / FBD / SFC）
+    //   首次显示时才构建；关闭标签后保留复用，图元总数超出
+    //   kSceneItemBudget 时按 m_sceneLru 由久到近拆除（XML 写回 PouModel）
     QMap<PouModel*, PlcOpenViewer*> m_sceneMap;
+    QList<PouModel*>                m_sceneLru;     // 末尾 = 最近使用
+    static constexpr int kSceneItemBudget = 100000;
     // LD 工具栏模式按钮映射（Escape / signal 时同步状态）
     QMap<EditorMode, QAction*> m_ldModeActions;
     // LD 专属工具栏动作（含前置分隔符），切换到文本视图时隐藏
@@ -152,4 +164,5 @@ private:
     QAction* m_aTransfer = nullptr;  // 下载程序
     QAction* m_aRun      = nullptr;
     QAction* m_aStop     = nullptr;
+    QAction* m_aCancelBuild = nullptr;  // 构建进行中才可用
 };
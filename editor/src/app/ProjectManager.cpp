@@ -29,7 +29,7 @@ void ProjectManager::syncScenesBeforeSave(const QMap<PouModel*, PlcOpenViewer*>&
         if (!scene) continue;
         const QString xml = scene->toXmlString();
         if (!xml.isEmpty())
-            pou->graphicalXml = xml;
+            pou->setGraphicalXml(xml);
     }
 }
 
@@ -41,7 +41,7 @@ public:
 
 signals:
     // 新/打开项目完成：MainWindow 应接管 project 的所有权（setParent / delete 旧的）
-    // 接管后应 closeAllPouTabs() + m_sceneMap.clear() + rebuildProjectTree()
+    // 接管后应 closeAllPouTabs() + 释放并清空 m_sceneMap + rebuildProjectTree()
     void projectCreated(ProjectModel* project);
 
     // 新/打开后建议打开的第一个 POU
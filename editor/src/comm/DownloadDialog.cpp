@@ -249,6 +249,8 @@ void DownloadDialog::onDownload()
             this, &DownloadDialog::onProgress);
     connect(m_protocol, &PlcProtocol::downloadComplete,
             this, &DownloadDialog::onDownloadComplete);
+    connect(m_protocol, &PlcProtocol::downloadSkipped,
+            this, &DownloadDialog::onDownloadSkipped);
     connect(m_protocol, &PlcProtocol::downloadFailed,
             this, &DownloadDialog::onDownloadFailed);
 
@@ -260,7 +262,9 @@ void DownloadDialog::onDownload()
     m_progress->setValue(0);
     setUiBusy(true);
 
-    // 启动下载
+    // 启动下载（设备映像指纹与本地一致时不擦写）
+    appendLog(QString("Local logic fingerprint: %1")
+              .arg(PlcProtocol::imageHash(binData), 8, 16, QChar('0')));
     m_protocol->downloadBinary(binData);
 }
 
@@ -316,6 +320,23 @@ void DownloadDialog::onDownloadComplete()
     QMessageBox::information(this, "Download", "Program downloaded successfully!\nPLC has been restarted.");
 }
 
+void DownloadDialog::onDownloadSkipped(uint32_t hash)
+{
+    m_progress->setValue(100);
+    m_progress->setFormat("Up to date");
+
+    if (m_transport) m_transport->close();
+
+    disconnect(m_btnDownload, nullptr, nullptr, nullptr);
+    connect(m_btnDownload, &QPushButton::clicked, this, &DownloadDialog::onDownload);
+    m_btnDownload->setText("Download");
+    setUiBusy(false);
+
+    appendLog(QString("[%1] PLC already runs this program (%2), nothing to download.")
+              .arg(QDateTime::currentDateTime().toString("hh:mm:ss"))
+              .arg(hash, 8, 16, QChar('0')));
+}
+
 void DownloadDialog::onDownloadFailed(const QString& reason)
 {
     if (m_transport) m_transport->close();
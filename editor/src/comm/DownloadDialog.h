@@ -1,5 +1,6 @@
 #pragma once
 #include <QDialog>
+#include <cstdint>
 
 class QTabWidget;
 class QComboBox;
@@ -52,6 +53,7 @@ private:
     void appendLog(const QString& msg);
     void onProgress(int page, int total);
     void onDownloadComplete();
+    void onDownloadSkipped(uint32_t hash);
     void onDownloadFailed(const QString& reason);
 
     // ── 传输配置 ──────────────────────────────────────────────
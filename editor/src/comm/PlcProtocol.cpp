@@ -1,6 +1,8 @@
 #include "PlcProtocol.h"
 #include "IPlcTransport.h"
 #include <QTimer>
+#include <algorithm>
+#include <array>
 
 PlcProtocol::PlcProtocol(IPlcTransport* transport, QObject* parent)
     : QObject(parent)
@@ -14,34 +16,104 @@ PlcProtocol::PlcProtocol(IPlcTransport* transport, QObject* parent)
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-// CRC-8/MAXIM (poly 0x31, init 0x00) — 与 runtime 保持一致
+// CRC-8/MAXIM (poly 0x31, init 0x00) — 与 runtime 保持一致（查表）
 // ─────────────────────────────────────────────────────────────────────────────
 uint8_t PlcProtocol::crc8(const QByteArray& data)
 {
+    static const auto table = [] {
+        std::array<uint8_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            auto c = static_cast<uint8_t>(i);
+            for (int k = 0; k < 8; k++)
+                c = (c & 0x80u) ? static_cast<uint8_t>((c << 1u) ^ 0x31u)
+                                : static_cast<uint8_t>(c << 1u);
+            t[i] = c;
+        }
+        return t;
+    }();
+
     uint8_t crc = 0;
-    for (uint8_t b : data) {
-        crc ^= b;
-        for (int i = 0; i < 8; i++)
-            crc = (crc & 0x80u) ? static_cast<uint8_t>((crc << 1u) ^ 0x31u)
-                                : static_cast<uint8_t>(crc << 1u);
-    }
+    for (uint8_t b : data)
+        crc = table[crc ^ b];
     return crc;
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+// CRC-32/IEEE (reflected, poly 0xEDB88320) — 与 runtime 硬件 CRC 引擎一致
+// slicing-by-8：每轮处理 8 字节，t[k][i] = 字节 i 之后再跟 k 个 0 字节的 CRC
+// ─────────────────────────────────────────────────────────────────────────────
+uint32_t PlcProtocol::crc32(const QByteArray& data)
+{
+    static const auto t = [] {
+        std::array<std::array<uint32_t, 256>, 8> tab{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1u) ? (0xEDB88320u ^ (c >> 1u)) : (c >> 1u);
+            tab[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; i++)
+            for (int k = 1; k < 8; k++)
+                tab[k][i] = (tab[k - 1][i] >> 8u) ^ tab[0][tab[k - 1][i] & 0xFFu];
+        return tab;
+    }();
+
+    const auto* p = reinterpret_cast<const uint8_t*>(data.constData());
+    qsizetype   n = data.size();
+    uint32_t  crc = 0xFFFFFFFFu;
+
+    for (; n >= 8; p += 8, n -= 8) {
+        const uint32_t lo = crc ^ (p[0] | (p[1] << 8u) | (p[2] << 16u)
+                                   | (static_cast<uint32_t>(p[3]) << 24u));
+        crc = t[7][lo & 0xFFu]         ^ t[6][(lo >> 8u) & 0xFFu]
+            ^ t[5][(lo >> 16u) & 0xFFu] ^ t[4][lo >> 24u]
+            ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+    for (; n > 0; ++p, --n)
+        crc = t[0][(crc ^ *p) & 0xFFu] ^ (crc >> 8u);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// 帧尾 CRC 字节数：PING 帧始终为 CRC-8，以便随时重新协商
+int PlcProtocol::frameCrcLen(uint8_t cmd) const
+{
+    return (m_crc32 && cmd != CMD_PING) ? 4 : 1;
+}
+
+// 每次 PING 都重新协商：先回到 CRC-8，由响应 caps 决定是否切换
+QByteArray PlcProtocol::pingPayload()
+{
+    m_crc32 = false;
+    return QByteArray(1, static_cast<char>(PING_REQ_CRC32));
+}
+
+// PING 响应：[ver:8][caps:1][window:1]，旧固件只有版本串
+void PlcProtocol::applyCaps(const QByteArray& pingData)
+{
+    m_caps  = (pingData.size() >= 10) ? static_cast<uint8_t>(pingData[8]) : 0;
+    m_crc32 = (m_caps & CAP_CRC32) != 0;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // 帧构建
 // ─────────────────────────────────────────────────────────────────────────────
 QByteArray PlcProtocol::buildFrame(uint8_t cmd, const QByteArray& payload)
 {
     QByteArray frame;
-    frame.reserve(4 + payload.size() + 1);
+    frame.reserve(4 + payload.size() + 4);
     frame.append(static_cast<char>(SOF));
     frame.append(static_cast<char>(cmd));
     auto len = static_cast<uint16_t>(payload.size());
     frame.append(static_cast<char>(len & 0xFFu));
     frame.append(static_cast<char>(len >> 8u));
     frame.append(payload);
-    frame.append(static_cast<char>(crc8(payload)));
+    if (frameCrcLen(cmd) == 4) {
+        const uint32_t crc = crc32(payload);
+        for (int i = 0; i < 4; i++)
+            frame.append(static_cast<char>((crc >> (8u * i)) & 0xFFu));
+    } else {
+        frame.append(static_cast<char>(crc8(payload)));
+    }
     return frame;
 }
 
@@ -55,15 +127,18 @@ void PlcProtocol::armTimeout(int ms) { m_timeoutTimer->start(ms); }
 // ─────────────────────────────────────────────────────────────────────────────
 // 公开接口
 // ─────────────────────────────────────────────────────────────────────────────
-void PlcProtocol::downloadBinary(const QByteArray& bin)
+void PlcProtocol::downloadBinary(const QByteArray& bin, bool delta)
 {
     if (m_dlStep != DlStep::Idle) return;
 
-    m_binData = bin;
-    // 末尾补 0xFF 对齐到 PAGE_SIZE
-    while (m_binData.size() % static_cast<int>(FLASH_PAGE_SIZE) != 0)
-        m_binData.append('\xFF');
+    m_binData = padToPage(bin);
+    if (m_binData.size() > static_cast<int>(USER_IMAGE_MAX_SIZE)) {
+        fail(QString("Binary too large: %1 bytes (max %2)")
+             .arg(m_binData.size()).arg(USER_IMAGE_MAX_SIZE));
+        return;
+    }
 
+    m_delta    = delta;
     m_dlPage   = 0;
     m_dlTotal  = m_binData.size() / static_cast<int>(FLASH_PAGE_SIZE);
     m_aborting = false;
@@ -72,10 +147,25 @@ void PlcProtocol::downloadBinary(const QByteArray& bin)
     emit logMessage(QString("Starting download: %1 bytes → %2 pages")
                     .arg(bin.size()).arg(m_dlTotal));
 
-    sendFrame(CMD_PING);
+    sendFrame(CMD_PING, pingPayload());
     armTimeout(3000);
 }
 
+// 末尾补 0xFF（擦除值）对齐到 PAGE_SIZE
+QByteArray PlcProtocol::padToPage(const QByteArray& bin)
+{
+    QByteArray out = bin;
+    const int page = static_cast<int>(FLASH_PAGE_SIZE);
+    if (out.size() % page != 0)
+        out.append(QByteArray(page - out.size() % page, '\xFF'));
+    return out;
+}
+
+uint32_t PlcProtocol::imageHash(const QByteArray& bin)
+{
+    return crc32(padToPage(bin));
+}
+
 void PlcProtocol::abort()
 {
     m_aborting = true;
@@ -86,7 +176,7 @@ void PlcProtocol::abort()
 
 void PlcProtocol::sendPing()
 {
-    sendFrame(CMD_PING);
+    sendFrame(CMD_PING, pingPayload());
     armTimeout(3000);
 }
 
@@ -109,6 +199,82 @@ void PlcProtocol::sendReadIo()
     armTimeout(2000);
 }
 
+void PlcProtocol::sendGetStats(bool reset)
+{
+    QByteArray p(1, reset ? '\x01' : '\x00');
+    sendFrame(CMD_GET_STATS, p);
+    armTimeout(2000);
+}
+
+void PlcProtocol::sendGetTasks(bool reset)
+{
+    QByteArray p(1, reset ? '\x01' : '\x00');
+    sendFrame(CMD_GET_TASKS, p);
+    armTimeout(2000);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// GET_STATS 载荷解析（布局见 runtime/app/scan_timer.c ScanTimer_Serialize）
+//   [period_us:4][exec:32][jitter:32]
+//   每个分布：[count:4][min:4][max:4][avg:4][hist:8×2]
+// ─────────────────────────────────────────────────────────────────────────────
+bool PlcProtocol::parseStats(const QByteArray& data, PlcScanStats& out)
+{
+    constexpr int kDistSize = 16 + 2 * PlcScanDist::kBuckets;
+    if (data.size() < 4 + 2 * kDistSize) return false;
+
+    auto u8  = [&](int i) { return static_cast<uint32_t>(static_cast<uint8_t>(data[i])); };
+    auto u16 = [&](int i) { return static_cast<uint16_t>(u8(i) | (u8(i + 1) << 8u)); };
+    auto u32 = [&](int i) {
+        return u8(i) | (u8(i + 1) << 8u) | (u8(i + 2) << 16u) | (u8(i + 3) << 24u);
+    };
+    auto dist = [&](int off, PlcScanDist& d) {
+        d.count = u32(off);
+        d.minUs = u32(off + 4);
+        d.maxUs = u32(off + 8);
+        d.avgUs = u32(off + 12);
+        for (int b = 0; b < PlcScanDist::kBuckets; ++b)
+            d.hist[b] = u16(off + 16 + 2 * b);
+    };
+
+    out.periodUs = u32(0);
+    dist(4, out.exec);
+    dist(4 + kDistSize, out.jitter);
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// GET_TASKS 载荷解析（布局见 runtime/app/scheduler.c Sched_Serialize）
+//   [count:1] + count × [period_ms:2][priority:1][rsv:1]
+//                       [runs:4][overruns:4][missed:4][max_us:4]
+// ─────────────────────────────────────────────────────────────────────────────
+bool PlcProtocol::parseTasks(const QByteArray& data, QList<PlcTaskStats>& out)
+{
+    constexpr int kTaskSize = 20;
+    if (data.isEmpty()) return false;
+    const int n = static_cast<uint8_t>(data[0]);
+    if (data.size() < 1 + n * kTaskSize) return false;
+
+    auto u8  = [&](int i) { return static_cast<uint32_t>(static_cast<uint8_t>(data[i])); };
+    auto u32 = [&](int i) {
+        return u8(i) | (u8(i + 1) << 8u) | (u8(i + 2) << 16u) | (u8(i + 3) << 24u);
+    };
+
+    out.clear();
+    for (int t = 0; t < n; ++t) {
+        const int off = 1 + t * kTaskSize;
+        PlcTaskStats s;
+        s.periodMs = static_cast<uint16_t>(u8(off) | (u8(off + 1) << 8u));
+        s.priority = static_cast<uint8_t>(u8(off + 2));
+        s.runs     = u32(off + 4);
+        s.overruns = u32(off + 8);
+        s.missed   = u32(off + 12);
+        s.maxUs    = u32(off + 16);
+        out.append(s);
+    }
+    return true;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // 响应帧解析状态机
 // 接收到的字节流可能被拆分，逐字节处理
@@ -146,6 +312,7 @@ void PlcProtocol::onDataReceived(const QByteArray& data)
             m_frameLen |= static_cast<uint16_t>(static_cast<uint16_t>(byte) << 8u);
             m_frameIdx  = 0;
             m_frameData.clear();
+            m_frameCrc.clear();
             m_parseState = (m_frameLen > 0) ? ParseState::FrameData
                                             : ParseState::FrameCrc;
             break;
@@ -157,8 +324,20 @@ void PlcProtocol::onDataReceived(const QByteArray& data)
             break;
 
         case ParseState::FrameCrc: {
+            m_frameCrc.append(static_cast<char>(byte));
+            if (m_frameCrc.size() < frameCrcLen(m_frameCmd))
+                break;
             m_parseState = ParseState::WaitFirst;
-            if (byte == crc8(m_frameData))
+            bool ok;
+            if (m_frameCrc.size() == 4) {
+                uint32_t rx = 0;
+                for (int i = 0; i < 4; i++)
+                    rx |= static_cast<uint32_t>(static_cast<uint8_t>(m_frameCrc[i])) << (8u * i);
+                ok = (rx == crc32(m_frameData));
+            } else {
+                ok = (static_cast<uint8_t>(m_frameCrc[0]) == crc8(m_frameData));
+            }
+            if (ok)
                 onResponse(true, m_frameCmd, m_frameData);
             else
                 emit logMessage("[WARN] CRC mismatch in response frame");
@@ -185,15 +364,50 @@ void PlcProtocol::onResponse(bool isAck, uint8_t cmd, const QByteArray& data)
                        | (static_cast<uint32_t>(static_cast<uint8_t>(data[4])) << 24u);
             emit statusResponse(running, t);
         } else if (cmd == CMD_PING && isAck) {
-            emit pingResponse(QString::fromLatin1(data));
+            applyCaps(data);
+            emit pingResponse(QString::fromLatin1(data.left(8)));
         } else if (cmd == CMD_READ_IO && isAck && data.size() >= 2) {
             emit ioResponse(static_cast<uint8_t>(data[0]),
                             static_cast<uint8_t>(data[1]));
+        } else if (cmd == CMD_GET_STATS && isAck) {
+            PlcScanStats stats;
+            if (parseStats(data, stats))
+                emit statsResponse(stats);
+        } else if (cmd == CMD_GET_TASKS && isAck) {
+            QList<PlcTaskStats> tasks;
+            if (parseTasks(data, tasks))
+                emit tasksResponse(tasks);
+        }
+        return;
+    }
+
+    // ── 窗口化写页：按 seq 处理回复；单字节 NAK（帧 CRC 错）无法归属，等超时重传
+    if (m_dlStep == DlStep::WriteWindow) {
+        if (m_aborting) { fail("Aborted"); return; }
+        if (isAck && cmd == CMD_WRITE_SEQ && data.size() >= 3) {
+            const auto seq = static_cast<uint16_t>(static_cast<uint8_t>(data[0])
+                           | (static_cast<uint8_t>(data[1]) << 8u));
+            onWriteSeqResult(seq, static_cast<uint8_t>(data[2]));
+        } else if (!m_inFlight.isEmpty()) {
+            armTimeout(3000);
         }
         return;
     }
 
     // ── 下载状态机 ───────────────────────────────────────────
+    if (m_dlStep == DlStep::Hash && !m_aborting
+        && (!isAck || cmd != CMD_GET_HASH)) {
+        emit logMessage("GET_HASH not answered, continuing without fingerprint check.");
+        startTransfer();
+        return;
+    }
+    if (m_dlStep == DlStep::SectorCrc && !m_aborting
+        && (!isAck || cmd != CMD_SECTOR_CRC)) {
+        // 旧版 runtime 不认识 SECTOR_CRC → 回退全量下载
+        emit logMessage("Device has no SECTOR_CRC support, falling back to full download.");
+        startFullErase();
+        return;
+    }
     if (!isAck) { fail("NAK received from device"); return; }
     if (m_aborting) { fail("Aborted"); return; }
 
@@ -201,23 +415,56 @@ void PlcProtocol::onResponse(bool isAck, uint8_t cmd, const QByteArray& data)
 
     case DlStep::Ping: {
         QString ver = (cmd == CMD_PING && !data.isEmpty())
-                      ? QString::fromLatin1(data)
+                      ? QString::fromLatin1(data.left(8))
                       : "PLC";
         emit logMessage(QString("Connected: %1").arg(ver));
         emit pingResponse(ver);
 
-        m_dlStep = DlStep::Erase;
-        emit logMessage("Erasing user flash (sectors 16-31)...");
-        sendFrame(CMD_ERASE);
-        armTimeout(8000);   // 擦除最多需要 ~3s/sector × 16 sectors
+        // 能力协商：[ver:8][caps:1][window:1]，旧固件只有版本串 → 停等模式
+        m_window = 0;
+        if (cmd == CMD_PING)
+            applyCaps(data);
+        if (m_crc32)
+            emit logMessage("Frame check: CRC-32.");
+        if (cmd == CMD_PING && data.size() >= 10
+            && (static_cast<uint8_t>(data[8]) & CAP_WRITE_SEQ) != 0)
+            m_window = std::max(1, static_cast<int>(static_cast<uint8_t>(data[9])));
+        if (m_window > 0)
+            emit logMessage(QString("Windowed write: %1 page(s) per burst.").arg(m_window));
+
+        // 指纹比对只在增量模式下进行；全量模式总是重新擦写
+        if (m_delta && (m_caps & CAP_LOGIC_HASH) != 0 && m_crc32) {
+            m_dlStep = DlStep::Hash;
+            sendFrame(CMD_GET_HASH);
+            armTimeout(2000);
+            break;
+        }
+        startTransfer();
         break;
     }
 
+    case DlStep::Hash:
+        checkHash(data);
+        break;
+
+    case DlStep::SectorCrc:
+        planDelta(data);
+        break;
+
     case DlStep::Erase:
         emit logMessage("Erase OK.");
-        m_dlStep = DlStep::Write;
-        m_dlPage = 0;
-        startNextPage();
+        startWrite();
+        break;
+
+    case DlStep::EraseSector:
+        if (++m_eraseIdx < m_sectors.size()) {
+            sendFrame(CMD_ERASE_SECTOR,
+                      QByteArray(1, static_cast<char>(m_sectors[m_eraseIdx])));
+            armTimeout(2000);
+        } else {
+            emit logMessage("Erase OK.");
+            startWrite();
+        }
         break;
 
     case DlStep::Write: {
@@ -226,22 +473,7 @@ void PlcProtocol::onResponse(bool isAck, uint8_t cmd, const QByteArray& data)
 
         if (m_dlPage >= m_dlTotal) {
             // 全部页写完，发校验命令
-            m_dlStep = DlStep::Verify;
-
-            QByteArray vp(7, '\0');
-            uint32_t addr = USER_FLASH_BASE;
-            uint32_t len  = static_cast<uint32_t>(m_binData.size());
-            vp[0] = static_cast<char>(addr & 0xFFu);
-            vp[1] = static_cast<char>((addr >> 8u) & 0xFFu);
-            vp[2] = static_cast<char>((addr >> 16u) & 0xFFu);
-            vp[3] = static_cast<char>((addr >> 24u) & 0xFFu);
-            vp[4] = static_cast<char>(len & 0xFFu);
-            vp[5] = static_cast<char>((len >> 8u) & 0xFFu);
-            vp[6] = static_cast<char>(crc8(m_binData));
-
-            emit logMessage("Verifying...");
-            sendFrame(CMD_VERIFY, vp);
-            armTimeout(4000);
+            sendVerify();
         } else {
             startNextPage();
         }
@@ -267,35 +499,286 @@ void PlcProtocol::onResponse(bool isAck, uint8_t cmd, const QByteArray& data)
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
-// 写入下一页
+// 开始擦写：增量模式先读取映像覆盖范围内各扇区的 CRC-32，否则全量擦除
 // ─────────────────────────────────────────────────────────────────────────────
-void PlcProtocol::startNextPage()
+void PlcProtocol::startTransfer()
 {
-    if (m_aborting) { fail("Aborted"); return; }
+    if (!m_delta) {
+        startFullErase();
+        return;
+    }
+    const int nSectors = (m_binData.size() + static_cast<int>(FLASH_SECTOR_SIZE) - 1)
+                       / static_cast<int>(FLASH_SECTOR_SIZE);
+    QByteArray p(2, '\0');
+    p[0] = static_cast<char>(USER_FLASH_SECTOR_START);
+    p[1] = static_cast<char>(nSectors);
+    m_dlStep = DlStep::SectorCrc;
+    emit logMessage(QString("Reading sector CRCs (%1 sectors)...").arg(nSectors));
+    sendFrame(CMD_SECTOR_CRC, p);
+    armTimeout(3000);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// 指纹比对：响应 [valid:1][length:4LE][crc32:4LE]
+// 设备只在指纹与当前 Flash 内容一致时报告 valid，因此一致即可跳过整个下载
+// ─────────────────────────────────────────────────────────────────────────────
+void PlcProtocol::checkHash(const QByteArray& hashResp)
+{
+    auto u32 = [&](int i) {
+        uint32_t v = 0;
+        for (int k = 0; k < 4; k++)
+            v |= static_cast<uint32_t>(static_cast<uint8_t>(hashResp[i + k])) << (8u * k);
+        return v;
+    };
+
+    const uint32_t local = crc32(m_binData);
+    if (hashResp.size() >= 9 && hashResp[0] != 0) {
+        const uint32_t len = u32(1);
+        const uint32_t crc = u32(5);
+        if (len == static_cast<uint32_t>(m_binData.size()) && crc == local) {
+            m_dlStep = DlStep::Idle;
+            emit logMessage(QString("Logic fingerprint %1 matches, download skipped.")
+                            .arg(local, 8, 16, QChar('0')));
+            emit downloadSkipped(local);
+            return;
+        }
+        emit logMessage(QString("Logic fingerprint differs (device %1, local %2).")
+                        .arg(crc, 8, 16, QChar('0')).arg(local, 8, 16, QChar('0')));
+    } else {
+        emit logMessage("Device has no valid logic fingerprint.");
+    }
+    startTransfer();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// 全量擦除：ERASE 全部 B 区扇区，之后写入映像的所有页
+// ─────────────────────────────────────────────────────────────────────────────
+void PlcProtocol::startFullErase()
+{
+    m_pages.clear();
+    for (int i = 0; i < m_binData.size() / static_cast<int>(FLASH_PAGE_SIZE); ++i)
+        m_pages.append(i);
+    m_dlTotal = m_pages.size();
+
+    m_dlStep = DlStep::Erase;
+    emit logMessage("Erasing user flash (sectors 16-31)...");
+    sendFrame(CMD_ERASE);
+    armTimeout(8000);   // 擦除最多需要 ~3s/sector × 16 sectors
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// 增量规划：比对设备扇区 CRC 与本地映像（不足一扇区部分按擦除值 0xFF 补齐），
+// 只擦除并重写内容不同的扇区
+//   响应：[first:1][count:1][crc32:4LE × count]
+// ─────────────────────────────────────────────────────────────────────────────
+void PlcProtocol::planDelta(const QByteArray& crcResp)
+{
+    const int sectorSize   = static_cast<int>(FLASH_SECTOR_SIZE);
+    const int pagesPerSect = sectorSize / static_cast<int>(FLASH_PAGE_SIZE);
+    const int nSectors     = (m_binData.size() + sectorSize - 1) / sectorSize;
+    if (crcResp.size() < 2 + 4 * nSectors
+        || static_cast<uint8_t>(crcResp[1]) != nSectors) {
+        emit logMessage("Malformed SECTOR_CRC response, falling back to full download.");
+        startFullErase();
+        return;
+    }
+
+    auto u8 = [&](int i) { return static_cast<uint32_t>(static_cast<uint8_t>(crcResp[i])); };
+
+    m_sectors.clear();
+    m_pages.clear();
+    for (int s = 0; s < nSectors; ++s) {
+        QByteArray sect = m_binData.mid(s * sectorSize, sectorSize);
+        sect.append(QByteArray(sectorSize - sect.size(), '\xFF'));
+        const int off = 2 + 4 * s;
+        const uint32_t remote = u8(off) | (u8(off + 1) << 8u)
+                              | (u8(off + 2) << 16u) | (u8(off + 3) << 24u);
+        if (remote == crc32(sect)) continue;
+
+        m_sectors.append(USER_FLASH_SECTOR_START + s);
+        const int totalPages = m_binData.size() / static_cast<int>(FLASH_PAGE_SIZE);
+        for (int p = s * pagesPerSect; p < (s + 1) * pagesPerSect && p < totalPages; ++p)
+            m_pages.append(p);
+    }
+    m_dlTotal = m_pages.size();
+
+    emit logMessage(QString("Delta: %1 of %2 sector(s) changed.")
+                    .arg(m_sectors.size()).arg(nSectors));
+    if (m_sectors.isEmpty()) {
+        sendVerify();
+        return;
+    }
 
+    m_dlStep   = DlStep::EraseSector;
+    m_eraseIdx = 0;
+    sendFrame(CMD_ERASE_SECTOR, QByteArray(1, static_cast<char>(m_sectors[0])));
+    armTimeout(2000);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// 整体校验：[addr:4LE][len:2LE][crc8:1]，协商 CRC-32 后为 [...][crc32:4LE]
+// ─────────────────────────────────────────────────────────────────────────────
+void PlcProtocol::sendVerify()
+{
+    m_dlStep = DlStep::Verify;
+
+    QByteArray vp(m_crc32 ? 10 : 7, '\0');
+    uint32_t addr = USER_FLASH_BASE;
+    uint32_t len  = static_cast<uint32_t>(m_binData.size());
+    vp[0] = static_cast<char>(addr & 0xFFu);
+    vp[1] = static_cast<char>((addr >> 8u) & 0xFFu);
+    vp[2] = static_cast<char>((addr >> 16u) & 0xFFu);
+    vp[3] = static_cast<char>((addr >> 24u) & 0xFFu);
+    vp[4] = static_cast<char>(len & 0xFFu);
+    vp[5] = static_cast<char>((len >> 8u) & 0xFFu);
+    if (m_crc32) {
+        const uint32_t crc = crc32(m_binData);
+        for (int i = 0; i < 4; i++)
+            vp[6 + i] = static_cast<char>((crc >> (8u * i)) & 0xFFu);
+    } else {
+        vp[6] = static_cast<char>(crc8(m_binData));
+    }
+
+    emit logMessage("Verifying...");
+    sendFrame(CMD_VERIFY, vp);
+    armTimeout(4000);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// 开始写页：设备支持 WRITE_SEQ 时走窗口化批量发送，否则逐页停等
+// ─────────────────────────────────────────────────────────────────────────────
+void PlcProtocol::startWrite()
+{
+    m_dlPage = 0;
+    if (m_window <= 0) {
+        m_dlStep = DlStep::Write;
+        startNextPage();
+        return;
+    }
+
+    m_dlStep  = DlStep::WriteWindow;
+    m_nextSeq = 0;
+    m_acked   = 0;
+    m_inFlight.clear();
+    m_retx.clear();
+    m_retries.clear();
+    sendBurst();
+}
+
+// 页载荷：[addr:4LE][data:256]
+QByteArray PlcProtocol::pagePayload(int pageNo) const
+{
     uint32_t addr = USER_FLASH_BASE
-                  + static_cast<uint32_t>(m_dlPage) * FLASH_PAGE_SIZE;
-    QByteArray page = m_binData.mid(m_dlPage * static_cast<int>(FLASH_PAGE_SIZE),
+                  + static_cast<uint32_t>(pageNo) * FLASH_PAGE_SIZE;
+    QByteArray page = m_binData.mid(pageNo * static_cast<int>(FLASH_PAGE_SIZE),
                                     static_cast<int>(FLASH_PAGE_SIZE));
 
-    // 构造载荷：[addr:4LE][data:256]
     QByteArray payload(4 + static_cast<int>(FLASH_PAGE_SIZE), '\0');
     payload[0] = static_cast<char>(addr & 0xFFu);
     payload[1] = static_cast<char>((addr >> 8u)  & 0xFFu);
     payload[2] = static_cast<char>((addr >> 16u) & 0xFFu);
     payload[3] = static_cast<char>((addr >> 24u) & 0xFFu);
     payload.replace(4, static_cast<int>(FLASH_PAGE_SIZE), page);
+    return payload;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// 窗口化写页：先补发待重传的页，再发新页，凑满一批连续发出，末页带 LAST 标志
+//   WRITE_SEQ 载荷：[seq:2LE][flags:1][addr:4LE][data:256]
+// ─────────────────────────────────────────────────────────────────────────────
+void PlcProtocol::sendBurst()
+{
+    if (m_aborting) { fail("Aborted"); return; }
+
+    m_inFlight.clear();
+    while (m_inFlight.size() < m_window && !m_retx.isEmpty())
+        m_inFlight.append(m_retx.takeFirst());
+    while (m_inFlight.size() < m_window && m_nextSeq < m_dlTotal)
+        m_inFlight.append(m_nextSeq++);
+
+    QByteArray burst;
+    for (int i = 0; i < m_inFlight.size(); ++i) {
+        const int seq = m_inFlight[i];
+        QByteArray p(3, '\0');
+        p[0] = static_cast<char>(seq & 0xFF);
+        p[1] = static_cast<char>((seq >> 8) & 0xFF);
+        p[2] = static_cast<char>(i == m_inFlight.size() - 1 ? WRITE_SEQ_LAST : 0);
+        p.append(pagePayload(m_pages[seq]));
+        burst.append(buildFrame(CMD_WRITE_SEQ, p));
+    }
+    m_transport->write(burst);
+
+    emit logMessage(QString("  Burst: %1 page(s), %2/%3 confirmed")
+                    .arg(m_inFlight.size()).arg(m_acked).arg(m_dlTotal));
+    armTimeout(3000);
+}
+
+void PlcProtocol::onWriteSeqResult(uint16_t seq, uint8_t status)
+{
+    if (!m_inFlight.removeOne(seq)) {
+        armTimeout(3000);   // 迟到的重复回复，忽略
+        return;
+    }
+
+    if (status == 0) {
+        ++m_acked;
+        emit downloadProgress(m_acked, m_dlTotal);
+    } else if (++m_retries[seq] > kMaxRetries) {
+        fail(QString("Page %1 failed after %2 retries (status %3)")
+             .arg(m_pages[seq]).arg(kMaxRetries).arg(status));
+        return;
+    } else {
+        m_retx.append(seq);
+    }
+
+    if (!m_inFlight.isEmpty()) {
+        armTimeout(3000);
+    } else if (m_acked >= m_dlTotal) {
+        sendVerify();
+    } else {
+        sendBurst();
+    }
+}
+
+// 本批超时：未确认的页全部转入重传（各自计重试次数）
+void PlcProtocol::retransmitInFlight(const QString& why)
+{
+    for (int seq : m_inFlight) {
+        if (++m_retries[seq] > kMaxRetries) {
+            fail(QString("Page %1: %2").arg(m_pages[seq]).arg(why));
+            return;
+        }
+        m_retx.append(seq);
+    }
+    emit logMessage(QString("  %1, resending %2 page(s)").arg(why).arg(m_inFlight.size()));
+    sendBurst();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// 写入下一页（停等模式）
+// ─────────────────────────────────────────────────────────────────────────────
+void PlcProtocol::startNextPage()
+{
+    if (m_aborting) { fail("Aborted"); return; }
+
+    const int pageNo = m_pages[m_dlPage];
+    uint32_t addr = USER_FLASH_BASE
+                  + static_cast<uint32_t>(pageNo) * FLASH_PAGE_SIZE;
 
     emit logMessage(QString("  Page %1/%2 → 0x%3")
                     .arg(m_dlPage + 1).arg(m_dlTotal)
                     .arg(addr, 8, 16, QChar('0')));
 
-    sendFrame(CMD_WRITE_PAGE, payload);
+    sendFrame(CMD_WRITE_PAGE, pagePayload(pageNo));
     armTimeout(3000);
 }
 
 void PlcProtocol::onTimeout()
 {
+    if (m_dlStep == DlStep::WriteWindow && !m_inFlight.isEmpty()) {
+        retransmitInFlight("Timeout");
+        return;
+    }
     fail(QString("Timeout waiting for response (step %1)")
          .arg(static_cast<int>(m_dlStep)));
 }
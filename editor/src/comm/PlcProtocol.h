@@ -1,17 +1,46 @@
 #pragma once
 #include <QObject>
 #include <QByteArray>
+#include <QHash>
+#include <QList>
 #include <QString>
 #include <cstdint>
 
 class IPlcTransport;
 class QTimer;
 
+// GET_STATS 响应中单个分布（扫描执行时间 / 启动抖动）的统计
+struct PlcScanDist {
+    static constexpr int kBuckets = 8;
+    uint32_t count = 0;
+    uint32_t minUs = 0;
+    uint32_t maxUs = 0;
+    uint32_t avgUs = 0;            // 1/16 指数滑动平均
+    uint16_t hist[kBuckets] = {};  // 分档上界见 runtime/app/scan_timer.c
+};
+
+struct PlcScanStats {
+    uint32_t    periodUs = 0;
+    PlcScanDist exec;
+    PlcScanDist jitter;
+};
+
+// GET_TASKS 响应中单个周期任务的统计（见 runtime/app/scheduler.c）
+struct PlcTaskStats {
+    uint16_t periodMs = 0;
+    uint8_t  priority = 0;
+    uint32_t runs     = 0;
+    uint32_t overruns = 0;   // 周期到达时仍在执行
+    uint32_t missed   = 0;   // 周期到达时上一次触发尚未执行
+    uint32_t maxUs    = 0;
+};
+
 // ─────────────────────────────────────────────────────────────────────────────
 // PlcProtocol — TiZi Runtime 下载协议
 //
 // 协议帧格式（与 runtime/app/runtime.c 完全对应）：
-//   [SOF:0xAA][CMD:1][LEN_LO:1][LEN_HI:1][DATA:LEN][CRC8:1]
+//   [SOF:0xAA][CMD:1][LEN_LO:1][LEN_HI:1][DATA:LEN][CRC:1 或 4]
+//   CRC 默认 CRC-8/MAXIM；PING 响应声明 CAP_CRC32 后，非 PING 帧改用 CRC-32/IEEE（4 字节小端）
 //
 // 响应：
 //   ACK  (0x06) — 单字节，命令成功
@@ -19,6 +48,13 @@ class QTimer;
 //   完整帧 — PING / GET_STATUS / READ_IO 的响应
 //
 // 下载流程：PING → ERASE → WRITE_PAGE×N → VERIFY → RESET
+// 增量下载：PING → SECTOR_CRC → ERASE_SECTOR×k → WRITE_PAGE×4k → VERIFY → RESET
+//           只重写 CRC-32 与本地映像不同的扇区；设备不支持 SECTOR_CRC 时回退全量下载
+// 窗口化写页：PING 响应声明 CAP_WRITE_SEQ 时，WRITE_PAGE 换成 WRITE_SEQ，
+//           每批 window 页连续发送（末页带 LAST 标志），设备整批编程后逐页回复 seq，
+//           只重传失败/超时未确认的页；否则逐页停等
+// 映像指纹：PING 响应声明 CAP_LOGIC_HASH 时先发 GET_HASH，设备 B 区指纹（长度 + CRC-32）
+//           与本地映像一致则跳过擦写，直接报告 downloadSkipped()
 // ─────────────────────────────────────────────────────────────────────────────
 class PlcProtocol : public QObject {
     Q_OBJECT
@@ -26,6 +62,10 @@ public:
     // 与 runtime/shared_interface.h 保持一致
     static constexpr uint32_t USER_FLASH_BASE = 0x00004000u;
     static constexpr uint32_t FLASH_PAGE_SIZE = 256u;
+    static constexpr uint32_t FLASH_SECTOR_SIZE = 1024u;
+    static constexpr uint32_t USER_IMAGE_MAX_SIZE = 16u * 1024u - 256u;  // 末页为指纹尾页
+    static constexpr int      USER_FLASH_SECTOR_START = 16;
+    static constexpr int      USER_FLASH_SECTOR_COUNT = 16;
 
     // 命令码
     static constexpr uint8_t CMD_PING        = 0x01;
@@ -33,15 +73,35 @@ public:
     static constexpr uint8_t CMD_WRITE_PAGE  = 0x03;
     static constexpr uint8_t CMD_VERIFY      = 0x04;
     static constexpr uint8_t CMD_RESET       = 0x05;
+    static constexpr uint8_t CMD_SECTOR_CRC  = 0x06;
+    static constexpr uint8_t CMD_ERASE_SECTOR = 0x07;
+    static constexpr uint8_t CMD_WRITE_SEQ   = 0x08;
+    static constexpr uint8_t CMD_GET_HASH    = 0x09;
     static constexpr uint8_t CMD_GET_STATUS  = 0x10;
     static constexpr uint8_t CMD_SET_RUN     = 0x11;
     static constexpr uint8_t CMD_READ_IO     = 0x12;
+    static constexpr uint8_t CMD_GET_STATS   = 0x13;
+    static constexpr uint8_t CMD_GET_TASKS   = 0x14;
+
+    // PING 能力位（响应第 9 字节），第 10 字节为窗口页数
+    static constexpr uint8_t CAP_WRITE_SEQ   = 0x01;
+    static constexpr uint8_t CAP_CRC32       = 0x02;
+    static constexpr uint8_t CAP_LOGIC_HASH  = 0x04;
+
+    // PING 请求载荷标志
+    static constexpr uint8_t PING_REQ_CRC32  = 0x01;
 
     explicit PlcProtocol(IPlcTransport* transport, QObject* parent = nullptr);
 
     // ── 高层操作 ──────────────────────────────────────────────
     // 下载二进制到 Flash B 区，自动完成 PING/ERASE/WRITE/VERIFY/RESET
-    void downloadBinary(const QByteArray& bin);
+    // delta = true 时先比对映像指纹与扇区 CRC，只擦写有变化的扇区；
+    // false 强制全量擦写
+    void downloadBinary(const QByteArray& bin, bool delta = true);
+
+    // 映像指纹（按页补齐后的 CRC-32），与设备 GET_HASH 的 crc32 字段对应
+    static QByteArray padToPage(const QByteArray& bin);
+    static uint32_t   imageHash(const QByteArray& bin);
     void abort();
 
     // ── 单独命令（下载之外的运行时控制）──────────────────────
@@ -49,15 +109,20 @@ public:
     void sendGetStatus();
     void sendSetRun(bool run);
     void sendReadIo();
+    void sendGetStats(bool reset = false);
+    void sendGetTasks(bool reset = false);
 
 signals:
     void pingResponse(const QString& version);
     void statusResponse(bool running, uint32_t scanTimeUs);
     void ioResponse(uint8_t diBits, uint8_t doBits);
+    void statsResponse(const PlcScanStats& stats);
+    void tasksResponse(const QList<PlcTaskStats>& tasks);
 
     // 下载进度
     void downloadProgress(int page, int totalPages);
     void downloadComplete();
+    void downloadSkipped(uint32_t hash);   // 设备映像指纹与本地一致，未擦写
     void downloadFailed(const QString& reason);
 
     // 日志（供 DownloadDialog 显示）
@@ -76,7 +141,7 @@ private:
 
     // ── 下载流程步骤 ──────────────────────────────────────────
     enum class DlStep {
-        Idle, Ping, Erase, Write, Verify, Reset
+        Idle, Ping, Hash, SectorCrc, Erase, EraseSector, Write, WriteWindow, Verify, Reset
     };
 
     IPlcTransport* m_transport;
@@ -88,19 +153,43 @@ private:
     uint16_t   m_frameLen   = 0;
     uint16_t   m_frameIdx   = 0;
     QByteArray m_frameData;
+    QByteArray m_frameCrc;
+    bool       m_crc32      = false;  // PING 协商结果：非 PING 帧使用 CRC-32 尾
+    uint8_t    m_caps       = 0;      // 最近一次 PING 响应的能力位
 
     // 下载状态
     DlStep     m_dlStep   = DlStep::Idle;
     QByteArray m_binData;
-    int        m_dlPage   = 0;
+    bool       m_delta    = true;
+    QList<int> m_pages;          // 待写入的页号（相对 USER_FLASH_BASE）
+    QList<int> m_sectors;        // 增量模式下待擦除的扇区号
+    int        m_eraseIdx = 0;
+    int        m_dlPage   = 0;   // m_pages 中的下标
     int        m_dlTotal  = 0;
     bool       m_aborting = false;
 
+    // 窗口化写页状态（seq = m_pages 下标）
+    int             m_window   = 0;   // 设备声明的窗口页数，0 = 停等模式
+    int             m_nextSeq  = 0;   // 下一个首次发送的 seq
+    int             m_acked    = 0;
+    QList<int>      m_inFlight;       // 本批已发送、未确认的 seq
+    QList<int>      m_retx;           // 待重传的 seq
+    QHash<int, int> m_retries;
+
+    static constexpr int kMaxRetries = 3;
+    static constexpr uint8_t WRITE_SEQ_LAST = 0x01;
+
     static constexpr uint8_t SOF = 0xAA;
     static constexpr uint8_t ACK = 0x06;
     static constexpr uint8_t NAK = 0x15;
 
     static uint8_t    crc8(const QByteArray& data);
+    static uint32_t   crc32(const QByteArray& data);
+    int               frameCrcLen(uint8_t cmd) const;
+    QByteArray        pingPayload();
+    void              applyCaps(const QByteArray& pingData);
+    static bool       parseStats(const QByteArray& data, PlcScanStats& out);
+    static bool       parseTasks(const QByteArray& data, QList<PlcTaskStats>& out);
     QByteArray        buildFrame(uint8_t cmd, const QByteArray& payload = {});
     void              sendFrame(uint8_t cmd, const QByteArray& payload = {});
     void              armTimeout(int ms);
@@ -109,5 +198,15 @@ private:
     void onResponse(bool isAck, uint8_t cmd, const QByteArray& data);
     void onTimeout();
     void startNextPage();
+    void startWrite();
+    void sendBurst();
+    void onWriteSeqResult(uint16_t seq, uint8_t status);
+    void retransmitInFlight(const QString& why);
+    QByteArray pagePayload(int pageNo) const;
+    void startTransfer();
+    void checkHash(const QByteArray& hashResp);
+    void startFullErase();
+    void planDelta(const QByteArray& crcResp);
+    void sendVerify();
     void fail(const QString& reason);
 };
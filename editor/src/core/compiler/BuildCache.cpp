@@ -0,0 +1,150 @@
+#include "BuildCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace {
+
+const char* kStStamp = ".tizi_st_key";
+
+QByteArray readAll(const QString& path)
+{
+    QFile f(path);
+    return f.open(QFile::ReadOnly) ? f.readAll() : QByteArray();
+}
+
+// 递归收集 #include "..."（只在 searchDirs 中查找；<...> 系统头由工具标识覆盖）
+void collectIncludes(const QString& file, const QStringList& searchDirs,
+                     QStringList& out, QSet<QString>& seen)
+{
+    static const QRegularExpression re(QStringLiteral("^\\s*#\\s*include\\s*\"([^\"]+)\""),
+                                       QRegularExpression::MultilineOption);
+    const QByteArray text = readAll(file);
+    auto it = re.globalMatch(QString::fromUtf8(text));
+    while (it.hasNext()) {
+        const QString name = it.next().captured(1);
+        QStringList dirs = {QFileInfo(file).absolutePath()};
+        dirs << searchDirs;
+        for (const QString& d : dirs) {
+            const QString p = QFileInfo(d + "/" + name).absoluteFilePath();
+            if (!QFileInfo::exists(p)) continue;
+            if (!seen.contains(p)) {
+                seen.insert(p);
+                out << p;
+                collectIncludes(p, searchDirs, out, seen);
+            }
+            break;
+        }
+    }
+}
+
+} // namespace
+
+BuildCache::BuildCache(const QString& cacheDir)
+    : m_dir(cacheDir)
+{
+    QDir().mkpath(m_dir + "/obj");
+}
+
+QByteArray BuildCache::toolId(const QString& program)
+{
+    QString path = program;
+    if (!QFileInfo(path).isAbsolute())
+        path = QStandardPaths::findExecutable(program);
+    const QFileInfo fi(path);
+    if (path.isEmpty() || !fi.exists())
+        return program.toUtf8();
+    return QString("%1|%2|%3").arg(fi.absoluteFilePath()).arg(fi.size())
+        .arg(fi.lastModified().toMSecsSinceEpoch()).toUtf8();
+}
+
+// ─────────────────────────────────────────────────────────────
+// ST 级
+// ─────────────────────────────────────────────────────────────
+QByteArray BuildCache::stKey(const QByteArray& stText, const QString& iec2cPath) const
+{
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    h.addData(toolId(iec2cPath));
+    h.addData(QByteArrayView("\0", 1));
+    h.addData(stText);
+    return h.result().toHex();
+}
+
+bool BuildCache::stUpToDate(const QByteArray& key, const QString& outDir) const
+{
+    return QFileInfo::exists(outDir + "/config.c")
+        && readAll(outDir + "/" + kStStamp).trimmed() == key;
+}
+
+void BuildCache::storeStKey(const QByteArray& key, const QString& outDir) const
+{
+    QFile f(outDir + "/" + kStStamp);
+    if (f.open(QFile::WriteOnly | QFile::Truncate))
+        f.write(key + '\n');
+}
+
+void BuildCache::invalidateSt(const QString& outDir) const
+{
+    QFile::remove(outDir + "/" + kStStamp);
+}
+
+// ─────────────────────────────────────────────────────────────
+// 目标文件级
+// ─────────────────────────────────────────────────────────────
+QByteArray BuildCache::objectKey(const QString& source, const QByteArray& compilerId,
+                                 const QStringList& args, const QStringList& includeDirs) const
+{
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    h.addData(compilerId);
+    h.addData(QByteArrayView("\0", 1));
+    h.addData(args.join('\x1f').toUtf8());
+    h.addData(QByteArrayView("\0", 1));
+    h.addData(readAll(source));
+
+    // 依赖按文件名排序后计入，与 include 出现顺序无关
+    QStringList deps;
+    QSet<QString> seen;
+    collectIncludes(source, includeDirs, deps, seen);
+    std::sort(deps.begin(), deps.end());
+    for (const QString& d : deps) {
+        h.addData(QByteArrayView("\0", 1));
+        h.addData(QFileInfo(d).fileName().toUtf8());
+        h.addData(QByteArrayView("\0", 1));
+        h.addData(readAll(d));
+    }
+    return h.result().toHex();
+}
+
+QString BuildCache::objectPath(const QByteArray& key) const
+{
+    return m_dir + "/obj/" + QString::fromLatin1(key) + ".o";
+}
+
+bool BuildCache::hasObject(const QByteArray& key) const
+{
+    return QFileInfo(objectPath(key)).size() > 0;
+}
+
+void BuildCache::touch(const QByteArray& key) const
+{
+    QFile f(objectPath(key));
+    if (f.open(QFile::ReadWrite))
+        f.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+}
+
+void BuildCache::prune(const QList<QByteArray>& keep, int maxObjects) const
+{
+    QFileInfoList objs = QDir(m_dir + "/obj").entryInfoList({"*.o"}, QDir::Files, QDir::Time);
+    // QDir::Time：最新的在前
+    for (int i = maxObjects; i < objs.size(); ++i) {
+        if (keep.contains(objs[i].completeBaseName().toLatin1())) continue;
+        QFile::remove(objs[i].absoluteFilePath());
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+// ─────────────────────────────────────────────────────────────
+// BuildCache — matiec → gcc 构建流水线的内容寻址缓存
+//
+// 两级缓存，均以内容哈希（SHA-1）为键，不依赖文件时间戳：
+//   1. ST 级：键 = project.st 全文 + iec2c 工具标识。
+//      与上次成功生成时一致则跳过 iec2iec / iec2c，out_c 保持不变。
+//   2. 目标文件级：键 = 源文件内容 + 其引用的生成文件（POUS.c / POUS.h / …）
+//      + 编译器标识 + 完整编译参数。命中时直接复用 <cacheDir>/obj/<key>.o。
+//
+// 缓存粒度是整个工程，不到单个 POU：iec2c 一次处理全部 POU，
+// resource*.c 又 #include 了 POUS.c，任一 POU 改动都会使 ST 级失效并
+// 重新编译 resource 目标文件。改 POU 时能复用的只有 config.c 的目标文件；
+// 工程未变时整条 matiec / 编译链都被跳过。
+//
+// wrapper 每次由模板重新生成，与链接步骤一样总是重新执行。
+// 工具标识 = 可执行文件绝对路径 + 大小 + 修改时间，升级工具链后缓存自动失效。
+// ─────────────────────────────────────────────────────────────
+class BuildCache {
+public:
+    explicit BuildCache(const QString& cacheDir);
+
+    /// 工具标识；program 可为 PATH 中的命令名，找不到时只用名字本身
+    static QByteArray toolId(const QString& program);
+
+    // ── ST 级 ─────────────────────────────────────────────────
+    QByteArray stKey(const QByteArray& stText, const QString& iec2cPath) const;
+    /// outDir 中的生成结果是否由同一份 ST 产生
+    bool       stUpToDate(const QByteArray& key, const QString& outDir) const;
+    /// iec2c 成功后记录；运行前先 invalidate，失败时不会留下过期记录
+    void       storeStKey(const QByteArray& key, const QString& outDir) const;
+    void       invalidateSt(const QString& outDir) const;
+
+    // ── 目标文件级 ────────────────────────────────────────────
+    /// includeDirs 中通过 #include "..." 引用到的文件都计入键
+    QByteArray objectKey(const QString& source, const QByteArray& compilerId,
+                         const QStringList& args, const QStringList& includeDirs) const;
+    QString    objectPath(const QByteArray& key) const;
+    bool       hasObject(const QByteArray& key) const;
+    /// 命中时刷新修改时间，供 prune() 按最近使用淘汰
+    void       touch(const QByteArray& key) const;
+    /// 缓存目标文件多于 maxObjects 时删除最久未用的（keep 中的不删）
+    void       prune(const QList<QByteArray>& keep, int maxObjects = 64) const;
+
+private:
+    QString m_dir;
+};
@@ -0,0 +1,576 @@
+#include "BuildPipeline.h"
+#include "BuildCache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QThread>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+// ─────────────────────────────────────────────────────────────
+// IEC TASK 表 → tizi_tasks.h
+// ─────────────────────────────────────────────────────────────
+// 由 IEC TASK 列表生成 tizi_tasks.h，供驱动模板构造多任务表：
+//   TIZI_TASK_LIST(X) 按 X(body, period_ms, priority) 展开每个任务，
+//   body 依次调用该任务下全部 PROGRAM 实例的 matiec body 函数。
+// 存在无 TASK 的实例、非周期任务或周期超出 16 位时，TIZI_TASK_COUNT 为 0，
+// 模板回退到单任务 config_run__()。*note 返回给控制台的一行说明。
+static QString taskTableHeader(const QList<StGenerator::Task>& tasks, QString* note)
+{
+    QStringList out;
+    out << "/* Generated by TiZi -- IEC task table (CONFIGURATION/RESOURCE/TASK) */"
+        << "/* DO NOT EDIT -- regenerate via TiZi Build                           */"
+        << "#ifndef TIZI_TASKS_H"
+        << "#define TIZI_TASKS_H"
+        << "";
+
+    QString reason = tasks.isEmpty() ? QString("no TASK") : QString();
+    for (const StGenerator::Task& t : tasks) {
+        if (t.programs.isEmpty()) continue;
+        if (t.name.isEmpty()) {
+            reason = QString("PROGRAM without TASK in %1").arg(t.resource);
+            break;
+        }
+        if (t.intervalMs <= 0 || t.intervalMs > 0xFFFF) {
+            reason = QString("TASK %1 has no usable INTERVAL").arg(t.name);
+            break;
+        }
+    }
+
+    if (!reason.isEmpty()) {
+        out << QString("/* single task: %1 */").arg(reason)
+            << "#define TIZI_TASK_COUNT 0"
+            << ""
+            << "#endif /* TIZI_TASKS_H */";
+        *note = "single task (" + reason + ")";
+        return out.join('\n') + '\n';
+    }
+
+    // matiec 生成的 C 标识符全部大写：实例为 RESOURCE__INSTANCE，body 为 TYPE_body__
+    out << "#include \"POUS.h\"" << "";
+    QStringList list;
+    int n = 0;
+    for (const StGenerator::Task& t : tasks) {
+        if (t.programs.isEmpty()) continue;
+        const QString body = QString("tizi_task_%1_body").arg(n++);
+        out << QString("/* TASK %1.%2: INTERVAL %3 ms, PRIORITY %4 */")
+               .arg(t.resource, t.name).arg(t.intervalMs).arg(t.priority);
+        QStringList calls;
+        for (const auto& prog : t.programs) {
+            const QString type = prog.second.toUpper();
+            const QString inst = t.resource.toUpper() + "__" + prog.first.toUpper();
+            out << QString("extern %1 %2;").arg(type, inst);
+            calls << QString("    %1_body__(&%2);").arg(type, inst);
+        }
+        out << QString("static inline void %1(void) {").arg(body);
+        out << calls;
+        out << "}" << "";
+        list << QString("    X(%1, %2u, %3u)").arg(body).arg(t.intervalMs).arg(qBound(0, t.priority, 255));
+    }
+    out << "/* X(body, period_ms, priority) */"
+        << "#define TIZI_TASK_LIST(X) \\"
+        << list.join(" \\\n")
+        << ""
+        << QString("#define TIZI_TASK_COUNT %1").arg(n)
+        << ""
+        << "#endif /* TIZI_TASKS_H */";
+    *note = QString("%1 task(s)").arg(n);
+    return out.join('\n') + '\n';
+}
+
+static bool writeTextFile(const QString& path, const QByteArray& data)
+{
+    QFile f(path);
+    if (!f.open(QFile::WriteOnly | QFile::Text | QFile::Truncate))
+        return false;
+    return f.write(data) == data.size();
+}
+
+// ─────────────────────────────────────────────────────────────
+BuildPipeline::BuildPipeline(QObject* parent)
+    : QObject(parent)
+    , m_maxJobs(qMax(1, QThread::idealThreadCount()))
+{
+}
+
+BuildPipeline::~BuildPipeline()
+{
+    cancel();
+    delete m_cache;
+}
+
+// ─────────────────────────────────────────────────────────────
+// 启动 / 取消
+// ─────────────────────────────────────────────────────────────
+void BuildPipeline::start(const Config& cfg)
+{
+    if (m_running) return;
+
+    m_cfg     = cfg;
+    m_running = true;
+    ++m_gen;
+    m_outDir  = cfg.buildDir + "/out_c";
+    m_stFile  = cfg.buildDir + "/project.st";
+    QDir().mkpath(m_outDir);
+    delete m_cache;
+    m_cache = new BuildCache(cfg.buildDir + "/cache");
+
+    emit output("[ 1/5 ] Generating IEC 61131-3 ST ...");
+
+    // StGenerator 直接从文件流式解析工程 XML，放到工作线程；结果（含 lastError/lastTasks）
+    // 是线程局部的，必须在同一线程内取出
+    const int gen = m_gen;
+    auto* watcher = new QFutureWatcher<StResult>(this);
+    connect(watcher, &QFutureWatcher<StResult>::finished, this, [this, watcher, gen] {
+        const StResult r = watcher->result();
+        watcher->deleteLater();
+        if (gen == m_gen && m_running)
+            onStGenerated(r);
+    });
+    const QString file = cfg.projectFile;
+    watcher->setFuture(QtConcurrent::run([file] {
+        StResult r;
+        r.st    = StGenerator::fromFile(file);
+        r.error = StGenerator::lastError();
+        r.tasks = StGenerator::lastTasks();
+        return r;
+    }));
+}
+
+void BuildPipeline::cancel()
+{
+    if (!m_running) return;
+    ++m_gen;   // 之后到达的进程/线程回调全部丢弃
+    const QList<QProcess*> procs = m_procs;
+    m_procs.clear();
+    for (QProcess* p : procs) {
+        // 不在 GUI 线程等待：kill 后立即返回，进程真正退出后再释放
+        p->disconnect(this);
+        if (auto* timer = p->findChild<QTimer*>()) timer->stop();
+        if (p->state() == QProcess::NotRunning) {
+            p->deleteLater();
+            continue;
+        }
+        connect(p, &QProcess::finished, p, &QObject::deleteLater);
+        connect(p, &QProcess::errorOccurred, p, [p](QProcess::ProcessError e) {
+            if (e == QProcess::FailedToStart) p->deleteLater();
+        });
+        p->kill();
+    }
+    m_pendingJobs.clear();
+    m_activeJobs = 0;
+    m_running = false;
+    emit output("[ Build ] Cancelled.");
+    emit finished(false, {}, "Build cancelled.");
+}
+
+void BuildPipeline::fail(const QString& message)
+{
+    if (!message.isEmpty())
+        emit output("       " + message);
+    m_running = false;
+    emit finished(false, {}, "Build failed.");
+}
+
+void BuildPipeline::succeed(const QString& artifact, const QString& summary)
+{
+    m_running = false;
+    emit finished(true, artifact, summary);
+}
+
+// ─────────────────────────────────────────────────────────────
+// 运行外部工具：合并 stdout/stderr，按行实时转发
+// ─────────────────────────────────────────────────────────────
+void BuildPipeline::runTool(const QString& program, const QStringList& args,
+                            int timeoutMs, DoneFn done)
+{
+    auto* proc  = new QProcess(this);
+    auto* timer = new QTimer(proc);
+    const int gen = m_gen;
+    proc->setProcessChannelMode(QProcess::MergedChannels);
+    m_procs << proc;
+
+    auto flushLines = [this, proc](bool all) {
+        while (proc->canReadLine()) {
+            const QString line = QString::fromLocal8Bit(proc->readLine()).trimmed();
+            if (!line.isEmpty()) emit output(line);
+        }
+        if (all) {
+            const QString rest = QString::fromLocal8Bit(proc->readAll()).trimmed();
+            if (!rest.isEmpty()) emit output(rest);
+        }
+    };
+    auto finish = [this, proc, gen, done](bool ok) {
+        m_procs.removeOne(proc);
+        proc->deleteLater();
+        if (gen == m_gen && m_running)
+            done(ok);
+    };
+
+    connect(proc, &QProcess::readyReadStandardOutput, this, [flushLines] { flushLines(false); });
+    connect(proc, &QProcess::finished, this,
+            [flushLines, finish](int exitCode, QProcess::ExitStatus status) {
+        flushLines(true);
+        finish(status == QProcess::NormalExit && exitCode == 0);
+    });
+    connect(proc, &QProcess::errorOccurred, this, [this, proc, program, finish](QProcess::ProcessError e) {
+        if (e != QProcess::FailedToStart) return;   // 其余错误随后还会收到 finished
+        emit output("       Error: cannot start " + program);
+        finish(false);
+    });
+
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, [this, proc, program] {
+        emit output(QString("       Error: %1 timed out.").arg(QFileInfo(program).fileName()));
+        proc->kill();
+    });
+    timer->start(timeoutMs);
+
+    proc->start(program, args);
+}
+
+// ─────────────────────────────────────────────────────────────
+// [1/5] → [2/5] [3/5]
+// ─────────────────────────────────────────────────────────────
+void BuildPipeline::onStGenerated(const StResult& r)
+{
+    if (r.st.isEmpty()) {
+        fail("Error: " + r.error);
+        return;
+    }
+    m_tasks = r.tasks;
+    emit output(QString("       OK — %1 lines").arg(r.st.count('\n') + 1));
+
+    const QByteArray stBytes = r.st.toUtf8();
+    if (!writeTextFile(m_stFile, stBytes)) {
+        fail("Error: cannot write " + m_stFile);
+        return;
+    }
+
+    // ST 未变则跳过 iec2iec / iec2c，out_c 原样保留
+    m_stKey = m_cache->stKey(stBytes, m_cfg.matiecDir + "/iec2c");
+    if (m_cfg.useCache && m_cache->stUpToDate(m_stKey, m_outDir)) {
+        emit output("[ 2/5 ] ST unchanged -- iec2iec skipped (cached)");
+        emit output("[ 3/5 ] ST unchanged -- iec2c skipped (cached)");
+        afterTranslate();
+        return;
+    }
+    m_cache->invalidateSt(m_outDir);
+    translate();
+}
+
+void BuildPipeline::translate()
+{
+    const QString libDir = m_cfg.matiecDir + "/lib";
+
+    emit output("[ 2/5 ] Validating ST (iec2iec) ...");
+    // -p: 允许前向引用  -i: 允许无参数 POU（PROGRAM 通常无 I/O 参数）
+    runTool(m_cfg.matiecDir + "/iec2iec", {"-p", "-i", "-I", libDir, m_stFile}, 30000,
+            [this, libDir](bool ok) {
+        if (!ok) { fail("Validation FAILED."); return; }
+        emit output("       OK");
+
+        emit output("[ 3/5 ] Compiling to C (iec2c) ...");
+        runTool(m_cfg.matiecDir + "/iec2c",
+                {"-p", "-i", "-I", libDir, "-T", m_outDir, m_stFile}, 30000,
+                [this](bool ok) {
+            if (!ok) { fail("Compilation FAILED."); return; }
+            m_cache->storeStKey(m_stKey, m_outDir);
+            emit output("       OK");
+            afterTranslate();
+        });
+    });
+}
+
+// ─────────────────────────────────────────────────────────────
+// [4/5] wrapper + [5/5] 编译
+// ─────────────────────────────────────────────────────────────
+void BuildPipeline::afterTranslate()
+{
+    const QJsonObject& comp = m_cfg.compiler;
+    const bool xcode = (m_cfg.mode == "XCODE");
+
+    // 收集 matiec 生成的 C 源文件（resource*.c 已 #include POUS.c，勿重复编译）
+    m_iecSources = QStringList{m_outDir + "/config.c"};
+    for (const QFileInfo& fi : QDir(m_outDir).entryInfoList({"resource*.c"}, QDir::Files))
+        m_iecSources << fi.absoluteFilePath();
+
+    // IEC TASK 表（tizi_tasks.h，位于 -I outDir 下，由支持多任务的模板引用）
+    {
+        QString note;
+        writeTextFile(m_outDir + "/tizi_tasks.h", taskTableHeader(m_tasks, &note).toUtf8());
+        emit output("       Task table: " + note);
+    }
+
+    if (xcode) {
+        emit output(QString("       WASI-SDK: %1").arg(m_cfg.wasiSdkDir));
+        emit output("[ 4/5 ] Generating WASM wrapper from driver template ...");
+        emit output(QString("       Driver: %1  [XCODE]").arg(m_cfg.driver["name"].toString()));
+    } else {
+        emit output("[ 4/5 ] Generating wrapper from driver template ...");
+        emit output(QString("       Driver: %1  [NCC]").arg(m_cfg.driver["name"].toString()));
+    }
+
+    const QString templatePath = m_cfg.driverDir + "/" + comp["template"].toString();
+    QByteArray wrapperContent;
+    {
+        QFile tmpl(templatePath);
+        if (!tmpl.open(QFile::ReadOnly | QFile::Text)) {
+            fail("Error: cannot read template: " + templatePath);
+            return;
+        }
+        wrapperContent = tmpl.readAll();
+    }
+    const QString outputName = comp["output_name"].toString("plc_program");
+    m_wrapperFile = m_cfg.buildDir + "/" + outputName + "_main.c";
+    if (!writeTextFile(m_wrapperFile, wrapperContent)) {
+        fail("Error: cannot write wrapper file.");
+        return;
+    }
+    emit output("       OK");
+
+    // 编译参数（IEC 目标文件与 wrapper 共用）
+    QString cc;
+    QStringList cargs;
+    if (xcode) {
+        cc = m_cfg.wasiSdkDir + "/bin/clang";
+        emit output("[ 5/5 ] Compiling to WASM (wasi-clang) ...");
+        // sysroot + target
+        cargs << "--sysroot=" + m_cfg.wasiSdkDir + "/share/wasi-sysroot";
+    } else {
+        cc = comp["cc"].toString("gcc");
+        emit output(QString("[ 5/5 ] Compiling for \"%1\" (%2) ...").arg(m_cfg.target, cc));
+    }
+
+    // driver cflags（XCODE 含 --target=wasm32-wasi）
+    for (const QJsonValue& v : comp["cflags"].toArray())
+        cargs << v.toString();
+
+    // driver include_dirs（相对 driverDir）
+    for (const QJsonValue& v : comp["include_dirs"].toArray())
+        cargs << "-I" << (m_cfg.driverDir + "/" + v.toString());
+
+    // driver defines（{"NAME": 值}，bool 写为 0/1；如 Linux 的 TIZI_RT 实时选项）
+    const QJsonObject defines = comp["defines"].toObject();
+    for (auto it = defines.begin(); it != defines.end(); ++it) {
+        const QJsonValue v = it.value();
+        const QString val = v.isBool()   ? QString::number(v.toBool() ? 1 : 0)
+                          : v.isDouble() ? QString::number(v.toInteger())
+                                         : v.toString();
+        cargs << QString("-D%1=%2").arg(it.key(), val);
+    }
+
+    // matiec lib/C 头文件 + iec2c 生成的头文件
+    cargs << "-I" << m_cfg.matiecDir + "/lib/C"
+          << "-I" << m_outDir;
+    // 注意：WASI sysroot 自带 time.h，不需要 -include time.h
+    if (!xcode)
+        cargs << "-include" << "time.h";
+
+    // 项目级别自定义编译标志（可覆盖 driver 默认值）
+    cargs << m_cfg.cflags;
+
+    compileObjects(cc, cargs, [this, cc, cargs](bool ok) {
+        if (!ok) { fail({}); return; }
+        link(cc, cargs, m_objects);
+    });
+}
+
+// 逐个编译 matiec 生成的 C 文件（-c），内容/参数/工具链未变的复用缓存目标文件；
+// 需要编译的文件并行启动，最多 m_maxJobs 个进程
+void BuildPipeline::compileObjects(const QString& cc, const QStringList& compileArgs, DoneFn done)
+{
+    const QByteArray  ccId    = BuildCache::toolId(cc);
+    const QStringList incDirs = {m_outDir, m_cfg.matiecDir + "/lib/C"};
+
+    QList<QByteArray> keys;
+    m_objects.clear();
+    m_pendingJobs.clear();
+    m_activeJobs    = 0;
+    m_compileFailed = false;
+    for (const QString& src : m_iecSources) {
+        const QByteArray key = m_cache->objectKey(src, ccId, compileArgs, incDirs);
+        keys << key;
+        m_objects << m_cache->objectPath(key);
+        if (m_cfg.useCache && m_cache->hasObject(key))
+            m_cache->touch(key);
+        else
+            m_pendingJobs.append({src, m_cache->objectPath(key)});
+    }
+    m_cache->prune(keys);
+
+    const int toCompile = m_pendingJobs.size();
+    emit output(QString("       IEC objects: %1 to compile, %2 cached (%3 job(s))")
+                .arg(toCompile).arg(m_iecSources.size() - toCompile)
+                .arg(qMin(m_maxJobs, qMax(1, toCompile))));
+    if (toCompile == 0) {
+        done(true);
+        return;
+    }
+    launchCompiles(cc, compileArgs, done);
+}
+
+void BuildPipeline::launchCompiles(const QString& cc, const QStringList& compileArgs, DoneFn done)
+{
+    while (m_activeJobs < m_maxJobs && !m_pendingJobs.isEmpty() && !m_compileFailed) {
+        const CompileJob job = m_pendingJobs.takeFirst();
+        ++m_activeJobs;
+        const QString tmp = job.object + ".tmp";
+        runTool(cc, QStringList(compileArgs) << "-c" << job.source << "-o" << tmp, 60000,
+                [this, cc, compileArgs, done, job, tmp](bool ok) {
+            --m_activeJobs;
+            if (ok) {
+                QFile::remove(job.object);
+                QFile::rename(tmp, job.object);
+            } else {
+                QFile::remove(tmp);
+                m_compileFailed = true;
+                emit output("       Compilation FAILED: " + QFileInfo(job.source).fileName());
+            }
+            if (m_activeJobs == 0 && (m_pendingJobs.isEmpty() || m_compileFailed)) {
+                m_pendingJobs.clear();
+                done(!m_compileFailed);
+            } else {
+                launchCompiles(cc, compileArgs, done);
+            }
+        });
+    }
+}
+
+// 链接：wrapper 每次重新编译，IEC 部分使用目标文件
+void BuildPipeline::link(const QString& cc, const QStringList& compileArgs,
+                         const QStringList& objects)
+{
+    const QJsonObject& comp = m_cfg.compiler;
+    const bool    xcode      = (m_cfg.mode == "XCODE");
+    const QString outputName = comp["output_name"].toString("plc_program");
+    const QString outFile    = m_cfg.buildDir + "/" + outputName
+                             + comp["output_suffix"].toString(xcode ? ".wasm" : "");
+
+    QStringList args = compileArgs;
+
+    // linker script（可选，Embedded 专用）
+    const QString ldRel = comp["linker_script"].toString();
+    if (!ldRel.isEmpty())
+        args << "-Wl,-T," + m_cfg.driverDir + "/" + ldRel;
+
+    args << m_wrapperFile << objects
+         << "-o" << outFile;
+
+    // driver ldflags（XCODE：--no-entry / --export=...）
+    for (const QJsonValue& v : comp["ldflags"].toArray())
+        args << v.toString();
+
+    // 项目级别自定义链接标志
+    args << m_cfg.ldflags;
+
+    runTool(cc, args, 60000, [this, xcode, outFile, outputName](bool ok) {
+        if (!ok) {
+            fail(xcode ? "WASM compilation FAILED." : "Compilation FAILED.");
+            return;
+        }
+        if (xcode) {
+            if (m_cfg.compiler["aot"].toObject()["enabled"].toBool()) {
+                aotCompile(outFile);
+                return;
+            }
+            const qint64 size = QFileInfo(outFile).size();
+            const QString name = QFileInfo(outFile).fileName();
+            emit output("─────────────────────────────────────────");
+            emit output(QString("[ Build ] SUCCESS  -->  %1  (%2 bytes)").arg(name).arg(size));
+            succeed(outFile, QString("Build complete -- %1 (%2 bytes)").arg(name).arg(size));
+            return;
+        }
+        postBuild(outFile, outputName);
+    });
+}
+
+// XCODE 可选步骤：wamrc 把 .wasm 预编译为 WAMR AOT 镜像（plc_init / plc_run 约定不变）
+// driver.json compiler.xcode.aot：
+//   { "enabled": true, "wamrc": "wamrc", "target": "x86_64", "flags": ["--opt-level=3"] }
+// wamrc 为相对名时依次查找 <tools/wasm>/wamrc（与 wasi-sdk 同级）和 PATH。
+void BuildPipeline::aotCompile(const QString& wasmFile)
+{
+    const QJsonObject aot = m_cfg.compiler["aot"].toObject();
+    QString wamrc = aot["wamrc"].toString("wamrc");
+    if (QFileInfo(wamrc).isRelative()) {
+        const QString bundled = QFileInfo(m_cfg.wasiSdkDir).absolutePath() + "/" + wamrc;
+        const QString inPath  = QStandardPaths::findExecutable(wamrc);
+        wamrc = QFileInfo(bundled).isExecutable() ? bundled
+              : !inPath.isEmpty()                 ? inPath
+                                                  : wamrc;
+    }
+
+    const QString aotFile = QFileInfo(wasmFile).path() + "/" + QFileInfo(wasmFile).completeBaseName()
+                          + aot["output_suffix"].toString(".aot");
+    QStringList args;
+    const QString target = aot["target"].toString();
+    if (!target.isEmpty())
+        args << "--target=" + target;
+    for (const QJsonValue& v : aot["flags"].toArray())
+        args << v.toString();
+    args << "-o" << aotFile << wasmFile;
+
+    emit output(QString("       AOT: %1 %2 ...").arg(QFileInfo(wamrc).fileName(), target));
+    runTool(wamrc, args, 120000, [this, wasmFile, aotFile](bool ok) {
+        if (!ok) {
+            fail("AOT compilation FAILED.");
+            return;
+        }
+        const qint64 size = QFileInfo(aotFile).size();
+        const QString name = QFileInfo(aotFile).fileName();
+        emit output("─────────────────────────────────────────");
+        emit output(QString("[ Build ] SUCCESS  -->  %1  (%2 bytes, %3 %4 bytes)")
+                    .arg(name).arg(size)
+                    .arg(QFileInfo(wasmFile).fileName()).arg(QFileInfo(wasmFile).size()));
+        succeed(aotFile, QString("Build complete -- %1 (%2 bytes)").arg(name).arg(size));
+    });
+}
+
+// post_build（可选，如 Embedded 的 objcopy .elf -> .bin）
+// 在新的嵌套 compiler 结构中，post_build 在 compiler.ncc 内；
+// 旧扁平结构中在顶层 driver。两处都检查，优先 compiler。
+void BuildPipeline::postBuild(const QString& elfFile, const QString& outputName)
+{
+    auto done = [this](const QString& finalOutput) {
+        emit output("─────────────────────────────────────────");
+        emit output(QString("[ Build ] SUCCESS  -->  %1").arg(finalOutput));
+        succeed(finalOutput,
+                QString("Build complete -- %1").arg(QFileInfo(finalOutput).fileName()));
+    };
+
+    const QJsonObject& comp = m_cfg.compiler;
+    if (!comp.contains("post_build") && !m_cfg.driver.contains("post_build")) {
+        done(elfFile);
+        return;
+    }
+    const QJsonObject pb = comp.contains("post_build")
+        ? comp["post_build"].toObject()
+        : m_cfg.driver["post_build"].toObject();
+    const QString objcopy   = pb["objcopy"].toString();
+    const QString format    = pb["format"].toString("binary");
+    const QString binSuffix = pb["output_suffix"].toString(".bin");
+    const QString binFile   = m_cfg.buildDir + "/" + outputName + binSuffix;
+    const qint64  maxSz     = pb["max_size_bytes"].toInteger(0);
+
+    emit output(QString("       Post-build: %1 -O %2 ...").arg(objcopy, format));
+    runTool(objcopy, {"-O", format, elfFile, binFile}, 15000,
+            [this, done, objcopy, binFile, outputName, binSuffix, maxSz](bool ok) {
+        if (!ok) {
+            fail(objcopy + " FAILED.");
+            return;
+        }
+        // 显示 .bin 大小与容量限制
+        const qint64 sz = QFileInfo(binFile).size();
+        const QString sizeStr = maxSz > 0
+            ? QString("%1 bytes / %2 max").arg(sz).arg(maxSz)
+            : QString("%1 bytes").arg(sz);
+        emit output(QString("       %1%2  (%3)").arg(outputName, binSuffix, sizeStr));
+        done(binFile);
+    });
+}
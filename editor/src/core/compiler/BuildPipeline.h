@@ -0,0 +1,105 @@
+#pragma once
+#include <QObject>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+#include "StGenerator.h"
+
+class QProcess;
+class BuildCache;
+
+// ─────────────────────────────────────────────────────────────
+// BuildPipeline — 异步构建流水线（不阻塞 GUI 线程）
+//
+//   [1/5] StGenerator      — 工作线程（QtConcurrent）
+//   [2/5] iec2iec          — QProcess 异步
+//   [3/5] iec2c            — QProcess 异步；ST 未变时由 BuildCache 跳过 2/3
+//   [4/5] wrapper 模板     — 写入构建目录
+//   [5/5] 编译 + 链接      — IEC 生成的各 .c 并行 -c（最多 maxJobs 个进程），
+//                            再与 wrapper 一起链接；可选 post_build（objcopy）
+//                            或 XCODE 的 AOT 预编译（wamrc）
+//
+// 所有进程输出按行经 output() 实时转发；cancel() 向全部子进程发送 kill 后
+// 立即返回（不阻塞 GUI 线程），进程退出后异步释放。
+// 对象须在 GUI 线程使用，信号在 GUI 线程发出。
+// ─────────────────────────────────────────────────────────────
+class BuildPipeline : public QObject {
+    Q_OBJECT
+public:
+    struct Config {
+        QString     projectFile;       ///< 已保存的 .tizi 路径（工作线程流式读取）
+        QString     buildDir;          ///< <app>/output/<project>
+        QString     matiecDir;         ///< 含 iec2iec / iec2c / lib
+        QString     driverDir;         ///< 含 driver.json
+        QJsonObject driver;            ///< driver.json 根对象
+        QJsonObject compiler;          ///< driver.compiler.<mode>（或旧的扁平 compiler）
+        QString     mode;              ///< "NCC" / "XCODE"
+        QString     target;            ///< "Linux" / "Mac" / "Embedded"
+        QString     wasiSdkDir;        ///< 仅 XCODE
+        QStringList cflags;            ///< 项目级附加编译标志
+        QStringList ldflags;           ///< 项目级附加链接标志
+        bool        useCache = true;   ///< false = Rebuild：忽略 ST / 目标文件缓存
+    };
+
+    explicit BuildPipeline(QObject* parent = nullptr);
+    ~BuildPipeline() override;
+
+    void start(const Config& cfg);
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    /// 并行编译的最大进程数，默认 QThread::idealThreadCount()
+    void setMaxJobs(int n) { m_maxJobs = qMax(1, n); }
+
+signals:
+    void output(const QString& line);
+    /// ok = false 时 artifact 为空；summary 为状态栏一行说明
+    void finished(bool ok, const QString& artifact, const QString& summary);
+
+private:
+    struct StResult {
+        QString                 st;
+        QString                 error;
+        QList<StGenerator::Task> tasks;
+    };
+    using DoneFn = std::function<void(bool ok)>;
+
+    void onStGenerated(const StResult& r);
+    void translate();
+    void afterTranslate();
+    void compileObjects(const QString& cc, const QStringList& compileArgs, DoneFn done);
+    void launchCompiles(const QString& cc, const QStringList& compileArgs, DoneFn done);
+    void link(const QString& cc, const QStringList& compileArgs, const QStringList& objects);
+    void postBuild(const QString& elfFile, const QString& outputName);
+    void aotCompile(const QString& wasmFile);
+
+    void runTool(const QString& program, const QStringList& args, int timeoutMs, DoneFn done);
+    void fail(const QString& message);
+    void succeed(const QString& artifact, const QString& summary);
+
+    Config      m_cfg;
+    BuildCache* m_cache   = nullptr;
+    bool        m_running = false;
+    int         m_gen     = 0;     // 每次 start/cancel 递增，丢弃上一轮的迟到回调
+    int         m_maxJobs = 1;
+
+    // 构建期间的中间状态
+    QString                  m_outDir;
+    QString                  m_stFile;
+    QByteArray               m_stKey;
+    QList<StGenerator::Task> m_tasks;
+    QStringList              m_iecSources;
+    QString                  m_wrapperFile;
+
+    // 并行编译
+    struct CompileJob { QString source; QString object; };
+    QList<CompileJob>  m_pendingJobs;
+    QStringList        m_objects;
+    int                m_activeJobs = 0;
+    bool               m_compileFailed = false;
+
+    QList<QProcess*>   m_procs;
+};
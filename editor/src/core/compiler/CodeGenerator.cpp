@@ -6,6 +6,7 @@
 #include "../../editor/items/FunctionBlockItem.h"
 #include "../../editor/items/VarBoxItem.h"
 #include "../../editor/items/WireItem.h"
+#include "../../editor/scene/PortIndex.h"
 
 #include <QList>
 #include <QDateTime>
@@ -17,52 +18,19 @@
 // ─────────────────────────────────────────────────────────────
 static constexpr qreal kTol = 8.0;
 
-static qreal dist2(const QPointF& a, const QPointF& b)
-{
-    qreal dx = a.x() - b.x(), dy = a.y() - b.y();
-    return dx*dx + dy*dy;
-}
-
 // ─────────────────────────────────────────────────────────────
-// 在场景中找离 pt 最近（< kTol）的端口
+// 在端口索引中找离 pt 最近（< kTol）的端口
 // ─────────────────────────────────────────────────────────────
 CodeGenerator::PortRef
-CodeGenerator::findPort(QGraphicsScene* scene, const QPointF& pt)
+CodeGenerator::findPort(const PortIndex& ports, const QPointF& pt)
 {
-    PortRef best;
-    qreal   bestD = kTol * kTol;
-
-    auto tryPort = [&](QGraphicsItem* item, int idx, bool isOut, QPointF portPt) {
-        qreal d = dist2(pt, portPt);
-        if (d < bestD) {
-            bestD       = d;
-            best.item   = item;
-            best.index  = idx;
-            best.isOutput = isOut;
-        }
-    };
-
-    for (QGraphicsItem* gi : scene->items()) {
-        if (auto* ct = dynamic_cast<ContactItem*>(gi)) {
-            tryPort(gi, 0, false, ct->leftPort());
-            tryPort(gi, 0, true,  ct->rightPort());
-        }
-        else if (auto* co = dynamic_cast<CoilItem*>(gi)) {
-            tryPort(gi, 0, false, co->leftPort());
-            tryPort(gi, 0, true,  co->rightPort());
-        }
-        else if (auto* fb = dynamic_cast<FunctionBlockItem*>(gi)) {
-            for (int i = 0; i < fb->inputCount();  ++i)
-                tryPort(gi, i, false, fb->inputPortPos(i));
-            for (int i = 0; i < fb->outputCount(); ++i)
-                tryPort(gi, i, true,  fb->outputPortPos(i));
-        }
-        else if (auto* vb = dynamic_cast<VarBoxItem*>(gi)) {
-            tryPort(gi, 0, false, vb->leftPort());
-            tryPort(gi, 0, true,  vb->rightPort());
-        }
-    }
-    return best;
+    const PortIndex::Port p = ports.nearest(pt, kTol,
+        [](const PortIndex::Port& q) { return q.isPin(); });
+    PortRef r;
+    r.item     = p.item;
+    r.index    = p.index;
+    r.isOutput = p.isOutput;
+    return r;
 }
 
 // ─────────────────────────────────────────────────────────────
@@ -70,12 +38,20 @@ CodeGenerator::findPort(QGraphicsScene* scene, const QPointF& pt)
 // ─────────────────────────────────────────────────────────────
 void CodeGenerator::buildConnections(QGraphicsScene* scene, Ctx& ctx)
 {
+    // 复用场景的端口索引；非 LadderScene 时临时建一份
+    PortIndex        local(scene);
+    const PortIndex* ports = PortIndex::of(scene);
+    if (!ports) {
+        local.rebuild();
+        ports = &local;
+    }
+
     for (QGraphicsItem* gi : scene->items()) {
         auto* wire = dynamic_cast<WireItem*>(gi);
         if (!wire) continue;
 
-        PortRef a = findPort(scene, wire->startPos());
-        PortRef b = findPort(scene, wire->endPos());
+        PortRef a = findPort(*ports, wire->startPos());
+        PortRef b = findPort(*ports, wire->endPos());
 
         if (!a.valid() || !b.valid()) continue;
         if (a.isOutput == b.isOutput)  continue;  // 两端同类型，忽略
@@ -8,6 +8,7 @@
 #include <QMap>
 
 class QGraphicsItem;
+class PortIndex;
 
 // ─────────────────────────────────────────────────────────────
 // CodeGenerator
@@ -65,8 +66,8 @@ private:
     // ── 私有方法 ──────────────────────────────────────────────
     // 扫描 WireItem，构建 Ctx.conn
     static void   buildConnections(QGraphicsScene* scene, Ctx& ctx);
-    // 在容差范围内查找 pt 对应的端口
-    static PortRef findPort(QGraphicsScene* scene, const QPointF& pt);
+    // 在容差范围内查找 pt 对应的端口（端口网格索引，不遍历场景）
+    static PortRef findPort(const PortIndex& ports, const QPointF& pt);
     // 按 X 顺序对图元排序（源节点在左）
     static QList<QGraphicsItem*> sortedItems(QGraphicsScene* scene);
     // 为单个图元生成代码，写入 ctx.body / ctx.globals
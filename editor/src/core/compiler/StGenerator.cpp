@@ -1,87 +1,155 @@
 #include "StGenerator.h"
-#include <QDomDocument>
 #include <QFile>
+#include <QHash>
 #include <QMap>
-#include <QSet>
+#include <QRegularExpression>
 #include <QStringList>
+#include <QXmlStreamReader>
+#include <QtConcurrent/QtConcurrentMap>
 #include <algorithm>
+#include <functional>
+#include <queue>
+#include <vector>
 
 // ═══════════════════════════════════════════════════════════════════════════
 // 模块内部实现（匿名命名空间）
 // ═══════════════════════════════════════════════════════════════════════════
 namespace {
 
-static QString g_lastError;
+// 每线程一份：BuildPipeline 工作线程与 GUI 线程（或并发的多个转换）互不覆盖，
+// 调用方在调用 fromXml/fromFile 的同一线程内取 lastError/lastTasks
+static thread_local QString                  g_lastError;
+static thread_local QList<StGenerator::Task>  g_lastTasks;
 
 // ───────────────────────────────────────────────────────────────────────────
-// DOM 辅助
+// 流式读取辅助
+//
+// 单遍 QXmlStreamReader，不建 DOM：每个 read* 函数在对应元素的 StartElement
+// 处被调用，返回时已读完该元素（含 EndElement）。只认直接子元素，
+// 不认识的子树整体跳过。元素名比较用本地名（忽略命名空间前缀）。
 // ───────────────────────────────────────────────────────────────────────────
+using Reader = QXmlStreamReader;
+
+static QString attr(const Reader& r, const char* name, const QString& def = {})
+{
+    const QXmlStreamAttributes a = r.attributes();
+    return a.hasAttribute(QLatin1String(name)) ? a.value(QLatin1String(name)).toString() : def;
+}
+
+static int attrInt(const Reader& r, const char* name)
+{
+    return r.attributes().value(QLatin1String(name)).toInt();
+}
 
-// 按本地名查找第一个子元素（忽略命名空间前缀）
-static QDomElement fc(const QDomElement& p, const QString& localName)
+// 元素全部文本（含子元素内文本，同 QDomElement::text()）
+static QString text(Reader& r)
 {
-    for (QDomElement c = p.firstChildElement(); !c.isNull(); c = c.nextSiblingElement())
-        if (c.localName() == localName) return c;
-    return {};
+    return r.readElementText(Reader::IncludeChildElements);
 }
 
-// 按本地名收集所有直接子元素
-static QList<QDomElement> ch(const QDomElement& p, const QString& localName)
+// <ST>/<IL> 等语言元素内第一个 <xhtml:p> 的 CDATA 文本
+static QString readCdata(Reader& r)
 {
-    QList<QDomElement> r;
-    for (QDomElement c = p.firstChildElement(); !c.isNull(); c = c.nextSiblingElement())
-        if (c.localName() == localName) r << c;
-    return r;
+    QString code;
+    bool    found = false;
+    while (r.readNextStartElement()) {
+        if (!found && r.name() == u"p") { code = text(r); found = true; }
+        else r.skipCurrentElement();
+    }
+    return code;
 }
 
-// 从 <ST>/<IL> 等语言元素内的 <xhtml:p> 提取 CDATA 文本
-static QString cdata(const QDomElement& langEl)
+// <type> / <baseType> / <returnType> → IEC 类型字符串
+static QString readType(Reader& r)
 {
-    for (QDomElement c = langEl.firstChildElement(); !c.isNull(); c = c.nextSiblingElement())
-        if (c.localName() == "p") return c.text();
-    return {};
+    QString type = "ANY";
+    bool    first = true;
+    while (r.readNextStartElement()) {
+        if (!first) { r.skipCurrentElement(); continue; }
+        first = false;
+        if (r.name() == u"derived") {
+            type = attr(r, "name");
+            r.skipCurrentElement();
+        } else if (r.name() == u"array") {
+            QString base = "ANY";
+            bool    seen = false;
+            while (r.readNextStartElement()) {
+                if (!seen && r.name() == u"baseType") { base = readType(r); seen = true; }
+                else r.skipCurrentElement();
+            }
+            type = QString("ARRAY OF %1").arg(base);
+        } else {
+            type = r.name().toString();   // BOOL INT REAL DINT WORD TIME …
+            r.skipCurrentElement();
+        }
+    }
+    return type;
 }
 
-// 从 <type> 元素提取 IEC 类型字符串
-static QString itype(const QDomElement& typeEl)
+// ───────────────────────────────────────────────────────────────────────────
+// 变量声明
+// ───────────────────────────────────────────────────────────────────────────
+struct VarDecl {
+    QString name;
+    QString type;
+    QString init;            // " := <值>"；空 = 无初始值
+};
+
+struct VarBlock {
+    bool           present  = false;
+    bool           constant = false;
+    QList<VarDecl> vars;
+};
+
+// <inputVars> / <localVars> / <globalVars> …
+static VarBlock readVarBlock(Reader& r)
 {
-    if (typeEl.isNull()) return "ANY";
-    QDomElement child = typeEl.firstChildElement();
-    if (child.isNull()) return "ANY";
-    if (child.localName() == "derived") return child.attribute("name");
-    if (child.localName() == "array") {
-        QString base = itype(fc(child, "baseType"));
-        return QString("ARRAY OF %1").arg(base);
-    }
-    return child.localName(); // BOOL INT REAL DINT WORD TIME …
+    VarBlock b;
+    b.present  = true;
+    b.constant = attr(r, "constant") == "true";
+    while (r.readNextStartElement()) {
+        if (r.name() != u"variable") { r.skipCurrentElement(); continue; }
+        VarDecl v;
+        v.name = attr(r, "name");
+        v.type = "ANY";
+        bool typeSeen = false, initSeen = false;
+        while (r.readNextStartElement()) {
+            if (!typeSeen && r.name() == u"type") {
+                v.type   = readType(r);
+                typeSeen = true;
+            } else if (!initSeen && r.name() == u"initialValue") {
+                initSeen = true;
+                bool simple = false;
+                while (r.readNextStartElement()) {
+                    if (!simple && r.name() == u"simpleValue") {
+                        v.init = " := " + attr(r, "value");
+                        simple = true;
+                    }
+                    r.skipCurrentElement();
+                }
+            } else {
+                r.skipCurrentElement();
+            }
+        }
+        b.vars << v;
+    }
+    return b;
 }
 
 // ───────────────────────────────────────────────────────────────────────────
 // 生成变量声明块
 // ───────────────────────────────────────────────────────────────────────────
-static void emitVarBlock(const QDomElement& varsEl,
+static void emitVarBlock(const VarBlock& block,
                           const QString& keyword,
                           bool isConst,
                           QStringList& out,
                           const QString& indent = "")
 {
-    if (varsEl.isNull()) return;
-    auto vars = ch(varsEl, "variable");
-    if (vars.isEmpty()) return;
+    if (!block.present || block.vars.isEmpty()) return;
 
     out << indent + (isConst ? keyword + " CONSTANT" : keyword);
-    for (const QDomElement& v : vars) {
-        QString name = v.attribute("name");
-        QString type = itype(fc(v, "type"));
-        // 初始值
-        QString init;
-        QDomElement iv = fc(v, "initialValue");
-        if (!iv.isNull()) {
-            QDomElement sv = fc(iv, "simpleValue");
-            if (!sv.isNull()) init = " := " + sv.attribute("value");
-        }
-        out << indent + QString("  %1 : %2%3;").arg(name, type, init);
-    }
+    for (const VarDecl& v : block.vars)
+        out << indent + QString("  %1 : %2%3;").arg(v.name, v.type, v.init);
     out << indent + "END_VAR";
 }
 
@@ -113,168 +181,256 @@ struct Elem {
     QMap<QString, QString> outSig;
 };
 
+// <connectionPointIn> 内第一个 <connection>；没有连接返回 false
+static bool readConnIn(Reader& r, int* refId, QString* refPort)
+{
+    bool found = false;
+    while (r.readNextStartElement()) {
+        if (!found && r.name() == u"connection") {
+            *refId  = attrInt(r, "refLocalId");
+            *refPort = attr(r, "formalParameter");
+            found   = true;
+        }
+        r.skipCurrentElement();
+    }
+    return found;
+}
+
+// <block> 的 <inputVariables>
+static void readBlockInputs(Reader& r, Elem& el)
+{
+    while (r.readNextStartElement()) {
+        if (r.name() != u"variable") { r.skipCurrentElement(); continue; }
+        Conn c;
+        c.param = attr(r, "formalParameter");
+        bool cpiSeen = false;
+        while (r.readNextStartElement()) {
+            if (!cpiSeen && r.name() == u"connectionPointIn") {
+                cpiSeen = true;
+                int id; QString port;
+                if (readConnIn(r, &id, &port)) { c.refId = id; c.refPort = port; }
+            } else {
+                r.skipCurrentElement();
+            }
+        }
+        el.inputs << c;
+    }
+}
+
 // ───────────────────────────────────────────────────────────────────────────
 // 解析 FBD/LD 体内的所有图元
 // ───────────────────────────────────────────────────────────────────────────
-static QMap<int, Elem> parseFbd(const QDomElement& bodyEl)
+static QMap<int, Elem> parseFbd(Reader& r)
 {
     QMap<int, Elem> map;
-    for (QDomElement e = bodyEl.firstChildElement();
-         !e.isNull(); e = e.nextSiblingElement())
-    {
-        const QString tag = e.localName();
+    while (r.readNextStartElement()) {
+        const QString tag = r.name().toString();
         Elem el;
-        el.localId   = e.attribute("localId").toInt();
-        el.execOrder = e.attribute("executionOrderId", "0").toInt();
-
-        if (tag == "inVariable") {
-            el.kind       = Elem::InVar;
-            el.expression = fc(e, "expression").text().trimmed();
-            el.negated    = (e.attribute("negated") == "true");
-        }
-        else if (tag == "outVariable") {
-            el.kind       = Elem::OutVar;
-            el.expression = fc(e, "expression").text().trimmed();
-            QDomElement con = fc(fc(e, "connectionPointIn"), "connection");
-            if (!con.isNull())
-                el.inputs << Conn{con.attribute("refLocalId").toInt(),
-                                  con.attribute("formalParameter"), {}};
-        }
-        else if (tag == "inOutVariable") {
-            el.kind       = Elem::InOutVar;
-            el.expression = fc(e, "expression").text().trimmed();
-            QDomElement con = fc(fc(e, "connectionPointIn"), "connection");
-            if (!con.isNull())
-                el.inputs << Conn{con.attribute("refLocalId").toInt(),
-                                  con.attribute("formalParameter"), {}};
-        }
-        else if (tag == "block") {
-            el.kind         = Elem::Block;
-            el.typeName     = e.attribute("typeName");
-            el.instanceName = e.attribute("instanceName");
-
-            QDomElement inVars = fc(e, "inputVariables");
-            for (const QDomElement& v : ch(inVars, "variable")) {
-                Conn c;
-                c.param = v.attribute("formalParameter");
-                QDomElement con = fc(fc(v, "connectionPointIn"), "connection");
-                if (!con.isNull()) {
-                    c.refId   = con.attribute("refLocalId").toInt();
-                    c.refPort = con.attribute("formalParameter");
-                }
-                el.inputs << c;
-            }
-            QDomElement outVars = fc(e, "outputVariables");
-            for (const QDomElement& v : ch(outVars, "variable"))
-                el.outputPorts << v.attribute("formalParameter");
+        el.localId   = attrInt(r, "localId");
+        el.execOrder = attr(r, "executionOrderId", "0").toInt();
+
+        if      (tag == "inVariable")    el.kind = Elem::InVar;
+        else if (tag == "outVariable")   el.kind = Elem::OutVar;
+        else if (tag == "inOutVariable") el.kind = Elem::InOutVar;
+        else if (tag == "block")         el.kind = Elem::Block;
+        else if (tag == "contact")       el.kind = Elem::Contact;
+        else if (tag == "coil")          el.kind = Elem::Coil;
+        else if (tag == "leftPowerRail") el.kind = Elem::PowerRail;
+
+        if (el.kind == Elem::Skip || el.kind == Elem::PowerRail) {
+            r.skipCurrentElement();
+            if (el.kind != Elem::Skip) map[el.localId] = el;
+            continue;
         }
-        else if (tag == "contact") {
-            el.kind       = Elem::Contact;
-            el.expression = fc(e, "variable").text().trimmed();
-            el.negated    = (e.attribute("negated") == "true");
-            QDomElement con = fc(fc(e, "connectionPointIn"), "connection");
-            if (!con.isNull())
-                el.inputs << Conn{con.attribute("refLocalId").toInt(), {}, {}};
-        }
-        else if (tag == "coil") {
-            el.kind       = Elem::Coil;
-            el.expression = fc(e, "variable").text().trimmed();
-            el.negated    = (e.attribute("negated") == "true");
-            QDomElement con = fc(fc(e, "connectionPointIn"), "connection");
-            if (!con.isNull())
-                el.inputs << Conn{con.attribute("refLocalId").toInt(), {}, {}};
-        }
-        else if (tag == "leftPowerRail") {
-            el.kind = Elem::PowerRail;
+
+        const bool coilLike = el.kind == Elem::Contact || el.kind == Elem::Coil;
+        if (el.kind == Elem::InVar || coilLike)
+            el.negated = attr(r, "negated") == "true";
+        if (el.kind == Elem::Block) {
+            el.typeName     = attr(r, "typeName");
+            el.instanceName = attr(r, "instanceName");
         }
-        else {
-            el.kind = Elem::Skip;
+
+        // 变量名：触点/线圈在 <variable>，其余在 <expression>；各子元素只取第一个
+        const QLatin1String exprTag(coilLike ? "variable" : "expression");
+        bool exprSeen = false, cpiSeen = false, inSeen = false, outSeen = false;
+        while (r.readNextStartElement()) {
+            const auto name = r.name();
+            if (el.kind == Elem::Block) {
+                if (!inSeen && name == u"inputVariables") {
+                    inSeen = true;
+                    readBlockInputs(r, el);
+                } else if (!outSeen && name == u"outputVariables") {
+                    outSeen = true;
+                    while (r.readNextStartElement()) {
+                        if (r.name() == u"variable") el.outputPorts << attr(r, "formalParameter");
+                        r.skipCurrentElement();
+                    }
+                } else {
+                    r.skipCurrentElement();
+                }
+            } else if (!exprSeen && name == exprTag) {
+                el.expression = text(r).trimmed();
+                exprSeen = true;
+            } else if (!cpiSeen && name == u"connectionPointIn" && el.kind != Elem::InVar) {
+                cpiSeen = true;
+                int id; QString port;
+                if (readConnIn(r, &id, &port)) {
+                    // 触点/线圈只有一个左侧输入，不按来源端口名查找信号
+                    if (coilLike) port.clear();
+                    el.inputs << Conn{id, port, {}};
+                }
+            } else {
+                r.skipCurrentElement();
+            }
         }
 
-        if (el.kind != Elem::Skip)
-            map[el.localId] = el;
+        map[el.localId] = el;
     }
     return map;
 }
 
 // ───────────────────────────────────────────────────────────────────────────
-// 拓扑排序（两阶段 Kahn 算法）
+// 拓扑排序
+//
+// 图元按 localId 升序编号为 0..n-1，依赖边（来源 → 目标）存为 CSR 邻接表；
+// InVar / PowerRail 只提供信号，不参与排序约束。
 //
-// 阶段1：先做完整依赖图的 Kahn 排序，找出哪些节点在环路中
+// 阶段1：Tarjan 求强连通分量，节点数 > 1 或带自环的分量即环路
 // 阶段2：对环路中的 InOutVar→Block 连接打断（视为旧值反馈）
 //         对非环路的 InOutVar 连接保留依赖（使用赋值后的新值）
+//         然后 Kahn 排序，就绪节点放最小堆，总是先取 localId 最小者；
+//         未被打断的环路剩余节点按 localId 追加在末尾
+//
+// 全程 O((V+E) log V)，数万图元的机器生成程序体也不会成为瓶颈。
 // ───────────────────────────────────────────────────────────────────────────
-static QList<int> topoSort(const QMap<int, Elem>& elems)
+
+// 迭代式 Tarjan（避免深链递归爆栈），返回每个节点是否处于环路中
+static std::vector<char> cyclicNodes(const std::vector<int>& off,
+                                     const std::vector<int>& adj)
 {
-    // ── 阶段1：完整图，找环路节点 ────────────────────────────────
-    QMap<int, QSet<int>> fSuccs;
-    QMap<int, int>       fIndeg;
-    for (int id : elems.keys()) fIndeg[id] = 0;
+    const int n = int(off.size()) - 1;
+    std::vector<int>  index(n, -1), low(n, 0), next(n, 0);
+    std::vector<int>  sccStack, callStack;
+    std::vector<char> onStack(n, 0), cyclic(n, 0);
+    int counter = 0;
+
+    auto visit = [&](int v) {
+        index[v] = low[v] = counter++;
+        next[v]  = off[v];
+        sccStack.push_back(v);
+        onStack[v] = 1;
+        callStack.push_back(v);
+    };
 
-    for (const auto& [id, el] : elems.asKeyValueRange()) {
-        if (el.kind == Elem::InVar || el.kind == Elem::PowerRail) continue;
-        for (const Conn& c : el.inputs) {
-            if (c.refId < 0 || !elems.contains(c.refId)) continue;
-            Elem::Kind sk = elems[c.refId].kind;
-            if (sk == Elem::InVar || sk == Elem::PowerRail) continue;
-            fSuccs[c.refId].insert(id);
-            fIndeg[id]++;
-        }
-    }
-    {
-        QList<int> q;
-        for (auto it = fIndeg.cbegin(); it != fIndeg.cend(); ++it)
-            if (it.value() == 0) q << it.key();
-        while (!q.isEmpty()) {
-            int cur = q.takeFirst();
-            for (int s : fSuccs[cur])
-                if (--fIndeg[s] == 0) q << s;
+    for (int root = 0; root < n; ++root) {
+        if (index[root] >= 0) continue;
+        visit(root);
+        while (!callStack.empty()) {
+            const int v = callStack.back();
+            if (next[v] < off[v + 1]) {
+                const int w = adj[next[v]++];
+                if (w == v)
+                    cyclic[v] = 1;                      // 自环
+                else if (index[w] < 0)
+                    visit(w);
+                else if (onStack[w])
+                    low[v] = std::min(low[v], index[w]);
+                continue;
+            }
+            callStack.pop_back();
+            if (!callStack.empty())
+                low[callStack.back()] = std::min(low[callStack.back()], low[v]);
+            if (low[v] != index[v]) continue;
+
+            // v 为分量根：弹出整个分量
+            size_t first = sccStack.size();
+            while (sccStack[--first] != v) {}
+            const bool loop = sccStack.size() - first > 1;
+            for (size_t i = first; i < sccStack.size(); ++i) {
+                onStack[sccStack[i]] = 0;
+                if (loop) cyclic[sccStack[i]] = 1;
+            }
+            sccStack.resize(first);
         }
     }
-    // fIndeg[id] > 0 的节点处于环路中
-    QSet<int> inCycle;
-    for (auto it = fIndeg.cbegin(); it != fIndeg.cend(); ++it)
-        if (it.value() > 0) inCycle.insert(it.key());
+    return cyclic;
+}
 
-    // ── 阶段2：约简图（打断反馈边）+ Kahn 排序 ────────────────────
-    QMap<int, QSet<int>> succs;
-    QMap<int, int>       indeg;
-    for (int id : elems.keys()) indeg[id] = 0;
+static QList<int> topoSort(const QMap<int, Elem>& elems)
+{
+    const int n = int(elems.size());
+
+    // ── 编号与依赖边 ──────────────────────────────────────────────
+    std::vector<int>        ids;     // 编号 → localId（升序）
+    std::vector<Elem::Kind> kinds;
+    QHash<int, int>         indexOf; // localId → 编号
+    ids.reserve(n);
+    kinds.reserve(n);
+    indexOf.reserve(n);
+    for (const auto& [id, el] : elems.asKeyValueRange()) {
+        indexOf.insert(id, int(ids.size()));
+        ids.push_back(id);
+        kinds.push_back(el.kind);
+    }
 
+    std::vector<std::pair<int, int>> edges;   // (来源, 目标) 编号
     for (const auto& [id, el] : elems.asKeyValueRange()) {
         if (el.kind == Elem::InVar || el.kind == Elem::PowerRail) continue;
+        const int dst = indexOf.value(id);
         for (const Conn& c : el.inputs) {
-            if (c.refId < 0 || !elems.contains(c.refId)) continue;
-            Elem::Kind sk = elems[c.refId].kind;
+            if (c.refId < 0) continue;
+            const auto src = indexOf.constFind(c.refId);
+            if (src == indexOf.cend()) continue;
+            const Elem::Kind sk = kinds[*src];
             if (sk == Elem::InVar || sk == Elem::PowerRail) continue;
-            // 打断反馈边：来源是环路中的 InOutVar，且目标不是 OutVar
-            if (sk == Elem::InOutVar && inCycle.contains(c.refId)
-                && el.kind != Elem::OutVar)
-                continue;
-            succs[c.refId].insert(id);
-            indeg[id]++;
+            edges.emplace_back(*src, dst);
         }
     }
 
-    QList<int> queue, result;
-    for (auto it = indeg.cbegin(); it != indeg.cend(); ++it)
-        if (it.value() == 0) queue << it.key();
-    std::sort(queue.begin(), queue.end());
+    // CSR：off[v]..off[v+1] 为 v 的后继
+    std::vector<int> off(n + 1, 0), adj(edges.size());
+    for (const auto& e : edges) ++off[e.first + 1];
+    for (int v = 0; v < n; ++v) off[v + 1] += off[v];
+    {
+        std::vector<int> pos(off.begin(), off.end() - 1);
+        for (const auto& e : edges) adj[pos[e.first]++] = e.second;
+    }
+
+    // ── 阶段1：环路节点 ──────────────────────────────────────────
+    const std::vector<char> inCycle = cyclicNodes(off, adj);
 
-    while (!queue.isEmpty()) {
-        int cur = queue.takeFirst();
-        result << cur;
-        QList<int> ss(succs[cur].begin(), succs[cur].end());
-        std::sort(ss.begin(), ss.end());
-        for (int s : ss) {
-            if (--indeg[s] == 0) {
-                queue << s;
-                std::sort(queue.begin(), queue.end());
-            }
-        }
+    // 打断反馈边：来源是环路中的 InOutVar，且目标不是 OutVar
+    auto feedback = [&](int src, int dst) {
+        return kinds[src] == Elem::InOutVar && inCycle[src]
+            && kinds[dst] != Elem::OutVar;
+    };
+
+    // ── 阶段2：约简图 Kahn 排序 ──────────────────────────────────
+    std::vector<int> indeg(n, 0);
+    for (int v = 0; v < n; ++v)
+        for (int i = off[v]; i < off[v + 1]; ++i)
+            if (!feedback(v, adj[i])) ++indeg[adj[i]];
+
+    // 编号与 localId 同序，最小堆即按 localId 取就绪节点
+    std::priority_queue<int, std::vector<int>, std::greater<int>> ready;
+    for (int v = 0; v < n; ++v)
+        if (indeg[v] == 0) ready.push(v);
+
+    QList<int>        result;
+    std::vector<char> placed(n, 0);
+    result.reserve(n);
+    while (!ready.empty()) {
+        const int v = ready.top();
+        ready.pop();
+        result << ids[v];
+        placed[v] = 1;
+        for (int i = off[v]; i < off[v + 1]; ++i)
+            if (!feedback(v, adj[i]) && --indeg[adj[i]] == 0)
+                ready.push(adj[i]);
     }
-    for (int id : elems.keys())
-        if (!result.contains(id)) result << id;
+    for (int v = 0; v < n; ++v)
+        if (!placed[v]) result << ids[v];
     return result;
 }
 
@@ -419,10 +575,77 @@ static QStringList fbdToSt(QMap<int, Elem>& elems)
 
     return lines;
 }
+// ───────────────────────────────────────────────────────────────────────────
+// SFC 图元（按文档顺序保存，生成时再建连接图）
+// ───────────────────────────────────────────────────────────────────────────
+struct SfcNode {
+    QString        tag;         // step / transition / actionBlock / jumpStep / selectionDivergence …
+    int            localId = 0;
+    QString        name;        // step
+    bool           initial = false;
+    QString        targetName;  // jumpStep
+    QString        condition;   // transition：内联 ST 条件
+    QList<QString> actions;     // actionBlock：内联 ST 列表
+    QList<int>     ins;         // 每个 <connectionPointIn> 的首个连接来源
+};
+
+static QList<SfcNode> parseSfc(Reader& r)
+{
+    QList<SfcNode> nodes;
+    while (r.readNextStartElement()) {
+        SfcNode n;
+        n.tag        = r.name().toString();
+        n.localId    = attrInt(r, "localId");
+        n.name       = attr(r, "name");
+        n.initial    = attr(r, "initialStep") == "true";
+        n.targetName = attr(r, "targetName");
+
+        bool condSeen = false;
+        while (r.readNextStartElement()) {
+            const auto name = r.name();
+            if (name == u"connectionPointIn") {
+                int id; QString port;
+                if (readConnIn(r, &id, &port)) n.ins << id;
+            } else if (!condSeen && name == u"condition" && n.tag == "transition") {
+                // <condition><inline><ST><xhtml:p>
+                condSeen = true;
+                bool inlSeen = false;
+                while (r.readNextStartElement()) {
+                    if (inlSeen || r.name() != u"inline") { r.skipCurrentElement(); continue; }
+                    inlSeen = true;
+                    bool stSeen = false;
+                    while (r.readNextStartElement()) {
+                        if (!stSeen && r.name() == u"ST") { n.condition = readCdata(r).trimmed(); stSeen = true; }
+                        else r.skipCurrentElement();
+                    }
+                }
+            } else if (name == u"action" && n.tag == "actionBlock") {
+                // <action><inline><ST><xhtml:p>
+                QString code;
+                bool    inlSeen = false;
+                while (r.readNextStartElement()) {
+                    if (inlSeen || r.name() != u"inline") { r.skipCurrentElement(); continue; }
+                    inlSeen = true;
+                    bool stSeen = false;
+                    while (r.readNextStartElement()) {
+                        if (!stSeen && r.name() == u"ST") { code = readCdata(r).trimmed(); stSeen = true; }
+                        else r.skipCurrentElement();
+                    }
+                }
+                if (!code.isEmpty()) n.actions << code;
+            } else {
+                r.skipCurrentElement();
+            }
+        }
+        nodes << n;
+    }
+    return nodes;
+}
+
 // ───────────────────────────────────────────────────────────────────────────
 // SFC → matiec 原生 SFC 文本
 // ───────────────────────────────────────────────────────────────────────────
-static QStringList sfcToText(const QDomElement& sfcEl)
+static QStringList sfcToText(const QList<SfcNode>& nodes)
 {
     QStringList out;
 
@@ -433,57 +656,41 @@ static QStringList sfcToText(const QDomElement& sfcEl)
     QMap<int, StepInfo>      steps;
     QMap<int, QString>       transCond;  // localId → ST 条件
     QMap<int, QList<QString>> stepActs;  // stepLocalId → 内联 ST 列表
+    QHash<int, int>          firstById;  // localId → nodes 下标（首次出现）
 
-    // 解析所有节点
-    for (QDomElement e = sfcEl.firstChildElement();
-         !e.isNull(); e = e.nextSiblingElement())
-    {
-        QString tag = e.localName();
-        int id = e.attribute("localId").toInt();
-
-        if (tag == "step") {
-            steps[id] = { e.attribute("name"),
-                          e.attribute("initialStep") == "true" };
-        }
-        else if (tag == "transition") {
-            QDomElement cond = fc(e, "condition");
-            QDomElement inl  = fc(cond, "inline");
-            QDomElement stEl = fc(inl, "ST");
-            transCond[id] = cdata(stEl).trimmed();
-        }
-        else if (tag == "actionBlock") {
-            QDomElement cpi = fc(e, "connectionPointIn");
-            QDomElement con = fc(cpi, "connection");
-            int stepId = con.isNull() ? -1 : con.attribute("refLocalId").toInt();
-            QList<QString> acts;
-            for (const QDomElement& act : ch(e, "action")) {
-                QDomElement inl  = fc(act, "inline");
-                QDomElement stEl = fc(inl, "ST");
-                QString code = cdata(stEl).trimmed();
-                if (!code.isEmpty()) acts << code;
-            }
-            if (stepId >= 0) stepActs[stepId] = acts;
+    for (int i = 0; i < nodes.size(); ++i) {
+        const SfcNode& n = nodes[i];
+        if (!firstById.contains(n.localId)) firstById.insert(n.localId, i);
+
+        if (n.tag == "step") {
+            steps[n.localId] = { n.name, n.initial };
+        }
+        else if (n.tag == "transition") {
+            transCond[n.localId] = n.condition;
+        }
+        else if (n.tag == "actionBlock") {
+            const int stepId = n.ins.isEmpty() ? -1 : n.ins.first();
+            if (stepId >= 0) stepActs[stepId] = n.actions;
         }
     }
 
-    // 建立连接图：nodeId → 出口节点列表
+    // 建立连接图：nodeId → 出口节点列表（connectionPointIn 指向该节点的上游）
     QMap<int, QList<int>> nodeOut;
-    for (QDomElement e = sfcEl.firstChildElement();
-         !e.isNull(); e = e.nextSiblingElement())
-    {
-        int id = e.attribute("localId").toInt();
-        // connectionPointIn 指向该节点的上游
-        for (const QDomElement& cpi : ch(e, "connectionPointIn")) {
-            QDomElement con = fc(cpi, "connection");
-            if (!con.isNull())
-                nodeOut[con.attribute("refLocalId").toInt()] << id;
-        }
-    }
+    for (const SfcNode& n : nodes)
+        for (int src : n.ins)
+            nodeOut[src] << n.localId;
 
     // jumpStep 目标名
     QMap<int, QString> jumpTarget;
-    for (const QDomElement& e : ch(sfcEl, "jumpStep"))
-        jumpTarget[e.attribute("localId").toInt()] = e.attribute("targetName");
+    for (const SfcNode& n : nodes)
+        if (n.tag == "jumpStep")
+            jumpTarget[n.localId] = n.targetName;
+
+    // 上游连接来源（按 localId 取首个同 id 节点）
+    auto insOf = [&](int id) -> QList<int> {
+        const auto it = firstById.constFind(id);
+        return it == firstById.cend() ? QList<int>() : nodes[*it].ins;
+    };
 
     // ── 生成步骤定义 ──────────────────────────────────────────
     for (const auto& [id, s] : steps.asKeyValueRange()) {
@@ -507,34 +714,15 @@ static QStringList sfcToText(const QDomElement& sfcEl)
         QStringList fromNames, toNames;
 
         // from: 连接到本转换的上游节点（步骤或分支）
-        for (QDomElement e = sfcEl.firstChildElement();
-             !e.isNull(); e = e.nextSiblingElement())
-        {
-            if (e.attribute("localId").toInt() != tid) continue;
-            for (const QDomElement& cpi : ch(e, "connectionPointIn")) {
-                QDomElement con = fc(cpi, "connection");
-                if (con.isNull()) continue;
-                int srcId = con.attribute("refLocalId").toInt();
-                if (steps.contains(srcId))
-                    fromNames << steps[srcId].name;
-                // selectionDivergence: 查找其上游步骤
-                else {
-                    for (QDomElement e2 = sfcEl.firstChildElement();
-                         !e2.isNull(); e2 = e2.nextSiblingElement())
-                    {
-                        if (e2.attribute("localId").toInt() != srcId) continue;
-                        for (const QDomElement& cpi2 : ch(e2, "connectionPointIn")) {
-                            QDomElement con2 = fc(cpi2, "connection");
-                            if (!con2.isNull()) {
-                                int s2 = con2.attribute("refLocalId").toInt();
-                                if (steps.contains(s2))
-                                    fromNames << steps[s2].name;
-                            }
-                        }
-                    }
-                }
+        for (int srcId : insOf(tid)) {
+            if (steps.contains(srcId))
+                fromNames << steps[srcId].name;
+            // selectionDivergence: 查找其上游步骤
+            else {
+                for (int s2 : insOf(srcId))
+                    if (steps.contains(s2))
+                        fromNames << steps[s2].name;
             }
-            break;
         }
 
         // to: 本转换的出口节点（步骤、jumpStep 或 convergence）
@@ -582,178 +770,335 @@ static QStringList sfcToText(const QDomElement& sfcEl)
     return out;
 }
 
+// ───────────────────────────────────────────────────────────────────────────
+// POU 模型（读完 <pou> 即可独立生成 ST，不再引用 XML）
+// ───────────────────────────────────────────────────────────────────────────
+struct PouDef {
+    enum Body { None, Text, Graph, Sfc };
+
+    QString  name;
+    QString  pouType;
+    QString  returnType = "VOID";     // 仅 function
+    VarBlock inputVars, outputVars, inOutVars, localVars, externalVars;
+
+    Body            body = None;
+    QString         text;             // ST / IL
+    QMap<int, Elem> elems;            // FBD / LD
+    QList<SfcNode>  sfc;              // SFC
+};
+
+// <interface>：各类变量块只取第一个
+static void readInterface(Reader& r, PouDef& p)
+{
+    bool retSeen = false;
+    while (r.readNextStartElement()) {
+        const auto name = r.name();
+        VarBlock* b = nullptr;
+        if      (name == u"inputVars")    b = &p.inputVars;
+        else if (name == u"outputVars")   b = &p.outputVars;
+        else if (name == u"inOutVars")    b = &p.inOutVars;
+        else if (name == u"localVars")    b = &p.localVars;
+        else if (name == u"externalVars") b = &p.externalVars;
+
+        if (b && !b->present) {
+            *b = readVarBlock(r);
+        } else if (!b && !retSeen && name == u"returnType") {
+            p.returnType = readType(r);
+            retSeen = true;
+        } else {
+            r.skipCurrentElement();
+        }
+    }
+}
+
+// <body>：取第一个语言元素
+static void readBody(Reader& r, PouDef& p)
+{
+    while (r.readNextStartElement()) {
+        const auto name = r.name();
+        if (p.body != PouDef::None) {
+            r.skipCurrentElement();
+        } else if (name == u"ST" || name == u"IL") {
+            p.body = PouDef::Text;
+            p.text = readCdata(r);
+        } else if (name == u"FBD" || name == u"LD") {
+            p.body  = PouDef::Graph;
+            p.elems = parseFbd(r);
+        } else if (name == u"SFC") {
+            p.body = PouDef::Sfc;
+            p.sfc  = parseSfc(r);
+        } else {
+            r.skipCurrentElement();
+        }
+    }
+}
+
+static PouDef readPou(Reader& r)
+{
+    PouDef p;
+    p.name    = attr(r, "name");
+    p.pouType = attr(r, "pouType");
+    bool ifaceSeen = false, bodySeen = false;
+    while (r.readNextStartElement()) {
+        if (!ifaceSeen && r.name() == u"interface") { readInterface(r, p); ifaceSeen = true; }
+        else if (!bodySeen && r.name() == u"body")  { readBody(r, p);      bodySeen  = true; }
+        else r.skipCurrentElement();    // <actions> / <transitions> / <documentation> …
+    }
+    return p;
+}
+
 // ───────────────────────────────────────────────────────────────────────────
 // 生成单个 POU 的 ST 文本
 // ───────────────────────────────────────────────────────────────────────────
-static QStringList convertPou(const QDomElement& pouEl)
+static QStringList convertPou(PouDef& pou)
 {
     QStringList out;
-    const QString name    = pouEl.attribute("name");
-    const QString pouType = pouEl.attribute("pouType");
-
-    QDomElement iface = fc(pouEl, "interface");
 
     // ── 头部关键字 ────────────────────────────────────────
     QString keyword, endKeyword;
-    if (pouType == "function") {
-        QDomElement ret = fc(iface, "returnType");
-        QString retType = ret.isNull() ? "VOID" : itype(ret);
-        keyword    = QString("FUNCTION %1 : %2").arg(name, retType);
+    if (pou.pouType == "function") {
+        keyword    = QString("FUNCTION %1 : %2").arg(pou.name, pou.returnType);
         endKeyword = "END_FUNCTION";
-    } else if (pouType == "functionBlock") {
-        keyword    = QString("FUNCTION_BLOCK %1").arg(name);
+    } else if (pou.pouType == "functionBlock") {
+        keyword    = QString("FUNCTION_BLOCK %1").arg(pou.name);
         endKeyword = "END_FUNCTION_BLOCK";
     } else {
-        keyword    = QString("PROGRAM %1").arg(name);
+        keyword    = QString("PROGRAM %1").arg(pou.name);
         endKeyword = "END_PROGRAM";
     }
 
     out << keyword;
 
     // ── 变量声明 ──────────────────────────────────────────
-    emitVarBlock(fc(iface, "inputVars"),
-                 "VAR_INPUT", false, out);
-    emitVarBlock(fc(iface, "outputVars"),
-                 "VAR_OUTPUT", false, out);
-    emitVarBlock(fc(iface, "inOutVars"),
-                 "VAR_IN_OUT", false, out);
-    emitVarBlock(fc(iface, "localVars"),
-                 "VAR", false, out);
-    {
-        QDomElement ev = fc(iface, "externalVars");
-        bool isConst = ev.attribute("constant") == "true";
-        emitVarBlock(ev, "VAR_EXTERNAL", isConst, out);
-    }
+    emitVarBlock(pou.inputVars,  "VAR_INPUT",  false, out);
+    emitVarBlock(pou.outputVars, "VAR_OUTPUT", false, out);
+    emitVarBlock(pou.inOutVars,  "VAR_IN_OUT", false, out);
+    emitVarBlock(pou.localVars,  "VAR",        false, out);
+    emitVarBlock(pou.externalVars, "VAR_EXTERNAL", pou.externalVars.constant, out);
 
     // ── 程序体 ────────────────────────────────────────────
-    QDomElement body = fc(pouEl, "body");
-
-    // ST
-    QDomElement stEl = fc(body, "ST");
-    if (!stEl.isNull()) {
-        QString code = cdata(stEl);
-        for (const QString& ln : code.split('\n'))
-            out << "  " + ln;
-        out << endKeyword;
-        out << "";
-        return out;
-    }
-
-    // IL
-    QDomElement ilEl = fc(body, "IL");
-    if (!ilEl.isNull()) {
-        QString code = cdata(ilEl);
-        for (const QString& ln : code.split('\n'))
+    switch (pou.body) {
+    case PouDef::Text:          // ST / IL 直接透传
+        for (const QString& ln : pou.text.split('\n'))
             out << "  " + ln;
-        out << endKeyword;
-        out << "";
-        return out;
-    }
-
-    // SFC
-    QDomElement sfcEl = fc(body, "SFC");
-    if (!sfcEl.isNull()) {
-        for (const QString& ln : sfcToText(sfcEl))
+        break;
+    case PouDef::Sfc:
+        for (const QString& ln : sfcToText(pou.sfc))
             out << "  " + ln;
-        out << endKeyword;
-        out << "";
-        return out;
-    }
-
-    // FBD / LD（统一处理）
-    QDomElement fbdEl = fc(body, "FBD");
-    if (fbdEl.isNull()) fbdEl = fc(body, "LD");
-    if (!fbdEl.isNull()) {
-        auto elems = parseFbd(fbdEl);
-        for (const QString& ln : fbdToSt(elems))
+        break;
+    case PouDef::Graph:         // FBD / LD（统一处理）
+        for (const QString& ln : fbdToSt(pou.elems))
             out << ln;
-        out << endKeyword;
-        out << "";
-        return out;
+        break;
+    default:
+        out << "  (* Unsupported body language *)";
+        break;
     }
-
-    out << "  (* Unsupported body language *)";
     out << endKeyword;
     out << "";
     return out;
 }
 
 // ───────────────────────────────────────────────────────────────────────────
-// 主转换函数
+// CONFIGURATION / RESOURCE / TASK
 // ───────────────────────────────────────────────────────────────────────────
-static QString doConvert(const QString& xmlContent)
+struct PouInstance {
+    QString name;
+    QString typeName;
+};
+
+struct TaskDef {
+    QString            name;
+    QString            interval;
+    QString            priority;
+    QList<PouInstance> programs;
+};
+
+struct ResourceDef {
+    QString            name;
+    QList<VarBlock>    globals;
+    QList<TaskDef>     tasks;
+    QList<PouInstance> programs;      // 直接挂在 resource 下（无 task）
+};
+
+struct ConfigDef {
+    QString            name;
+    QList<VarBlock>    globals;
+    QList<ResourceDef> resources;
+};
+
+static void readPouInstance(Reader& r, QList<PouInstance>& list)
 {
-    QDomDocument doc;
-    QString errMsg; int errLine = 0, errCol = 0;
-    if (!doc.setContent(xmlContent, true, &errMsg, &errLine, &errCol)) {
-        g_lastError = QString("XML parse error at line %1, col %2: %3")
-                      .arg(errLine).arg(errCol).arg(errMsg);
-        return {};
+    list << PouInstance{attr(r, "name"), attr(r, "typeName")};
+    r.skipCurrentElement();
+}
+
+static ResourceDef readResource(Reader& r)
+{
+    ResourceDef res;
+    res.name = attr(r, "name", "resource1");
+    while (r.readNextStartElement()) {
+        if (r.name() == u"globalVars") {
+            res.globals << readVarBlock(r);
+        } else if (r.name() == u"task") {
+            TaskDef t;
+            t.name     = attr(r, "name");
+            t.interval = attr(r, "interval", "T#10ms");
+            t.priority = attr(r, "priority", "0");
+            while (r.readNextStartElement()) {
+                if (r.name() == u"pouInstance") readPouInstance(r, t.programs);
+                else r.skipCurrentElement();
+            }
+            res.tasks << t;
+        } else if (r.name() == u"pouInstance") {
+            readPouInstance(r, res.programs);
+        } else {
+            r.skipCurrentElement();
+        }
     }
+    return res;
+}
+
+static QList<ConfigDef> readConfigurations(Reader& r)
+{
+    QList<ConfigDef> configs;
+    while (r.readNextStartElement()) {
+        if (r.name() != u"configuration") { r.skipCurrentElement(); continue; }
+        ConfigDef cfg;
+        cfg.name = attr(r, "name", "config");
+        while (r.readNextStartElement()) {
+            if (r.name() == u"globalVars")    cfg.globals   << readVarBlock(r);
+            else if (r.name() == u"resource") cfg.resources << readResource(r);
+            else r.skipCurrentElement();
+        }
+        configs << cfg;
+    }
+    return configs;
+}
 
-    QDomElement root = doc.documentElement();
-    if (root.localName() != "project") {
-        g_lastError = "Root element is not <project>";
+// ───────────────────────────────────────────────────────────────────────────
+// 主转换函数
+// ───────────────────────────────────────────────────────────────────────────
+static QString doConvert(Reader& r)
+{
+    g_lastTasks.clear();
+
+    // ── 单遍读取：<project><types><pous> 与 <instances><configurations> ─────
+    QList<PouDef>    pous;
+    QList<ConfigDef> configs;
+    if (r.readNextStartElement()) {
+        if (r.name() != u"project") {
+            g_lastError = "Root element is not <project>";
+            return {};
+        }
+        bool typesSeen = false, instSeen = false;
+        while (r.readNextStartElement()) {
+            if (!typesSeen && r.name() == u"types") {
+                typesSeen = true;
+                bool pousSeen = false;
+                while (r.readNextStartElement()) {
+                    if (pousSeen || r.name() != u"pous") { r.skipCurrentElement(); continue; }
+                    pousSeen = true;
+                    while (r.readNextStartElement()) {
+                        if (r.name() == u"pou") pous << readPou(r);
+                        else r.skipCurrentElement();
+                    }
+                }
+            } else if (!instSeen && r.name() == u"instances") {
+                instSeen = true;
+                bool cfgSeen = false;
+                while (r.readNextStartElement()) {
+                    if (!cfgSeen && r.name() == u"configurations") {
+                        configs = readConfigurations(r);
+                        cfgSeen = true;
+                    } else {
+                        r.skipCurrentElement();
+                    }
+                }
+            } else {
+                r.skipCurrentElement();
+            }
+        }
+    }
+    while (!r.atEnd() && !r.hasError())
+        r.readNext();               // 根元素之后只允许注释 / 空白
+    if (r.hasError()) {
+        g_lastError = QString("XML parse error at line %1, col %2: %3")
+                      .arg(r.lineNumber()).arg(r.columnNumber()).arg(r.errorString());
         return {};
     }
 
+    QList<StGenerator::Task> tasks;
     QStringList out;
     out << "(* Generated by TiZi StGenerator - IEC 61131-3 Structured Text *)";
     out << "";
 
-    QDomElement insts   = fc(root, "instances");
-    QDomElement configs = fc(insts, "configurations");
-
     // ── POU 定义（必须在 CONFIGURATION 块之前）────────────────────────────
-    QDomElement types = fc(root, "types");
-    QDomElement pous  = fc(types, "pous");
-    for (const QDomElement& pou : ch(pous, "pou")) {
-        out << QString("(* %1 : %2 *)")
-               .arg(pou.attribute("name"), pou.attribute("pouType"));
-        for (const QString& ln : convertPou(pou))
-            out << ln;
+    // 各 POU 只依赖自己的 PouDef，分发到全局线程池并行生成，
+    // 结果按声明顺序拼接（输出与串行完全一致）
+    struct PouJob {
+        PouDef*     pou;
+        QStringList lines;
+    };
+    std::vector<PouJob> jobs;
+    jobs.reserve(pous.size());
+    for (PouDef& pou : pous)
+        jobs.push_back({&pou, {}});
+    auto runJob = [](PouJob& job) { job.lines = convertPou(*job.pou); };
+    if (jobs.size() > 1)
+        QtConcurrent::blockingMap(jobs, runJob);
+    else
+        std::for_each(jobs.begin(), jobs.end(), runJob);
+
+    for (const PouJob& job : jobs) {
+        out << QString("(* %1 : %2 *)").arg(job.pou->name, job.pou->pouType);
+        out << job.lines;
     }
 
     // ── CONFIGURATION 块 ──────────────────────────────────────────────────
     // VAR_GLOBAL 必须在 CONFIGURATION 内，不能出现在顶层
-    for (const QDomElement& cfg : ch(configs, "configuration")) {
-        out << QString("CONFIGURATION %1").arg(cfg.attribute("name", "config"));
+    for (const ConfigDef& cfg : configs) {
+        out << QString("CONFIGURATION %1").arg(cfg.name);
 
         // 配置层全局变量
-        for (const QDomElement& gv : ch(cfg, "globalVars")) {
-            bool isConst = gv.attribute("constant") == "true";
-            emitVarBlock(gv, "VAR_GLOBAL", isConst, out, "  ");
-        }
+        for (const VarBlock& gv : cfg.globals)
+            emitVarBlock(gv, "VAR_GLOBAL", gv.constant, out, "  ");
 
         // RESOURCE 块
-        for (const QDomElement& res : ch(cfg, "resource")) {
-            out << QString("  RESOURCE %1 ON PLC").arg(res.attribute("name", "resource1"));
+        for (const ResourceDef& res : cfg.resources) {
+            out << QString("  RESOURCE %1 ON PLC").arg(res.name);
 
             // resource 层全局变量
-            for (const QDomElement& gv : ch(res, "globalVars")) {
-                bool isConst = gv.attribute("constant") == "true";
-                emitVarBlock(gv, "VAR_GLOBAL", isConst, out, "    ");
-            }
+            for (const VarBlock& gv : res.globals)
+                emitVarBlock(gv, "VAR_GLOBAL", gv.constant, out, "    ");
 
             // TASK 声明 + 关联的 PROGRAM 实例
-            for (const QDomElement& task : ch(res, "task")) {
-                const QString taskName = task.attribute("name");
-                const QString interval = task.attribute("interval", "T#10ms");
-                const QString priority = task.attribute("priority", "0");
+            for (const TaskDef& task : res.tasks) {
                 out << QString("    TASK %1(INTERVAL := %2, PRIORITY := %3);")
-                       .arg(taskName, interval, priority);
-                for (const QDomElement& pi : ch(task, "pouInstance")) {
+                       .arg(task.name, task.interval, task.priority);
+
+                StGenerator::Task t;
+                t.resource   = res.name;
+                t.name       = task.name;
+                t.intervalMs = std::max(0, StGenerator::parseDurationMs(task.interval));
+                t.priority   = task.priority.toInt();
+                for (const PouInstance& pi : task.programs) {
                     out << QString("    PROGRAM %1 WITH %2 : %3;")
-                           .arg(pi.attribute("name"), taskName,
-                                pi.attribute("typeName"));
+                           .arg(pi.name, task.name, pi.typeName);
+                    t.programs.append({pi.name, pi.typeName});
                 }
+                tasks.append(t);
             }
 
             // 直接挂在 resource 下的 pouInstance（无 task）
-            for (const QDomElement& pi : ch(res, "pouInstance")) {
-                out << QString("    PROGRAM %1 : %2;")
-                       .arg(pi.attribute("name"), pi.attribute("typeName"));
+            StGenerator::Task untasked;
+            untasked.resource = res.name;
+            for (const PouInstance& pi : res.programs) {
+                out << QString("    PROGRAM %1 : %2;").arg(pi.name, pi.typeName);
+                untasked.programs.append({pi.name, pi.typeName});
             }
+            if (!untasked.programs.isEmpty())
+                tasks.append(untasked);
 
             out << "  END_RESOURCE";
         }
@@ -763,16 +1108,11 @@ static QString doConvert(const QString& xmlContent)
     }
 
     // ── 没有 CONFIGURATION 但有 PROGRAM POU：生成最小默认配置 ────────────
-    if (ch(configs, "configuration").isEmpty()) {
-        QDomElement firstProg;
-        for (const QDomElement& pou : ch(pous, "pou")) {
-            if (pou.attribute("pouType") == "program") {
-                firstProg = pou;
-                break;
-            }
-        }
-        if (!firstProg.isNull()) {
-            const QString progName = firstProg.attribute("name");
+    if (configs.isEmpty()) {
+        const auto firstProg = std::find_if(pous.cbegin(), pous.cend(),
+            [](const PouDef& p) { return p.pouType == "program"; });
+        if (firstProg != pous.cend()) {
+            const QString progName = firstProg->name;
             out << "CONFIGURATION config";
             out << "  RESOURCE resource1 ON PLC";
             out << "    TASK main_task(INTERVAL := T#10ms, PRIORITY := 0);";
@@ -780,10 +1120,18 @@ static QString doConvert(const QString& xmlContent)
             out << "  END_RESOURCE";
             out << "END_CONFIGURATION";
             out << "";
+
+            StGenerator::Task t;
+            t.resource   = "resource1";
+            t.name       = "main_task";
+            t.intervalMs = 10;
+            t.programs.append({"main_instance", progName});
+            tasks.append(t);
         }
     }
 
     g_lastError.clear();
+    g_lastTasks = tasks;
     return out.join('\n');
 }
 
@@ -796,19 +1144,60 @@ static QString doConvert(const QString& xmlContent)
 QString StGenerator::fromFile(const QString& filePath)
 {
     QFile f(filePath);
-    if (!f.open(QFile::ReadOnly | QFile::Text)) {
+    if (!f.open(QFile::ReadOnly)) {
         g_lastError = "Cannot open file: " + filePath;
         return {};
     }
-    return fromXml(QString::fromUtf8(f.readAll()));
+    // 直接从文件流式读取，不整体读入内存
+    QXmlStreamReader r(&f);
+    return doConvert(r);
 }
 
 QString StGenerator::fromXml(const QString& xml)
 {
-    return doConvert(xml);
+    QXmlStreamReader r(xml);
+    return doConvert(r);
 }
 
 QString StGenerator::lastError()
 {
     return g_lastError;
 }
+
+QList<StGenerator::Task> StGenerator::lastTasks()
+{
+    return g_lastTasks;
+}
+
+int StGenerator::parseDurationMs(const QString& literal)
+{
+    // T#1d2h3m4s5ms / TIME#1.5s / t#100ms，允许下划线分隔
+    QString v = literal.trimmed().toLower().remove('_');
+    const int hash = v.indexOf('#');
+    if (hash < 0) return -1;
+    const QString prefix = v.left(hash);
+    if (prefix != "t" && prefix != "time") return -1;
+    v = v.mid(hash + 1);
+    if (v.isEmpty()) return -1;
+
+    static const QRegularExpression re(R"((\d+(?:\.\d+)?)(ms|us|ns|d|h|m|s))");
+    double ms  = 0.0;
+    int    pos = 0;
+    auto it = re.globalMatch(v);
+    while (it.hasNext()) {
+        const auto m = it.next();
+        if (m.capturedStart() != pos) return -1;   // 中间有无法识别的字符
+        pos = m.capturedEnd();
+        const double n = m.captured(1).toDouble();
+        const QString u = m.captured(2);
+        if      (u == "d")  ms += n * 86400000.0;
+        else if (u == "h")  ms += n * 3600000.0;
+        else if (u == "m")  ms += n * 60000.0;
+        else if (u == "s")  ms += n * 1000.0;
+        else if (u == "ms") ms += n;
+        else if (u == "us") ms += n / 1000.0;
+        else                ms += n / 1000000.0;
+    }
+    if (pos != v.size() || ms > 2147483647.0) return -1;
+    return static_cast<int>(ms);
+}
@@ -1,4 +1,6 @@
 #pragma once
+#include <QList>
+#include <QPair>
 #include <QString>
 
 // ─────────────────────────────────────────────────────────────
@@ -13,15 +15,34 @@
 //   FBD — 拓扑排序连接图 → ST 函数/功能块调用
 //   LD  — 触点/线圈 + 功能块混合体 → ST（与 FBD 共用代码）
 //   SFC — 步骤/转换/动作 → matiec 原生 SFC 文本
+//
+// 解析为单遍 QXmlStreamReader：边读边建立 POU/元素模型，不构造 DOM，
+// fromFile 直接从文件流式读取，多 MB 工程的峰值内存与模型大小同阶。
+// 读完后各 POU 在全局线程池上并行生成，按声明顺序拼接。
 // ─────────────────────────────────────────────────────────────
 class StGenerator {
 public:
+    /// CONFIGURATION/RESOURCE 中的一个 IEC TASK 及其关联的 PROGRAM 实例
+    struct Task {
+        QString resource;          ///< 所属 RESOURCE 名
+        QString name;              ///< TASK 名；空 = 直接挂在 RESOURCE 下、无 TASK 的实例
+        int     intervalMs = 0;    ///< INTERVAL 毫秒数，0 = 未指定 / 无法解析
+        int     priority   = 0;    ///< PRIORITY，0 = 最高
+        QList<QPair<QString, QString>> programs;  ///< (实例名, PROGRAM 类型名)
+    };
+
     /// 将 PLCopen XML 文件转换为 ST 文本
     static QString fromFile(const QString& xmlFilePath);
 
     /// 将 PLCopen XML 字符串转换为 ST 文本
     static QString fromXml(const QString& xmlContent);
 
-    /// 最后一次调用的错误信息（为空表示成功）
+    /// 当前线程最后一次调用的错误信息（为空表示成功）
     static QString lastError();
+
+    /// 当前线程最后一次转换得到的任务列表（含自动生成的默认 main_task）
+    static QList<Task> lastTasks();
+
+    /// 解析 IEC 时间字面量（T#1s500ms / TIME#10ms / t#2.5s）为毫秒，失败返回 -1
+    static int parseDurationMs(const QString& literal);
 };
@@ -4,6 +4,24 @@ PouModel::PouModel(const QString& name, PouType type, PouLanguage lang)
     : name(name), pouType(type), language(lang)
 {}
 
+const QString& PouModel::graphicalXml() const {
+    if (m_graphicalLoader) {
+        m_graphicalXml = m_graphicalLoader();
+        m_graphicalLoader = nullptr;       // 释放对源文本的引用
+    }
+    return m_graphicalXml;
+}
+
+void PouModel::setGraphicalXml(const QString& xml) {
+    m_graphicalXml    = xml;
+    m_graphicalLoader = nullptr;
+}
+
+void PouModel::setGraphicalLoader(std::function<QString()> loader) {
+    m_graphicalXml.clear();
+    m_graphicalLoader = std::move(loader);
+}
+
 QString PouModel::typeToString(PouType t) {
     switch (t) {
     case PouType::Program:       return "program";
@@ -1,6 +1,7 @@
 #pragma once
 #include <QString>
 #include <QList>
+#include <functional>
 #include "VariableDecl.h"
 
 // POU（程序组织单元）类型
@@ -30,7 +31,16 @@ public:
     QString        description;
     QList<VariableDecl> variables;
     QString        code;          // ST/IL 的文本内容
-    QString        graphicalXml; // LD/FBD/SFC 的 PLCopen XML 图形体（原始 XML 字符串）
+
+    // LD/FBD/SFC 的 PLCopen XML 图形体（"LD\n<LD>...</LD>" 格式）。
+    // PLCopen 工程载入时只登记取出函数，首次 graphicalXml() 才序列化；
+    // 判断有无图形体用 hasGraphical()，不触发取出
+    const QString& graphicalXml() const;
+    void setGraphicalXml(const QString& xml);
+    void setGraphicalLoader(std::function<QString()> loader);
+    bool hasGraphical()     const { return m_graphicalLoader || !m_graphicalXml.isEmpty(); }
+    // 图形体尚未取出：内容与源文件一致
+    bool graphicalPending() const { return bool(m_graphicalLoader); }
 
     // ---- 枚举 ↔ 字符串转换（用于 XML） ----
     static QString    typeToString(PouType t);
@@ -40,4 +50,8 @@ public:
 
     // 返回标签页前缀，如 "LD"、"ST"
     static QString langTabPrefix(PouLanguage l);
+
+private:
+    mutable QString                  m_graphicalXml;
+    mutable std::function<QString()> m_graphicalLoader;
 };
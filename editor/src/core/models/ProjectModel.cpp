@@ -1,9 +1,11 @@
 #include "ProjectModel.h"
 
 #include <QFile>
-#include <QTextStream>
-#include <QDomDocument>
-#include <QDomElement>
+#include <QSaveFile>
+#include <QHash>
+#include <QSet>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 #include <QDateTime>
 
 ProjectModel::ProjectModel(QObject* parent)
@@ -44,7 +46,7 @@ void ProjectModel::clear() {
     linker     = "gcc";
     ldflags.clear();
     m_dirty = false;
-    m_sourcePlcOpen   = QDomDocument();
+    m_sourcePlcOpen.clear();
     m_isPlcOpenSource = false;
 }
 
@@ -82,6 +84,126 @@ bool ProjectModel::pouNameExists(const QString& name) const {
     return findPou(name) != nullptr;
 }
 
+// -------------------------------------------------------
+// 流式 XML 辅助
+// -------------------------------------------------------
+namespace {
+
+using AttrList = QList<QPair<QString, QString>>;
+
+// 把 reader 当前记号原样写出；StartElement 可替换/追加属性。
+// 名字一律按限定名（含前缀）写出，命名空间声明作为普通属性写回，
+// 不依赖 writer 的命名空间管理，输出与原文的前缀完全一致。
+void copyToken(QXmlStreamWriter& w, const QXmlStreamReader& r, const AttrList& overrides = {})
+{
+    switch (r.tokenType()) {
+    case QXmlStreamReader::StartDocument:
+        if (!r.documentVersion().isEmpty())
+            w.writeStartDocument(r.documentVersion().toString());
+        break;
+    case QXmlStreamReader::EndDocument:
+        w.writeEndDocument();
+        break;
+    case QXmlStreamReader::StartElement: {
+        w.writeStartElement(r.qualifiedName().toString());
+        for (const QXmlStreamNamespaceDeclaration& ns : r.namespaceDeclarations())
+            w.writeAttribute(ns.prefix().isEmpty() ? QString("xmlns")
+                                                   : "xmlns:" + ns.prefix().toString(),
+                             ns.namespaceUri().toString());
+        QSet<QString> written;
+        for (const QXmlStreamAttribute& a : r.attributes()) {
+            const QString name = a.qualifiedName().toString();
+            QString value = a.value().toString();
+            for (const auto& o : overrides)
+                if (o.first == name) value = o.second;
+            w.writeAttribute(name, value);
+            written.insert(name);
+        }
+        for (const auto& o : overrides)
+            if (!written.contains(o.first))
+                w.writeAttribute(o.first, o.second);
+        break;
+    }
+    case QXmlStreamReader::EndElement:
+        w.writeEndElement();
+        break;
+    case QXmlStreamReader::Characters:
+        if (r.isCDATA()) w.writeCDATA(r.text().toString());
+        else             w.writeCharacters(r.text().toString());
+        break;
+    case QXmlStreamReader::Comment:
+        w.writeComment(r.text().toString());
+        break;
+    case QXmlStreamReader::DTD:
+        w.writeDTD(r.text().toString());
+        break;
+    case QXmlStreamReader::EntityReference:
+        w.writeEntityReference(r.name().toString());
+        break;
+    case QXmlStreamReader::ProcessingInstruction:
+        w.writeProcessingInstruction(r.processingInstructionTarget().toString(),
+                                     r.processingInstructionData().toString());
+        break;
+    default:
+        break;
+    }
+}
+
+// 把当前元素整棵子树序列化为缩进 2 的 XML 文本（与原 QDomDocument::toString(2) 一致，
+// 纯空白文本节点丢弃）；返回时 reader 停在该元素的 EndElement
+QString subtreeToString(QXmlStreamReader& r)
+{
+    QString xml;
+    QXmlStreamWriter w(&xml);
+    w.setAutoFormatting(true);
+    w.setAutoFormattingIndent(2);
+    int depth = 0;
+    for (;;) {
+        if (r.isStartElement()) ++depth;
+        if (!(r.isCharacters() && r.isWhitespace()))
+            copyToken(w, r);
+        if (r.isEndElement() && --depth == 0) break;
+        if (r.readNext() == QXmlStreamReader::Invalid) break;
+    }
+    return xml + '\n';
+}
+
+// 载入时切下的图形体源文本（UTF-8，qCompress 压缩），按 subtreeToString 的格式序列化
+QString bodyFromSlice(const QByteArray& packed)
+{
+    QXmlStreamReader r(qUncompress(packed));
+    r.setNamespaceProcessing(false);       // 片段中的 xhtml: 前缀没有声明
+    while (!r.atEnd() && !r.isStartElement())
+        r.readNext();
+    if (!r.isStartElement()) return {};
+    const QString xml = subtreeToString(r);
+    return r.hasError() ? QString() : xml;
+}
+
+// 图形体片段（"LD\n<LD>...</LD>" 去掉首行后的部分）能否完整解析
+bool fragmentValid(const QString& xml)
+{
+    QXmlStreamReader r(xml);
+    r.setNamespaceProcessing(false);   // 片段中的 xhtml: 前缀没有声明
+    while (!r.atEnd()) r.readNext();
+    return !r.hasError();
+}
+
+// 把图形体片段的元素写入 w（跳过文档开始/结束）
+void copyFragment(QXmlStreamWriter& w, const QString& xml)
+{
+    QXmlStreamReader r(xml);
+    r.setNamespaceProcessing(false);
+    while (!r.atEnd()) {
+        r.readNext();
+        if (r.isStartDocument() || r.isEndDocument() || r.isDTD()) continue;
+        if (r.isCharacters() && r.isWhitespace()) continue;
+        copyToken(w, r);
+    }
+}
+
+} // namespace
+
 // -------------------------------------------------------
 // XML 保存（路由到 PLCopen 或 TiZi 自有格式）
 // -------------------------------------------------------
@@ -93,183 +215,221 @@ bool ProjectModel::saveToFile(const QString& path) {
 
 // ── TiZi 自有格式保存 ────────────────────────────────────────
 bool ProjectModel::saveTiZiNative(const QString& path) {
-    QDomDocument doc;
-    QDomProcessingInstruction pi = doc.createProcessingInstruction(
-        "xml", "version=\"1.0\" encoding=\"UTF-8\"");
-    doc.appendChild(pi);
-
-    QDomElement root = doc.createElement("TiZiProject");
-    root.setAttribute("name",    projectName);
-    root.setAttribute("version", "1");
+    QSaveFile file(path);
+    if (!file.open(QFile::WriteOnly))
+        return false;
+
+    QXmlStreamWriter w(&file);
+    w.setAutoFormatting(true);
+    w.setAutoFormattingIndent(2);
+    w.writeStartDocument();
+
+    w.writeStartElement("TiZiProject");
+    w.writeAttribute("name",    projectName);
+    w.writeAttribute("version", "1");
     // 构建设置
-    root.setAttribute("targetType", targetType);
-    root.setAttribute("mode",       mode);
+    w.writeAttribute("targetType", targetType);
+    w.writeAttribute("mode",       mode);
     if (!driver.isEmpty())
-        root.setAttribute("driver", driver);
-    doc.appendChild(root);
+        w.writeAttribute("driver", driver);
 
     for (PouModel* pou : pous) {
-        QDomElement pouElem = doc.createElement("pou");
-        pouElem.setAttribute("name",     pou->name);
-        pouElem.setAttribute("type",     PouModel::typeToString(pou->pouType));
-        pouElem.setAttribute("language", PouModel::langToString(pou->language));
+        w.writeStartElement("pou");
+        w.writeAttribute("name",     pou->name);
+        w.writeAttribute("type",     PouModel::typeToString(pou->pouType));
+        w.writeAttribute("language", PouModel::langToString(pou->language));
 
-        // description
-        QDomElement descElem = doc.createElement("description");
-        descElem.appendChild(doc.createTextNode(pou->description));
-        pouElem.appendChild(descElem);
+        w.writeTextElement("description", pou->description);
 
         // variables
-        QDomElement varsElem = doc.createElement("variables");
+        w.writeStartElement("variables");
         for (const VariableDecl& v : pou->variables) {
-            QDomElement varElem = doc.createElement("var");
-            varElem.setAttribute("name",    v.name);
-            varElem.setAttribute("class",   v.varClass);
-            varElem.setAttribute("type",    v.type);
-            varElem.setAttribute("init",    v.initValue);
-            varElem.setAttribute("comment", v.comment);
-            varsElem.appendChild(varElem);
+            w.writeEmptyElement("var");
+            w.writeAttribute("name",    v.name);
+            w.writeAttribute("class",   v.varClass);
+            w.writeAttribute("type",    v.type);
+            w.writeAttribute("init",    v.initValue);
+            w.writeAttribute("comment", v.comment);
         }
-        pouElem.appendChild(varsElem);
+        w.writeEndElement();
 
         // graphical body（LD/FBD/SFC）或文本 code（ST/IL）
-        if (!pou->graphicalXml.isEmpty()) {
+        if (pou->hasGraphical()) {
             // 保存图形 XML（"LD\n<LD>...</LD>" 格式）
-            QDomElement graphElem = doc.createElement("graphical");
-            graphElem.appendChild(doc.createCDATASection(pou->graphicalXml));
-            pouElem.appendChild(graphElem);
+            w.writeStartElement("graphical");
+            w.writeCDATA(pou->graphicalXml());
+            w.writeEndElement();
         } else {
-            QDomElement codeElem = doc.createElement("code");
+            w.writeStartElement("code");
             if (!pou->code.isEmpty())
-                codeElem.appendChild(doc.createCDATASection(pou->code));
-            pouElem.appendChild(codeElem);
+                w.writeCDATA(pou->code);
+            w.writeEndElement();
         }
 
-        root.appendChild(pouElem);
+        w.writeEndElement();   // pou
     }
 
-    QFile file(path);
-    if (!file.open(QFile::WriteOnly | QFile::Text))
+    w.writeEndElement();       // TiZiProject
+    w.writeEndDocument();
+    if (w.hasError() || !file.commit())
         return false;
 
-    QTextStream stream(&file);
-    doc.save(stream, 2);
-
     filePath = path;
     m_dirty  = false;
     return true;
 }
 
 // ── PLCopen XML 格式保存（Beremiz 兼容）────────────────────────
+//
+// 以导入时保留的原始文件为底稿单遍流式改写，模型不认识的部分
+// （dataTypes、instances、addData …）逐记号原样写回：
+//   fileHeader / contentHeader / TiZiBuild  替换属性
+//   TiZiBuild 不存在时插在 <instances> 之前（或 </project> 前）
+//   与模型同名的第一个 <pou>：替换 <body> 内容（图形体）
+//                             或 ST/IL 的 <xhtml:p> 文本
 bool ProjectModel::savePlcOpen(const QString& path) {
-    // 以原始文档为基础进行克隆
-    QDomDocument doc = m_sourcePlcOpen.cloneNode(true).toDocument();
-    QDomElement  docRoot = doc.documentElement();
-
-    // ── 更新 fileHeader ──────────────────────────────────────
-    QDomElement fhEl = docRoot.firstChildElement("fileHeader");
-    if (!fhEl.isNull()) {
-        fhEl.setAttribute("companyName",    companyName);
-        fhEl.setAttribute("author",         author);
-        fhEl.setAttribute("productVersion", productVersion);
-    }
-
-    // ── 更新 contentHeader ───────────────────────────────────
-    QDomElement chEl = docRoot.firstChildElement("contentHeader");
-    if (!chEl.isNull()) {
-        chEl.setAttribute("name",    projectName);
-        chEl.setAttribute("comment", description);
-        chEl.setAttribute("modificationDateTime",
-                          QDateTime::currentDateTime().toString(Qt::ISODate));
-    }
+    const QByteArray source = qUncompress(m_sourcePlcOpen);
+    if (source.isEmpty()) return false;
+
+    // 从未取出过的图形体与底稿一致，原样保留
+    QHash<QString, const PouModel*> byName;
+    for (const PouModel* pou : pous)
+        if (!pou->graphicalPending() && (pou->hasGraphical() || !pou->code.isEmpty()))
+            byName.insert(pou->name, pou);
+
+    const AttrList fileHeader = {
+        {"companyName",    companyName},
+        {"author",         author},
+        {"productVersion", productVersion},
+    };
+    const AttrList contentHeader = {
+        {"name",    projectName},
+        {"comment", description},
+        {"modificationDateTime", QDateTime::currentDateTime().toString(Qt::ISODate)},
+    };
+    const AttrList build = {
+        {"targetType", targetType},
+        {"driver",     driver},
+        {"mode",       mode},
+        {"compiler",   compiler},
+        {"cflags",     cflags},
+        {"linker",     linker},
+        {"ldflags",    ldflags},
+    };
 
-    // ── 更新/新增 TiZiBuild ──────────────────────────────────
-    QDomElement buildEl = docRoot.firstChildElement("TiZiBuild");
-    if (buildEl.isNull()) {
-        buildEl = doc.createElement("TiZiBuild");
-        // 插在 <instances> 之前（或末尾）
-        QDomElement inst = docRoot.firstChildElement("instances");
-        if (!inst.isNull()) docRoot.insertBefore(buildEl, inst);
-        else docRoot.appendChild(buildEl);
-    }
-    buildEl.setAttribute("targetType", targetType);
-    buildEl.setAttribute("driver",     driver);
-    buildEl.setAttribute("mode",       mode);
-    buildEl.setAttribute("compiler",   compiler);
-    buildEl.setAttribute("cflags",     cflags);
-    buildEl.setAttribute("linker",     linker);
-    buildEl.setAttribute("ldflags",    ldflags);
+    QByteArray out;
+    out.reserve(source.size() + source.size() / 8);
+    QXmlStreamReader r(source);
+    QXmlStreamWriter w(&out);
+
+    QSet<QString>   donePous;
+    const PouModel* curPou    = nullptr;  // 正在改写的 <pou>
+    int             pouDepth  = 0;
+    int             depth     = 0;        // 当前元素深度（<project> = 1）
+    bool            buildDone = false;
+    // ST/IL 改写状态：0 = 无；1 = 等 <body> 的第一个子元素；2 = 等语言元素内第一个子元素
+    int             textState = 0;
+
+    auto writeBuild = [&] {
+        w.writeStartElement("TiZiBuild");
+        for (const auto& a : build) w.writeAttribute(a.first, a.second);
+        w.writeEndElement();
+        buildDone = true;
+    };
 
-    QDomNodeList pouNodes = doc.elementsByTagName("pou");
+    while (!r.atEnd()) {
+        r.readNext();
+        if (r.isStartElement()) {
+            ++depth;
+            const auto name = r.name();
 
-    for (PouModel* pou : pous) {
-        // 找到 name 匹配的 <pou> 节点
-        for (int i = 0; i < pouNodes.count(); ++i) {
-            QDomElement pn = pouNodes.at(i).toElement();
-            if (pn.attribute("name") != pou->name) continue;
-
-            QDomElement bodyElem = pn.firstChildElement("body");
-            if (bodyElem.isNull()) break;
-
-            if (!pou->graphicalXml.isEmpty()) {
-                // 图形体（LD/FBD/SFC）：替换 <body> 的第一子节点
-                int nl = pou->graphicalXml.indexOf('\n');
-                const QString bodyXml = pou->graphicalXml.mid(nl + 1);
-                QDomDocument bdoc;
-                if (bdoc.setContent(bodyXml)) {
-                    QDomElement newBodyChild = bdoc.documentElement();
-                    // 清空旧子节点
-                    while (!bodyElem.firstChild().isNull())
-                        bodyElem.removeChild(bodyElem.firstChild());
-                    // 导入并追加新节点
-                    QDomNode imported = doc.importNode(newBodyChild, true);
-                    bodyElem.appendChild(imported);
+            if (depth == 2 && name == u"fileHeader") {
+                copyToken(w, r, fileHeader);
+                continue;
+            }
+            if (depth == 2 && name == u"contentHeader") {
+                copyToken(w, r, contentHeader);
+                continue;
+            }
+            if (depth == 2 && name == u"TiZiBuild") {
+                copyToken(w, r, build);
+                buildDone = true;
+                continue;
+            }
+            if (depth == 2 && name == u"instances" && !buildDone)
+                writeBuild();
+
+            if (name == u"pou" && !curPou) {
+                const QString pouName = r.attributes().value("name").toString();
+                const PouModel* pou = byName.value(pouName);
+                if (pou && !donePous.contains(pouName)) {
+                    donePous.insert(pouName);
+                    curPou   = pou;
+                    pouDepth = depth;
+                }
+            }
+            else if (curPou && depth == pouDepth + 1 && name == u"body") {
+                if (curPou->hasGraphical()) {
+                    // 图形体：整个 <body> 内容换成新片段
+                    const QString& gx  = curPou->graphicalXml();
+                    const QString frag = gx.mid(gx.indexOf('\n') + 1);
+                    if (fragmentValid(frag)) {
+                        copyToken(w, r);
+                        copyFragment(w, frag);
+                        r.skipCurrentElement();
+                        --depth;
+                        w.writeEndElement();
+                        curPou = nullptr;
+                        continue;
+                    }
+                    curPou = nullptr;         // 片段无效：保留原内容
+                } else {
+                    textState = 1;
                 }
-            } else if (!pou->code.isEmpty()) {
-                // 文本体（ST/IL）：更新 CDATA 内容
-                updateStBody(doc, pn, pou->code);
             }
-            break;
+            else if (textState == 1 && depth == pouDepth + 2) {
+                textState = 2;                // <ST> / <IL>
+            }
+            else if (textState == 2 && depth == pouDepth + 3) {
+                // <xhtml:p>：内容换成 CDATA
+                copyToken(w, r);
+                w.writeCDATA(curPou->code);
+                r.skipCurrentElement();
+                --depth;
+                w.writeEndElement();
+                textState = 0;
+                curPou    = nullptr;
+                continue;
+            }
         }
+        else if (r.isEndElement()) {
+            if (depth == 1 && !buildDone)
+                writeBuild();
+            if (curPou && depth <= pouDepth + 2 && textState != 0 && depth > pouDepth) {
+                // <body> 或语言元素结束前没遇到可改写的子元素
+                textState = 0;
+                curPou    = nullptr;
+            }
+            if (curPou && depth == pouDepth)
+                curPou = nullptr;             // <pou> 内没有 <body>
+            --depth;
+        }
+        copyToken(w, r);
     }
+    if (r.hasError()) return false;
 
-    QFile f(path);
-    if (!f.open(QFile::WriteOnly | QFile::Text)) return false;
-    QTextStream ts(&f);
-    ts.setEncoding(QStringConverter::Utf8);
-    // doc.toString() 已包含原文档的 <?xml ...?> 声明，不需要手动补充
-    ts << doc.toString(2);
+    QSaveFile f(path);
+    if (!f.open(QFile::WriteOnly)) return false;
+    f.write(out);
+    if (!f.commit()) return false;
 
+    // 下次保存以本次输出为底稿
+    m_sourcePlcOpen = qCompress(out, 1);
     filePath = path;
     m_dirty  = false;
     return true;
 }
 
-// ── 更新 ST/IL body 中的 CDATA 内容 ──────────────────────────
-void ProjectModel::updateStBody(QDomDocument& doc,
-                                 QDomElement&  pouElem,
-                                 const QString& code)
-{
-    QDomElement body = pouElem.firstChildElement("body");
-    if (body.isNull()) return;
-    QDomElement lang = body.firstChildElement(); // <ST> or <IL>
-    if (lang.isNull()) return;
-
-    // 找到第一个子元素（可能是 xhtml:p 或 p）
-    QDomElement pElem;
-    QDomNodeList children = lang.childNodes();
-    for (int k = 0; k < children.count(); ++k) {
-        pElem = children.at(k).toElement();
-        if (!pElem.isNull()) break;
-    }
-
-    if (!pElem.isNull()) {
-        while (!pElem.firstChild().isNull())
-            pElem.removeChild(pElem.firstChild());
-        pElem.appendChild(doc.createCDATASection(code));
-    }
-}
-
 // -------------------------------------------------------
 // XML 读档
 // -------------------------------------------------------
@@ -277,59 +437,92 @@ bool ProjectModel::loadFromFile(const QString& path) {
     QFile file(path);
     if (!file.open(QFile::ReadOnly))
         return false;
-
-    QDomDocument doc;
-    if (!doc.setContent(&file))
-        return false;
+    const QByteArray bytes = file.readAll();
+    file.close();
+
+    // 根元素决定格式
+    QString rootName;
+    {
+        QXmlStreamReader peek(bytes);
+        if (!peek.readNextStartElement())
+            return false;
+        rootName = peek.name().toString();
+    }
 
     clear();
 
-    QDomElement root = doc.documentElement();
-
     // ── PLCopen XML 格式（Beremiz/TiZi 的 .tizi PLCopen 文件） ──
-    if (root.tagName() == "project") {
-        return loadPlcOpenXml(doc, path);
+    if (rootName == "project") {
+        if (!loadPlcOpenXml(bytes, path)) {
+            clear();
+            return false;
+        }
+        return true;
     }
 
     // ── TiZi 自有格式 ──
-    if (root.tagName() != "TiZiProject")
+    if (rootName != "TiZiProject")
         return false;
 
-    projectName = root.attribute("name", "Untitled");
-    targetType  = root.attribute("targetType", "Linux");
-    mode        = root.attribute("mode", "NCC");
-    driver      = root.attribute("driver");
-
-    QDomNodeList pouNodes = root.elementsByTagName("pou");
-    for (int i = 0; i < pouNodes.count(); ++i) {
-        QDomElement pe = pouNodes.at(i).toElement();
-        if (pe.isNull()) continue;
-
-        const QString name = pe.attribute("name");
-        PouType    type    = PouModel::typeFromString(pe.attribute("type",     "functionBlock"));
-        PouLanguage lang   = PouModel::langFromString(pe.attribute("language", "LD"));
-
-        PouModel* pou  = new PouModel(name, type, lang);
-        pou->description = pe.firstChildElement("description").text();
-        pou->code        = pe.firstChildElement("code").text();
-        // 图形内容（LD/FBD/SFC），存在 <graphical> 元素中
-        QDomElement graphElem = pe.firstChildElement("graphical");
-        if (!graphElem.isNull())
-            pou->graphicalXml = graphElem.text();
-
-        QDomNodeList varNodes = pe.firstChildElement("variables").elementsByTagName("var");
-        for (int j = 0; j < varNodes.count(); ++j) {
-            QDomElement ve = varNodes.at(j).toElement();
-            VariableDecl v;
-            v.name      = ve.attribute("name");
-            v.varClass  = ve.attribute("class");
-            v.type      = ve.attribute("type");
-            v.initValue = ve.attribute("init");
-            v.comment   = ve.attribute("comment");
-            pou->variables.append(v);
+    QXmlStreamReader r(bytes);
+    r.readNextStartElement();
+    projectName = r.attributes().hasAttribute("name")
+                ? r.attributes().value("name").toString() : QString("Untitled");
+    targetType  = r.attributes().hasAttribute("targetType")
+                ? r.attributes().value("targetType").toString() : QString("Linux");
+    mode        = r.attributes().hasAttribute("mode")
+                ? r.attributes().value("mode").toString() : QString("NCC");
+    driver      = r.attributes().value("driver").toString();
+
+    while (r.readNextStartElement()) {
+        if (r.name() != u"pou") { r.skipCurrentElement(); continue; }
+
+        const QXmlStreamAttributes pa = r.attributes();
+        const QString name = pa.value("name").toString();
+        PouType    type    = PouModel::typeFromString(pa.hasAttribute("type")
+                                 ? pa.value("type").toString() : QString("functionBlock"));
+        PouLanguage lang   = PouModel::langFromString(pa.hasAttribute("language")
+                                 ? pa.value("language").toString() : QString("LD"));
+
+        PouModel* pou = new PouModel(name, type, lang);
+        bool descSeen = false, codeSeen = false, graphSeen = false, varsSeen = false;
+        while (r.readNextStartElement()) {
+            const auto tag = r.name();
+            if (!descSeen && tag == u"description") {
+                pou->description = r.readElementText(QXmlStreamReader::IncludeChildElements);
+                descSeen = true;
+            } else if (!codeSeen && tag == u"code") {
+                pou->code = r.readElementText(QXmlStreamReader::IncludeChildElements);
+                codeSeen = true;
+            } else if (!graphSeen && tag == u"graphical") {
+                // 图形内容（LD/FBD/SFC）
+                pou->setGraphicalXml(r.readElementText(QXmlStreamReader::IncludeChildElements));
+                graphSeen = true;
+            } else if (!varsSeen && tag == u"variables") {
+                varsSeen = true;
+                while (r.readNextStartElement()) {
+                    if (r.name() == u"var") {
+                        const QXmlStreamAttributes va = r.attributes();
+                        VariableDecl v;
+                        v.name      = va.value("name").toString();
+                        v.varClass  = va.value("class").toString();
+                        v.type      = va.value("type").toString();
+                        v.initValue = va.value("init").toString();
+                        v.comment   = va.value("comment").toString();
+                        pou->variables.append(v);
+                    }
+                    r.skipCurrentElement();
+                }
+            } else {
+                r.skipCurrentElement();
+            }
         }
         pous.append(pou);
     }
+    if (r.hasError()) {
+        clear();
+        return false;
+    }
 
     filePath = path;
     m_dirty  = false;
@@ -339,144 +532,231 @@ bool ProjectModel::loadFromFile(const QString& path) {
 
 // -------------------------------------------------------
 // PLCopen XML 导入（IEC 61131-3 标准格式，Beremiz 兼容）
+//
+// 单遍 QXmlStreamReader，不建 DOM。图形体只扫描跳过（不分配节点与字符串），
+// 其源文本切片单独压缩保存，POU 首次打开时才序列化（PouModel::setGraphicalLoader）；
+// 解码后的全文在载入结束即释放。原始文件压缩后保留，供 savePlcOpen 流式合并。
 // -------------------------------------------------------
-bool ProjectModel::loadPlcOpenXml(const QDomDocument& doc, const QString& path)
+bool ProjectModel::loadPlcOpenXml(const QByteArray& xml, const QString& path)
 {
-    QDomElement root = doc.documentElement(); // <project>
-
-    // ── fileHeader ──
-    QDomElement fh = root.firstChildElement("fileHeader");
-    companyName    = fh.attribute("companyName");
-    author         = fh.attribute("author");
-    productVersion = fh.attribute("productVersion", "1");
-    creationDateTime = fh.attribute("creationDateTime");
-
-    // ── contentHeader ──
-    QDomElement hdr = root.firstChildElement("contentHeader");
-    projectName          = hdr.attribute("name", "Imported Project");
-    modificationDateTime = hdr.attribute("modificationDateTime");
-    description          = hdr.attribute("comment");
-
-    // ── TiZiBuild (TiZi 扩展，可选) ──
-    QDomElement build = root.firstChildElement("TiZiBuild");
-    if (!build.isNull()) {
-        targetType = build.attribute("targetType", "Linux");
-        driver     = build.attribute("driver");
-        mode       = build.attribute("mode", "NCC");
-        compiler   = build.attribute("compiler",   "gcc");
-        cflags     = build.attribute("cflags");
-        linker     = build.attribute("linker",     "gcc");
-        ldflags    = build.attribute("ldflags");
+    // 图形体的切片位置用 characterOffset() 表示，须是解码后文本的下标：
+    // UTF-8（PLCopen / Beremiz 的常规编码）先解码再解析；
+    // 其他编码仍按字节解析，图形体当场序列化
+    QString text;
+    {
+        QXmlStreamReader peek(xml);
+        peek.readNext();
+        const bool utf16Bom = xml.startsWith("\xFF\xFE") || xml.startsWith("\xFE\xFF");
+        const QStringView enc = peek.documentEncoding();
+        if (enc.isEmpty() ? !utf16Bom : enc.compare(u"UTF-8", Qt::CaseInsensitive) == 0) {
+            text = QString::fromUtf8(xml);
+            if (text.startsWith(QChar(0xFEFF))) text.remove(0, 1);
+        }
     }
+    QXmlStreamReader r;
+    if (text.isNull()) r.addData(xml);
+    else               r.addData(text);
+    if (!r.readNextStartElement() || r.name() != u"project")
+        return false;
+
+    auto attrOr = [&r](const char* name, const QString& def = {}) -> QString {
+        const QXmlStreamAttributes a = r.attributes();
+        return a.hasAttribute(QLatin1String(name)) ? a.value(QLatin1String(name)).toString() : def;
+    };
 
     // 辅助函数：把 PLCopen varClass 组名映射到我们的字符串
-    auto classStr = [](const QString& tagName) -> QString {
-        if (tagName == "inputVars")    return "Input";
-        if (tagName == "outputVars")   return "Output";
-        if (tagName == "inOutVars")    return "InOut";
-        if (tagName == "localVars")    return "Local";
-        if (tagName == "externalVars") return "External";
-        if (tagName == "globalVars")   return "Global";
+    auto classStr = [](QStringView tagName) -> QString {
+        if (tagName == u"inputVars")    return "Input";
+        if (tagName == u"outputVars")   return "Output";
+        if (tagName == u"inOutVars")    return "InOut";
+        if (tagName == u"localVars")    return "Local";
+        if (tagName == u"externalVars") return "External";
+        if (tagName == u"globalVars")   return "Global";
         return "Local";
     };
 
     // 辅助函数：解析 <type><BOOL/>|<INT/>|<derived name="..."/> 等
-    auto parseType = [](const QDomElement& typeElem) -> QString {
-        QDomElement child = typeElem.firstChildElement();
-        if (child.isNull()) return "BOOL";
-        if (child.tagName() == "derived") return child.attribute("name");
-        return child.tagName(); // BOOL INT REAL …
+    auto parseType = [&r, &attrOr]() -> QString {
+        QString t = "BOOL";
+        bool first = true;
+        while (r.readNextStartElement()) {
+            if (first) t = r.name() == u"derived" ? attrOr("name") : r.name().toString();
+            first = false;
+            r.skipCurrentElement();
+        }
+        return t;
     };
 
-    // ── 遍历 <types><pous><pou> ──
-    QDomElement types = root.firstChildElement("types");
-    QDomElement pousEl = types.firstChildElement("pous");
-    QDomNodeList pouNodes = pousEl.elementsByTagName("pou");
-
-    for (int i = 0; i < pouNodes.count(); ++i) {
-        QDomElement pe = pouNodes.at(i).toElement();
-        if (pe.isNull()) continue;
-
-        const QString name    = pe.attribute("name");
-        const QString pouType = pe.attribute("pouType"); // function/functionBlock/program
-        PouType type = PouModel::typeFromString(pouType);
-
-        // ── 解析接口变量 ──
-        QDomElement iface = pe.firstChildElement("interface");
-        QList<VariableDecl> vars;
-
-        // 遍历所有 varGroup
-        for (QDomElement grp = iface.firstChildElement();
-             !grp.isNull(); grp = grp.nextSiblingElement()) {
-            const QString cls = classStr(grp.tagName());
-            QDomNodeList varNodes = grp.elementsByTagName("variable");
-            for (int j = 0; j < varNodes.count(); ++j) {
-                QDomElement ve = varNodes.at(j).toElement();
-                VariableDecl v;
-                v.name     = ve.attribute("name");
-                v.varClass = cls;
-                v.type     = parseType(ve.firstChildElement("type"));
-                // 初始值
-                QDomElement iv = ve.firstChildElement("initialValue");
-                if (!iv.isNull())
-                    v.initValue = iv.firstChildElement("simpleValue").attribute("value");
-                // 注释 (xhtml:p CDATA)
-                QDomElement doc2 = ve.firstChildElement("documentation");
-                if (!doc2.isNull()) {
-                    QDomElement p = doc2.firstChildElement("p");
-                    if (p.isNull()) {
-                        // 带命名空间前缀
-                        QDomNodeList ps = doc2.childNodes();
-                        for (int k = 0; k < ps.count(); ++k) {
-                            QDomElement pe2 = ps.at(k).toElement();
-                            if (!pe2.isNull()) { v.comment = pe2.text().trimmed(); break; }
+    // 缺省值与原 DOM 实现一致（元素缺失时按空元素处理）
+    projectName    = "Imported Project";
+    productVersion = "1";
+
+    bool fhSeen = false, hdrSeen = false, buildSeen = false, typesSeen = false;
+    while (r.readNextStartElement()) {
+        const auto section = r.name();
+
+        // ── fileHeader ──
+        if (!fhSeen && section == u"fileHeader") {
+            fhSeen = true;
+            companyName      = attrOr("companyName");
+            author           = attrOr("author");
+            productVersion   = attrOr("productVersion", "1");
+            creationDateTime = attrOr("creationDateTime");
+            r.skipCurrentElement();
+        }
+        // ── contentHeader ──
+        else if (!hdrSeen && section == u"contentHeader") {
+            hdrSeen = true;
+            projectName          = attrOr("name", "Imported Project");
+            modificationDateTime = attrOr("modificationDateTime");
+            description          = attrOr("comment");
+            r.skipCurrentElement();
+        }
+        // ── TiZiBuild (TiZi 扩展，可选) ──
+        else if (!buildSeen && section == u"TiZiBuild") {
+            buildSeen = true;
+            targetType = attrOr("targetType", "Linux");
+            driver     = attrOr("driver");
+            mode       = attrOr("mode", "NCC");
+            compiler   = attrOr("compiler", "gcc");
+            cflags     = attrOr("cflags");
+            linker     = attrOr("linker", "gcc");
+            ldflags    = attrOr("ldflags");
+            r.skipCurrentElement();
+        }
+        // ── 遍历 <types><pous><pou> ──
+        else if (!typesSeen && section == u"types") {
+            typesSeen = true;
+            bool pousSeen = false;
+            while (r.readNextStartElement()) {
+                if (pousSeen || r.name() != u"pous") { r.skipCurrentElement(); continue; }
+                pousSeen = true;
+                while (r.readNextStartElement()) {
+                    if (r.name() != u"pou") { r.skipCurrentElement(); continue; }
+
+                    const QString name = attrOr("name");
+                    PouType type = PouModel::typeFromString(attrOr("pouType")); // function/functionBlock/program
+                    QList<VariableDecl> vars;
+                    PouModel* pou = nullptr;
+                    bool ifaceSeen = false, bodySeen = false;
+
+                    while (r.readNextStartElement()) {
+                        // ── 解析接口变量 ──
+                        if (!ifaceSeen && r.name() == u"interface") {
+                            ifaceSeen = true;
+                            while (r.readNextStartElement()) {       // 各 varGroup
+                                const QString cls = classStr(r.name());
+                                while (r.readNextStartElement()) {
+                                    if (r.name() != u"variable") { r.skipCurrentElement(); continue; }
+                                    VariableDecl v;
+                                    v.name     = attrOr("name");
+                                    v.varClass = cls;
+                                    v.type     = "BOOL";
+                                    bool typeSeen = false, ivSeen = false, docSeen = false;
+                                    while (r.readNextStartElement()) {
+                                        if (!typeSeen && r.name() == u"type") {
+                                            v.type   = parseType();
+                                            typeSeen = true;
+                                        } else if (!ivSeen && r.name() == u"initialValue") {
+                                            // 初始值
+                                            ivSeen = true;
+                                            bool sv = false;
+                                            while (r.readNextStartElement()) {
+                                                if (!sv && r.name() == u"simpleValue") {
+                                                    v.initValue = attrOr("value");
+                                                    sv = true;
+                                                }
+                                                r.skipCurrentElement();
+                                            }
+                                        } else if (!docSeen && r.name() == u"documentation") {
+                                            // 注释：优先 <xhtml:p>，否则第一个子元素
+                                            docSeen = true;
+                                            bool haveP = false, haveAny = false;
+                                            while (r.readNextStartElement()) {
+                                                const bool isP = r.name() == u"p";
+                                                if (haveP || (haveAny && !isP)) { r.skipCurrentElement(); continue; }
+                                                v.comment = r.readElementText(QXmlStreamReader::IncludeChildElements).trimmed();
+                                                haveAny = true;
+                                                haveP   = isP;
+                                            }
+                                        } else {
+                                            r.skipCurrentElement();
+                                        }
+                                    }
+                                    vars.append(v);
+                                }
+                            }
+                        }
+                        // ── 解析 body ──
+                        else if (!bodySeen && r.name() == u"body") {
+                            bodySeen = true;
+                            bool langSeen = false;
+                            while (r.readNextStartElement()) {
+                                if (langSeen) { r.skipCurrentElement(); continue; }
+                                langSeen = true;
+                                // ST / IL / LD / FBD / SFC
+                                const QString langTag = r.name().toString();
+                                const QString upper   = langTag.toUpper();
+                                PouLanguage lang = PouLanguage::ST;
+                                if      (upper == "IL")  lang = PouLanguage::IL;
+                                else if (upper == "LD")  lang = PouLanguage::LD;
+                                else if (upper == "FBD") lang = PouLanguage::FBD;
+                                else if (upper == "SFC") lang = PouLanguage::SFC;
+
+                                pou = new PouModel(name, type, lang);
+                                if (lang == PouLanguage::ST || lang == PouLanguage::IL) {
+                                    // 文本体：从 <xhtml:p> CDATA 取内容
+                                    bool pSeen = false;
+                                    while (r.readNextStartElement()) {
+                                        if (!pSeen)
+                                            pou->code = r.readElementText(QXmlStreamReader::IncludeChildElements);
+                                        else
+                                            r.skipCurrentElement();
+                                        pSeen = true;
+                                    }
+                                } else {
+                                    // 图形体：切下 <LANG>...</LANG> 的源文本压缩保存，首次打开时再序列化
+                                    const QString   prefix = r.qualifiedName().toString();   // lang prefix
+                                    const qsizetype begin  = text.isNull() ? -1
+                                        : text.lastIndexOf(QChar('<') + prefix, r.characterOffset());
+                                    if (begin < 0) {
+                                        pou->setGraphicalXml(prefix + "\n" + subtreeToString(r));
+                                    } else {
+                                        r.skipCurrentElement();
+                                        // 结束位置对齐到结束标签的 '>'
+                                        const qsizetype close = text.indexOf(QChar('>'), r.characterOffset() - 1);
+                                        const qsizetype end   = close < 0 ? text.size() : close + 1;
+                                        const QByteArray packed =
+                                            qCompress(QStringView(text).mid(begin, end - begin).toUtf8(), 1);
+                                        pou->setGraphicalLoader([packed, prefix] {
+                                            return prefix + "\n" + bodyFromSlice(packed);
+                                        });
+                                    }
+                                }
+                            }
+                        }
+                        else {
+                            r.skipCurrentElement();
                         }
-                    } else {
-                        v.comment = p.text().trimmed();
                     }
-                }
-                vars.append(v);
-            }
-        }
 
-        // ── 解析 body ──
-        QDomElement body = pe.firstChildElement("body");
-        QDomElement bodyChild = body.firstChildElement(); // ST / IL / LD / FBD / SFC
-        const QString langTag = bodyChild.tagName().toUpper();
-
-        PouLanguage lang = PouLanguage::ST;
-        if (langTag == "ST")  lang = PouLanguage::ST;
-        else if (langTag == "IL")  lang = PouLanguage::IL;
-        else if (langTag == "LD")  lang = PouLanguage::LD;
-        else if (langTag == "FBD") lang = PouLanguage::FBD;
-        else if (langTag == "SFC") lang = PouLanguage::SFC;
-
-        PouModel* pou = new PouModel(name, type, lang);
-        pou->variables = vars;
-
-        if (lang == PouLanguage::ST || lang == PouLanguage::IL) {
-            // 文本体：从 <xhtml:p> CDATA 取内容
-            QDomNodeList ps = bodyChild.childNodes();
-            for (int j = 0; j < ps.count(); ++j) {
-                QDomElement p = ps.at(j).toElement();
-                if (!p.isNull()) {
-                    pou->code = p.text();
-                    break;
+                    if (!pou) pou = new PouModel(name, type, PouLanguage::ST);
+                    pou->variables = vars;
+                    pous.append(pou);
                 }
             }
-        } else {
-            // 图形体：保存原始 XML 供渲染
-            pou->graphicalXml = bodyChild.tagName() + "\n"; // lang prefix
-            QDomDocument tmp;
-            tmp.appendChild(tmp.importNode(bodyChild, true));
-            pou->graphicalXml += tmp.toString(2);
         }
-
-        pous.append(pou);
+        else {
+            r.skipCurrentElement();
+        }
     }
+    while (!r.atEnd() && !r.hasError())
+        r.readNext();
+    if (r.hasError())
+        return false;
 
-    // 保留完整的原始 PLCopen 文档，供 savePlcOpen 使用
-    m_sourcePlcOpen   = doc;
+    // 原始文件压缩保留（XML 压缩比高），供 savePlcOpen 流式合并
+    m_sourcePlcOpen   = qCompress(xml, 1);
     m_isPlcOpenSource = true;
 
     filePath = path;
@@ -5,6 +5,9 @@
 #include <QPen>
 #include <QBrush>
 #include <QGraphicsSceneMouseEvent>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include "../scene/PortIndex.h"
 
 class BaseItem : public QGraphicsObject {
     Q_OBJECT
@@ -12,6 +15,7 @@ public:
     explicit BaseItem(QGraphicsItem *parent = nullptr) : QGraphicsObject(parent) {
         setFlags(ItemIsSelectable | ItemIsMovable | ItemSendsGeometryChanges | ItemIsFocusable);
     }
+    ~BaseItem() override { PortIndex::itemRemoved(scene(), this); }
 
     virtual QPointF leftPort()  const = 0;
     virtual QPointF rightPort() const = 0;
@@ -28,6 +32,21 @@ protected:
     // 默认 20（ContactItem / CoilItem 的 H/2 = 40/2 = 20）
     virtual int portYOffset() const { return 20; }
 
+    // 端口几何（尺寸 / 端口列表）变化后调用，通知场景端口索引
+    void portsChanged() { PortIndex::itemChanged(scene(), this); }
+
+    // 绘制细节层级（按视图缩放，levelOfDetailFromTransform）：
+    //   Low  —— 缩得很小：只画实心轮廓，不画文字，关闭抗锯齿
+    //   Mid  —— 中等缩放：只画名称（实例名 / 变量名），不画端口名与类型标记，关闭抗锯齿
+    //   Full —— 完整绘制
+    enum class Detail { Low, Mid, Full };
+    static Detail detailLevel(QPainter *painter, const QStyleOptionGraphicsItem *option) {
+        const qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+        if (lod < 0.35) return Detail::Low;
+        if (lod < 0.7)  return Detail::Mid;
+        return Detail::Full;
+    }
+
     void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event) override {
         Q_UNUSED(event);
         editProperties();
@@ -49,6 +68,12 @@ protected:
 
             return QPointF(x, y);
         }
+        // 端口索引增量维护：离开场景立即移除，移动 / 变换 / 进入场景标脏
+        if (change == ItemSceneChange)
+            PortIndex::itemRemoved(scene(), this);
+        else if (change == ItemSceneHasChanged || change == ItemPositionHasChanged
+                 || change == ItemTransformHasChanged)
+            portsChanged();
         return QGraphicsObject::itemChange(change, value);
     }
 };
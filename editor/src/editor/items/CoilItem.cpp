@@ -22,6 +22,17 @@ void CoilItem::paint(QPainter *painter,
     const bool selected = (option->state & QStyle::State_Selected);
     const QColor lineColor = selected ? QColor("#0078D7") : QColor("#1A1A1A");
 
+    // ── 0. 细节层级：缩小时简化为实心线圈块，不画文字 ──────────
+    const Detail detail = detailLevel(painter, option);
+    if (detail != Detail::Full)
+        painter->setRenderHint(QPainter::Antialiasing, false);
+    if (detail == Detail::Low) {
+        painter->setPen(QPen(lineColor, 0));
+        painter->drawLine(0, H/2, W, H/2);
+        painter->fillRect(QRectF(10, H/2 - 14, 40, 28), lineColor);
+        return;
+    }
+
     QPen pen(lineColor, 2, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
     painter->setPen(pen);
 
@@ -39,12 +50,12 @@ void CoilItem::paint(QPainter *painter,
     switch (m_type) {
     case SetCoil:
     case ResetCoil: {
+        if (detail != Detail::Full) break;
         QFont f; f.setPixelSize(12); f.setBold(true);
         painter->setFont(f);
         painter->setPen(lineColor);
-        painter->drawText(
-            QRectF(13, H/2 - 10, 34, 20), Qt::AlignCenter,
-            m_type == SetCoil ? "S" : "R");
+        m_markLabel.draw(painter, QRectF(13, H/2 - 10, 34, 20), Qt::AlignCenter,
+                         m_type == SetCoil ? "S" : "R");
         break;
     }
     case Negated: {
@@ -63,7 +74,7 @@ void CoilItem::paint(QPainter *painter,
     labelFont.setPixelSize(11);
     painter->setFont(labelFont);
     painter->setPen(selected ? QColor("#0057A8") : QColor("#333333"));
-    painter->drawText(QRectF(0, -21, W, 18), Qt::AlignCenter, m_tagName);
+    m_tagLabel.draw(painter, QRectF(0, -21, W, 18), Qt::AlignCenter, m_tagName);
 }
 
 QPointF CoilItem::leftPort()  const { return mapToScene(0, H/2); }
@@ -1,5 +1,6 @@
 #pragma once
 #include "BaseItem.h"
+#include "StaticLabel.h"
 
 class CoilItem : public BaseItem {
     Q_OBJECT
@@ -33,6 +34,8 @@ public:
     static const int H = 40;
 
 private:
-    CoilType m_type;
-    QString  m_tagName;
+    CoilType    m_type;
+    QString     m_tagName;
+    StaticLabel m_tagLabel;     // 变量名字形缓存
+    StaticLabel m_markLabel;    // S / R 标记字形缓存
 };
@@ -14,6 +14,7 @@ ContactItem::ContactItem(ContactType type, QGraphicsItem *parent)
 void ContactItem::setExplicitSize(qreal w, qreal h) {
     m_w = w; m_h = h;
     prepareGeometryChange();
+    portsChanged();
     update();
 }
 
@@ -38,6 +39,17 @@ void ContactItem::paint(QPainter *painter,
     const qreal lx = w * 0.25;
     const qreal rx = w * 0.75;
 
+    // ── 0. 细节层级：缩小时简化为实心触点块，不画文字 ──────────
+    const Detail detail = detailLevel(painter, option);
+    if (detail != Detail::Full)
+        painter->setRenderHint(QPainter::Antialiasing, false);
+    if (detail == Detail::Low) {
+        painter->setPen(QPen(lineColor, 0));
+        painter->drawLine(QPointF(0, my), QPointF(w, my));
+        painter->fillRect(QRectF(lx, h * 0.1, rx - lx, h * 0.8), lineColor);
+        return;
+    }
+
     // ── 1. 引线（左/右水平线） ────────────────────────────────
     QPen wirePen(lineColor, qMax(1.0, h * 0.05), Qt::SolidLine, Qt::FlatCap);
     painter->setPen(wirePen);
@@ -63,10 +75,12 @@ void ContactItem::paint(QPainter *painter,
         QRectF box(lx + 2, h * 0.15, rx - lx - 4, h * 0.7);
         painter->setBrush(Qt::NoBrush);
         painter->drawRect(box);
-        QFont f; f.setPixelSize(qMax(7, (int)(h * 0.28))); f.setBold(true);
-        painter->setFont(f);
-        painter->drawText(box, Qt::AlignCenter,
-                          m_type == PositiveTransition ? "P" : "N");
+        if (detail == Detail::Full) {
+            QFont f; f.setPixelSize(qMax(7, (int)(h * 0.28))); f.setBold(true);
+            painter->setFont(f);
+            m_markLabel.draw(painter, box, Qt::AlignCenter,
+                             m_type == PositiveTransition ? "P" : "N");
+        }
         break;
     }
     default:
@@ -80,7 +94,7 @@ void ContactItem::paint(QPainter *painter,
     painter->setFont(labelFont);
     painter->setPen(selected ? QColor("#0057A8") : QColor("#333333"));
     qreal labelH = qMin(h * 0.55, 22.0);
-    painter->drawText(QRectF(0, -labelH, w, labelH), Qt::AlignCenter, m_tagName);
+    m_tagLabel.draw(painter, QRectF(0, -labelH, w, labelH), Qt::AlignCenter, m_tagName);
 }
 
 QPointF ContactItem::leftPort()  const { return mapToScene(0,    m_h / 2.0); }
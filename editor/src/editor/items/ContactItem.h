@@ -1,5 +1,6 @@
 #pragma once
 #include "BaseItem.h"
+#include "StaticLabel.h"
 
 class ContactItem : public BaseItem {
     Q_OBJECT
@@ -40,4 +41,6 @@ private:
     QString     m_tagName;
     qreal       m_w = W;
     qreal       m_h = H;
+    StaticLabel m_tagLabel;     // 变量名字形缓存
+    StaticLabel m_markLabel;    // P / N 标记字形缓存
 };
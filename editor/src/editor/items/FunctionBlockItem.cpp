@@ -127,6 +127,7 @@ void FunctionBlockItem::rebuildPorts() {
     m_inputs  = def.inputs;
     m_outputs = def.outputs;
     prepareGeometryChange();
+    portsChanged();
 }
 
 int FunctionBlockItem::boxHeight() const {
@@ -150,6 +151,20 @@ void FunctionBlockItem::paint(QPainter *painter,
     const QColor fillColor   = QColor("#FAFCFF");
     const QColor headerColor = QColor("#DDE8F5");
 
+    // ── 细节层级：缩得很小时只画实心方框，不画文字 ─────────────
+    const Detail detail = detailLevel(painter, option);
+    if (detail != Detail::Full)
+        painter->setRenderHint(QPainter::Antialiasing, false);
+    if (detail == Detail::Low) {
+        painter->setPen(QPen(borderColor, 0));
+        painter->setBrush(headerColor);
+        painter->drawRect(m_hasXmlGeom ? QRectF(0, 0, m_xmlW, m_xmlH)
+                                       : QRectF(0, 0, BoxWidth, boxHeight()));
+        return;
+    }
+    if (m_inLabels.size()  != m_inputs.size())  m_inLabels.resize(m_inputs.size());
+    if (m_outLabels.size() != m_outputs.size()) m_outLabels.resize(m_outputs.size());
+
     // ── XML 几何模式：按 XML 尺寸缩放绘制 ────────────────────
     if (m_hasXmlGeom) {
         const qreal bw = m_xmlW, bh2 = m_xmlH;
@@ -168,12 +183,14 @@ void FunctionBlockItem::paint(QPainter *painter,
         painter->drawLine(QPointF(0, hH), QPointF(bw, hH));
 
         // 类型名（字体上限 14px，由已封顶的 hH≤28 保证）
-        QFont tf("Consolas, Courier New");
-        tf.setBold(true);
-        tf.setPixelSize(qMax(7, (int)(hH * 0.5)));
-        painter->setFont(tf);
-        painter->setPen(QColor("#1A2E4A"));
-        painter->drawText(QRectF(2, 1, bw - 4, hH - 2), Qt::AlignCenter, m_blockType);
+        if (detail == Detail::Full) {
+            QFont tf("Consolas, Courier New");
+            tf.setBold(true);
+            tf.setPixelSize(qMax(7, (int)(hH * 0.5)));
+            painter->setFont(tf);
+            painter->setPen(QColor("#1A2E4A"));
+            m_typeLabel.draw(painter, QRectF(2, 1, bw - 4, hH - 2), Qt::AlignCenter, m_blockType);
+        }
 
         // 实例名（跟随 hH，避免大块时字体爆炸）
         if (bh2 - hH > 10) {
@@ -182,8 +199,8 @@ void FunctionBlockItem::paint(QPainter *painter,
             sf.setPixelSize(qMax(6, (int)(hH * 0.4)));   // 与 hH 挂钩，上限约 11px
             painter->setFont(sf);
             painter->setPen(QColor("#555555"));
-            painter->drawText(QRectF(2, hH + 1, bw - 4, hH),
-                              Qt::AlignCenter, m_instanceName);
+            m_instLabel.draw(painter, QRectF(2, hH + 1, bw - 4, hH),
+                             Qt::AlignCenter, m_instanceName);
         }
 
         // 端口连线+标签（固定 9px，不随块高缩放）
@@ -198,10 +215,10 @@ void FunctionBlockItem::paint(QPainter *painter,
             painter->setBrush(borderColor);
             painter->drawEllipse(QPointF(-PortLineW, pt.y()), 2.5, 2.5);
             painter->setBrush(Qt::NoBrush);
-            if (i < m_inputs.size()) {
+            if (i < m_inputs.size() && detail == Detail::Full) {
                 painter->setPen(QColor("#333333"));
-                painter->drawText(QRectF(pt.x() + 2, pt.y() - 7, bw * 0.5 - 4, 14),
-                                  Qt::AlignLeft | Qt::AlignVCenter, m_inputs[i]);
+                m_inLabels[i].draw(painter, QRectF(pt.x() + 2, pt.y() - 7, bw * 0.5 - 4, 14),
+                                   Qt::AlignLeft | Qt::AlignVCenter, m_inputs[i]);
             }
         }
         for (int i = 0; i < m_xmlOutPorts.size(); ++i) {
@@ -212,10 +229,10 @@ void FunctionBlockItem::paint(QPainter *painter,
             painter->setBrush(borderColor);
             painter->drawEllipse(QPointF(pt.x() + PortLineW, pt.y()), 2.5, 2.5);
             painter->setBrush(Qt::NoBrush);
-            if (i < m_outputs.size()) {
+            if (i < m_outputs.size() && detail == Detail::Full) {
                 painter->setPen(QColor("#333333"));
-                painter->drawText(QRectF(bw * 0.5, pt.y() - 7, pt.x() - bw * 0.5 - 2, 14),
-                                  Qt::AlignRight | Qt::AlignVCenter, m_outputs[i]);
+                m_outLabels[i].draw(painter, QRectF(bw * 0.5, pt.y() - 7, pt.x() - bw * 0.5 - 2, 14),
+                                    Qt::AlignRight | Qt::AlignVCenter, m_outputs[i]);
             }
         }
 
@@ -244,14 +261,16 @@ void FunctionBlockItem::paint(QPainter *painter,
     painter->drawLine(0, HeaderH, BoxWidth, HeaderH);
 
     // 功能块类型名（大号加粗）
-    QFont typeFont;
-    typeFont.setFamily("Consolas, Courier New");
-    typeFont.setPixelSize(14);
-    typeFont.setBold(true);
-    painter->setFont(typeFont);
-    painter->setPen(QColor("#1A2E4A"));
-    painter->drawText(QRectF(4, 2, BoxWidth - 8, 20),
-                      Qt::AlignCenter, m_blockType);
+    if (detail == Detail::Full) {
+        QFont typeFont;
+        typeFont.setFamily("Consolas, Courier New");
+        typeFont.setPixelSize(14);
+        typeFont.setBold(true);
+        painter->setFont(typeFont);
+        painter->setPen(QColor("#1A2E4A"));
+        m_typeLabel.draw(painter, QRectF(4, 2, BoxWidth - 8, 20),
+                         Qt::AlignCenter, m_blockType);
+    }
 
     // 实例名（小号斜体）
     QFont instFont;
@@ -260,8 +279,8 @@ void FunctionBlockItem::paint(QPainter *painter,
     instFont.setItalic(true);
     painter->setFont(instFont);
     painter->setPen(QColor("#555555"));
-    painter->drawText(QRectF(4, 22, BoxWidth - 8, 18),
-                      Qt::AlignCenter, m_instanceName);
+    m_instLabel.draw(painter, QRectF(4, 22, BoxWidth - 8, 18),
+                     Qt::AlignCenter, m_instanceName);
 
     // ── 3. 端口行 ─────────────────────────────────────────────
     QFont portFont;
@@ -279,10 +298,12 @@ void FunctionBlockItem::paint(QPainter *painter,
             painter->setPen(QPen(borderColor, 1.5));
             painter->drawLine(-PortLineW, cy, 0, cy);
             // 端口名标签
-            painter->setPen(QColor("#333333"));
-            painter->drawText(QRectF(3, cy - 9, BoxWidth / 2 - 6, 18),
-                              Qt::AlignLeft | Qt::AlignVCenter,
-                              m_inputs[i]);
+            if (detail == Detail::Full) {
+                painter->setPen(QColor("#333333"));
+                m_inLabels[i].draw(painter, QRectF(3, cy - 9, BoxWidth / 2 - 6, 18),
+                                   Qt::AlignLeft | Qt::AlignVCenter,
+                                   m_inputs[i]);
+            }
             // 端口点
             painter->setPen(Qt::NoPen);
             painter->setBrush(borderColor);
@@ -294,10 +315,12 @@ void FunctionBlockItem::paint(QPainter *painter,
         if (i < m_outputs.size()) {
             painter->setPen(QPen(borderColor, 1.5));
             painter->drawLine(BoxWidth, cy, BoxWidth + PortLineW, cy);
-            painter->setPen(QColor("#333333"));
-            painter->drawText(QRectF(BoxWidth / 2 + 3, cy - 9, BoxWidth / 2 - 6, 18),
-                              Qt::AlignRight | Qt::AlignVCenter,
-                              m_outputs[i]);
+            if (detail == Detail::Full) {
+                painter->setPen(QColor("#333333"));
+                m_outLabels[i].draw(painter, QRectF(BoxWidth / 2 + 3, cy - 9, BoxWidth / 2 - 6, 18),
+                                    Qt::AlignRight | Qt::AlignVCenter,
+                                    m_outputs[i]);
+            }
             painter->setPen(Qt::NoPen);
             painter->setBrush(borderColor);
             painter->drawEllipse(QPointF(BoxWidth + PortLineW, cy), 2.5, 2.5);
@@ -337,6 +360,7 @@ void FunctionBlockItem::setXmlGeometry(qreal w, qreal h,
     m_xmlOutPorts = outPorts;
     m_hasXmlGeom  = true;
     prepareGeometryChange();
+    portsChanged();
     update();
 }
 
@@ -357,6 +381,7 @@ void FunctionBlockItem::setCustomPorts(const QStringList& inputs,
     m_inputs  = inputs;
     m_outputs = outputs;
     prepareGeometryChange();
+    portsChanged();
     update();
 }
 
@@ -375,7 +400,7 @@ QVariant FunctionBlockItem::itemChange(GraphicsItemChange change,
         qreal y = qRound(p.y() / GridSize) * (qreal)GridSize;
         return QPointF(x, y);
     }
-    return QGraphicsObject::itemChange(change, value);
+    return BaseItem::itemChange(change, value);
 }
 
 void FunctionBlockItem::editProperties() {
@@ -1,5 +1,6 @@
 #pragma once
 #include "BaseItem.h"
+#include "StaticLabel.h"
 #include <QStringList>
 #include <QVector>
 #include <QPointF>
@@ -84,4 +85,10 @@ private:
     QString     m_instanceName;
     QStringList m_inputs;
     QStringList m_outputs;
+
+    // 字形排版缓存（文字或字体变化时自动重排）
+    StaticLabel          m_typeLabel;
+    StaticLabel          m_instLabel;
+    QVector<StaticLabel> m_inLabels;
+    QVector<StaticLabel> m_outLabels;
 };
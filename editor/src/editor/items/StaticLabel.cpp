@@ -0,0 +1,29 @@
+#include "StaticLabel.h"
+
+#include <QPainter>
+
+void StaticLabel::draw(QPainter* painter, const QRectF& rect, int align, const QString& text)
+{
+    const QFont& font = painter->font();
+    if (!m_prepared || m_font != font || m_text.text() != text) {
+        m_text.setText(text);
+        m_text.setTextFormat(Qt::PlainText);
+        m_text.setPerformanceHint(QStaticText::AggressiveCaching);
+        m_text.prepare(QTransform(), font);
+        m_font     = font;
+        m_prepared = true;
+    }
+
+    const QSizeF sz = m_text.size();
+    if (sz.width() > rect.width() || sz.height() > rect.height()) {
+        painter->drawText(rect, align, text);
+        return;
+    }
+
+    qreal x = rect.left(), y = rect.top();
+    if (align & Qt::AlignRight)        x = rect.right() - sz.width();
+    else if (align & Qt::AlignHCenter) x = rect.center().x() - sz.width() / 2.0;
+    if (align & Qt::AlignBottom)       y = rect.bottom() - sz.height();
+    else if (align & Qt::AlignVCenter) y = rect.center().y() - sz.height() / 2.0;
+    painter->drawStaticText(QPointF(x, y), m_text);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <QFont>
+#include <QStaticText>
+#include <QString>
+
+class QPainter;
+class QRectF;
+
+// ─────────────────────────────────────────────────────────────
+// StaticLabel — 图元内单行文字的字形排版缓存
+//
+//   文字与字体不变时复用 QStaticText 的排版结果，重绘不再逐次排版。
+//   放得进目标矩形时按对齐方式直接绘制字形；放不下（需要裁剪）时
+//   退回 QPainter::drawText，外观与未缓存时一致。
+// ─────────────────────────────────────────────────────────────
+class StaticLabel {
+public:
+    // 以 painter 当前字体 / 画笔，在 rect 内按 align 绘制 text
+    void draw(QPainter* painter, const QRectF& rect, int align, const QString& text);
+
+private:
+    QStaticText m_text;
+    QFont       m_font;
+    bool        m_prepared = false;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "BaseItem.h"
+#include "StaticLabel.h"
 #include <QString>
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
@@ -26,6 +27,7 @@ public:
     void setExplicitSize(qreal w, qreal h) {
         m_w = w; m_h = h;
         prepareGeometryChange();
+        portsChanged();
         update();
     }
 
@@ -42,6 +44,17 @@ public:
         QColor border = selected ? QColor("#0078D7") : QColor("#2E7D32");
         QColor fill   = selected ? QColor("#E3F2FD") : QColor("#E8F5E9");
 
+        // 缩得很小时只画实心框，不画表达式
+        const Detail detail = detailLevel(painter, option);
+        if (detail != Detail::Full)
+            painter->setRenderHint(QPainter::Antialiasing, false);
+        if (detail == Detail::Low) {
+            painter->setPen(QPen(border, 0));
+            painter->setBrush(fill);
+            painter->drawRect(QRectF(0, 0, m_w, m_h));
+            return;
+        }
+
         painter->setPen(QPen(border, selected ? 2.0 : 1.5));
         painter->setBrush(fill);
         painter->drawRoundedRect(0, 0, m_w, m_h, 4, 4);
@@ -50,8 +63,8 @@ public:
         f.setPixelSize(qMax(8, (int)(m_h * 0.38)));
         painter->setFont(f);
         painter->setPen(selected ? QColor("#004A99") : QColor("#1B5E20"));
-        painter->drawText(QRectF(3, 0, m_w - 6, m_h),
-                          Qt::AlignCenter, m_expr);
+        m_exprLabel.draw(painter, QRectF(3, 0, m_w - 6, m_h),
+                         Qt::AlignCenter, m_expr);
     }
 
     QPointF leftPort()  const override { return mapToScene(0,    m_h / 2); }
@@ -84,7 +97,7 @@ protected:
             qreal y = qRound(p.y() / GridSize) * (qreal)GridSize;
             return QPointF(x, y);
         }
-        return QGraphicsObject::itemChange(change, value);
+        return BaseItem::itemChange(change, value);
     }
 
 private:
@@ -92,4 +105,5 @@ private:
     Role    m_role;
     qreal   m_w = 100;
     qreal   m_h = 30;
+    StaticLabel m_exprLabel;    // 表达式字形缓存
 };
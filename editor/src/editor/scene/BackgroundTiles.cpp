@@ -0,0 +1,97 @@
+#include "BackgroundTiles.h"
+
+#include <QApplication>
+#include <QCache>
+#include <QPaintEngine>
+#include <QPainter>
+#include <QPalette>
+#include <QPixmap>
+#include <QtMath>
+
+static constexpr qreal kMinTile     = 100.0;    // 瓦片最小边长（场景单位）
+static constexpr qreal kMaxTile     = 3200.0;
+static constexpr qreal kTargetPx    = 512.0;    // 瓦片目标边长（设备像素）
+static constexpr qreal kMaxScale    = 16.0;     // 缩放 × DPR 超过此值直接绘制
+static constexpr int   kBudgetKb    = 48 * 1024;
+
+static bool s_enabled = true;
+
+static QCache<QString, QPixmap>& tileCache()
+{
+    static QCache<QString, QPixmap> cache(kBudgetKb);
+    return cache;
+}
+
+void BackgroundTiles::setEnabled(bool on)
+{
+    s_enabled = on;
+    if (!on) clear();
+}
+
+void BackgroundTiles::clear()
+{
+    tileCache().clear();
+}
+
+void BackgroundTiles::draw(QPainter* painter, const QRectF& rect, const QString& style,
+                           bool periodic, const PaintFn& paint)
+{
+    // 视图只做平移 + 等比缩放时才能贴图；其余情况按原样直接绘制
+    const QTransform wt = painter->worldTransform();
+    const qreal z   = wt.m11();
+    const qreal dpr = painter->device()->devicePixelRatioF();
+    if (!s_enabled || wt.type() > QTransform::TxScale || z <= 0.0
+        || !qFuzzyCompare(z, wt.m22()) || z * dpr > kMaxScale
+        || painter->paintEngine()->type() != QPaintEngine::Raster) {
+        paint(painter, rect);
+        return;
+    }
+
+    qreal tile = kMinTile;
+    while (tile < kMaxTile && tile * 2.0 * z * dpr <= kTargetPx)
+        tile *= 2.0;
+    const int px = qCeil(tile * z * dpr);
+
+    // 键中的缩放取到千分之一：滚轮缩放是离散倍数，同一级别总能命中
+    const QString prefix = QStringLiteral("%1|%2|%3|%4|%5|")
+        .arg(style).arg(qRound(z * 1000.0)).arg(qRound(dpr * 100.0))
+        .arg(QApplication::palette().base().color().rgba(), 0, 16).arg(tile);
+
+    auto tileAt = [&](int tx, int ty) -> QPixmap {
+        const QString key = prefix + (periodic ? QStringLiteral("*")
+                                               : QStringLiteral("%1,%2").arg(tx).arg(ty));
+        if (const QPixmap* hit = tileCache().object(key))
+            return *hit;
+
+        const QRectF src = periodic ? QRectF(0, 0, tile, tile)
+                                    : QRectF(tx * tile, ty * tile, tile, tile);
+        auto* pix = new QPixmap(px, px);
+        pix->setDevicePixelRatio(dpr);
+        pix->fill(QApplication::palette().base().color());
+        {
+            QPainter p(pix);
+            p.setRenderHints(painter->renderHints());
+            p.scale(z, z);
+            p.translate(-src.topLeft());
+            p.setClipRect(src);
+            paint(&p, src);
+        }
+        const QPixmap copy = *pix;      // insert 可能立即淘汰 pix
+        tileCache().insert(key, pix, qMax(1, px * px * 4 / 1024));
+        return copy;
+    };
+
+    const int tx0 = qFloor(rect.left()   / tile), tx1 = qFloor(rect.right()  / tile);
+    const int ty0 = qFloor(rect.top()    / tile), ty1 = qFloor(rect.bottom() / tile);
+
+    painter->save();
+    painter->resetTransform();          // 贴图在视口坐标下进行，避免再次缩放采样
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            const QPointF o = wt.map(QPointF(tx * tile, ty * tile));
+            painter->drawPixmap(QPointF(qRound(o.x() * dpr) / dpr, qRound(o.y() * dpr) / dpr),
+                                tileAt(tx, ty));
+        }
+    }
+    painter->restore();
+}
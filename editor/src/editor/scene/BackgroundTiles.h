@@ -0,0 +1,33 @@
+#pragma once
+#include <QRectF>
+#include <functional>
+
+class QPainter;
+class QString;
+
+// ─────────────────────────────────────────────────────────────
+// BackgroundTiles — 场景背景（点阵 / 梯级 / 电源母线）的瓦片缓存
+//
+//   背景按场景坐标切成正方形瓦片，每块按当前缩放与设备像素比（DPR）
+//   预渲染成 QPixmap，重绘时只贴图。瓦片边长取 100·2^k 场景单位
+//   （GridSize / RungHeight 的整数倍），使一块约 512 设备像素。
+//
+//   缓存键 = 风格名 + 缩放 + DPR + 调色板底色（切换主题即换一组瓦片）
+//            + 瓦片行列；periodic 风格（纯点阵）与位置无关，全图共用一块。
+//   全部场景共用一个 LRU 缓存，超出预算淘汰最久未用的瓦片。
+//
+//   旋转 / 错切变换、非光栅设备（打印、SVG 导出）或缩放过大时
+//   退回直接调用 paint，输出与未缓存时一致。
+// ─────────────────────────────────────────────────────────────
+class BackgroundTiles {
+public:
+    // 在 rect（场景坐标）内绘制背景；paint 为直接绘制函数，仅在缓存未命中时调用
+    using PaintFn = std::function<void(QPainter*, const QRectF&)>;
+
+    static void draw(QPainter* painter, const QRectF& rect, const QString& style,
+                     bool periodic, const PaintFn& paint);
+
+    // 关闭后每帧直接绘制（基准对照用）
+    static void setEnabled(bool on);
+    static void clear();
+};
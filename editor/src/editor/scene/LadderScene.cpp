@@ -13,6 +13,7 @@
 #include "../items/FunctionBlockItem.h"
 #include "../items/BaseItem.h"
 #include "../../utils/UndoStack.h"
+#include "BackgroundTiles.h"
 
 LadderScene::LadderScene(QObject *parent)
     : QGraphicsScene(parent), m_mode(Mode_Select)
@@ -62,8 +63,15 @@ void LadderScene::setMode(EditorMode mode)
 
 // ══════════════════════════════════════════════════════════════
 // drawBackground —— LD 专用：点阵 + 梯级水平母线 + 电源母线 + 梯级编号
+//   按缩放 / DPR / 主题预渲染成瓦片（BackgroundTiles），重绘只贴图；
+//   paintLdBackground 仅在瓦片未命中（或无法贴图）时直接绘制
 // ══════════════════════════════════════════════════════════════
 void LadderScene::drawBackground(QPainter *painter, const QRectF &rect)
+{
+    BackgroundTiles::draw(painter, rect, QStringLiteral("ld"), false, &LadderScene::paintLdBackground);
+}
+
+void LadderScene::paintLdBackground(QPainter *painter, const QRectF &rect)
 {
     const QColor bg  = QApplication::palette().base().color();
     const bool dark  = bg.lightnessF() <= 0.5;
@@ -169,26 +177,9 @@ void LadderScene::drawForeground(QPainter *painter, const QRectF &/*rect*/)
 // ══════════════════════════════════════════════════════════════
 QPointF LadderScene::snapToNearestPort(const QPointF& pos, qreal radius) const
 {
-    QPointF best = pos;
-    qreal bestSq = radius * radius;
-
-    auto check = [&](QPointF p) {
-        qreal dx = p.x() - pos.x(), dy = p.y() - pos.y();
-        qreal d = dx*dx + dy*dy;
-        if (d < bestSq) { bestSq = d; best = p; }
-    };
-
-    for (QGraphicsItem* gi : items()) {
-        if (auto* bi = dynamic_cast<BaseItem*>(gi)) {
-            check(bi->leftPort());
-            check(bi->rightPort());
-        }
-        if (auto* fb = dynamic_cast<FunctionBlockItem*>(gi)) {
-            for (int i = 0; i < fb->inputCount();  ++i) check(fb->inputPortPos(i));
-            for (int i = 0; i < fb->outputCount(); ++i) check(fb->outputPortPos(i));
-        }
-    }
-    return best;
+    // 鼠标移动时每帧调用：走端口网格索引，只查 pos 附近的单元
+    const PortIndex::Port p = m_portIndex.nearest(pos, radius);
+    return p.valid() ? p.pos : pos;
 }
 
 // ══════════════════════════════════════════════════════════════
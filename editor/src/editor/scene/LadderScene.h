@@ -6,6 +6,7 @@
 #include <QHash>
 #include <QMap>
 #include "../items/WireItem.h"
+#include "PortIndex.h"
 
 // ──────────────────────────────────────────────
 // 编辑模式枚举（IEC 61131-3 常用元件）
@@ -61,6 +62,12 @@ public:
     // 从拖放操作（Library→Canvas）创建功能块并加入撤销栈
     void addFunctionBlock(const QString& typeName, const QPointF& scenePos);
 
+    // 元件端口空间索引（端口吸附 / 导线端点匹配 / CodeGenerator 共用）
+    PortIndex&       portIndex()       { return m_portIndex; }
+    const PortIndex& portIndex() const { return m_portIndex; }
+    // 图元端口几何变化（由 PortIndex::itemChanged 调用）；子类可覆盖以跟随更新导线
+    virtual void itemPortsChanged(QGraphicsItem* item) { m_portIndex.markDirty(item); }
+
 signals:
     void modeChanged(EditorMode mode);
 
@@ -95,6 +102,11 @@ protected:
     QHash<QGraphicsItem*, QPointF> m_dragStartPos;
 
 private:
+    // LD 背景的直接绘制（BackgroundTiles 瓦片未命中时调用）
+    static void paintLdBackground(QPainter *painter, const QRectF &rect);
+
+    PortIndex m_portIndex{this};
+
     // LD 背景绘制用色（只在默认 drawBackground 中使用）
     QColor m_backgroundColor;
     QColor m_gridColor;
@@ -2,6 +2,7 @@
 // 继承 LadderScene，增加 PLCopen XML 导入/导出及 FBD/SFC 渲染
 
 #include "PlcOpenViewer.h"
+#include "BackgroundTiles.h"
 
 #include "../items/ContactItem.h"
 #include "../items/CoilItem.h"
@@ -55,13 +56,14 @@ public:
         m_conn.wire = m_wire;
         m_scene->addItem(m_wire);
         m_scene->m_connections << m_conn;
-        m_scene->m_wireTimer->start();
+        m_scene->connectionsChanged();
+        m_scene->scheduleWire(m_scene->m_connections.size() - 1);
         m_ownWire = false;
     }
     void undo() override {
         for (int i = m_scene->m_connections.size()-1; i >= 0; --i)
             if (m_scene->m_connections[i].wire == m_wire)
-                m_scene->m_connections.removeAt(i);
+                m_scene->removeConnectionAt(i);
         m_scene->removeItem(m_wire);
         m_ownWire = true;
     }
@@ -79,15 +81,19 @@ public:
                         QUndoCommand* parent = nullptr)
         : QUndoCommand("Reconnect Wire", parent)
         , m_scene(scene), m_wire(wire), m_before(before), m_after(after) {}
-    void redo() override {
-        for (auto& c : m_scene->m_connections)
-            if (c.wire == m_wire) { auto* w = c.wire; c = m_after; c.wire = w; break; }
-        m_scene->updateAllWires();
-    }
-    void undo() override {
-        for (auto& c : m_scene->m_connections)
-            if (c.wire == m_wire) { auto* w = c.wire; c = m_before; c.wire = w; break; }
-        m_scene->updateAllWires();
+    void redo() override { apply(m_after);  }
+    void undo() override { apply(m_before); }
+private:
+    void apply(const PlcOpenViewer::FbdConn& conn) {
+        auto& list = m_scene->m_connections;
+        for (int i = 0; i < list.size(); ++i) {
+            if (list[i].wire != m_wire) continue;
+            list[i] = conn;
+            list[i].wire = m_wire;
+            m_scene->connectionsChanged();   // 端点 localId 变了
+            m_scene->updateWire(i);
+            break;
+        }
     }
 };
 
@@ -104,21 +110,17 @@ public:
         : QUndoCommand("Move Wire Segment", parent)
         , m_scene(scene), m_wire(wire), m_isSrc(isSrc)
         , m_before(before), m_after(after) {}
-    void redo() override {
-        for (auto& c : m_scene->m_connections)
-            if (c.wire == m_wire) {
-                if (m_isSrc) c.srcJogY = m_after; else c.dstJogY = m_after;
-                break;
-            }
-        m_scene->updateAllWires();
-    }
-    void undo() override {
-        for (auto& c : m_scene->m_connections)
-            if (c.wire == m_wire) {
-                if (m_isSrc) c.srcJogY = m_before; else c.dstJogY = m_before;
-                break;
-            }
-        m_scene->updateAllWires();
+    void redo() override { apply(m_after);  }
+    void undo() override { apply(m_before); }
+private:
+    void apply(qreal y) {
+        auto& list = m_scene->m_connections;
+        for (int i = 0; i < list.size(); ++i) {
+            if (list[i].wire != m_wire) continue;
+            if (m_isSrc) list[i].srcJogY = y; else list[i].dstJogY = y;
+            m_scene->updateWire(i);
+            break;
+        }
     }
 };
 
@@ -133,15 +135,17 @@ public:
                        QUndoCommand* parent = nullptr)
         : QUndoCommand("Move Wire Segment", parent)
         , m_scene(scene), m_wire(wire), m_before(before), m_after(after) {}
-    void redo() override {
-        for (auto& c : m_scene->m_connections)
-            if (c.wire == m_wire) { c.customMidX = m_after; break; }
-        m_scene->updateAllWires();
-    }
-    void undo() override {
-        for (auto& c : m_scene->m_connections)
-            if (c.wire == m_wire) { c.customMidX = m_before; break; }
-        m_scene->updateAllWires();
+    void redo() override { apply(m_after);  }
+    void undo() override { apply(m_before); }
+private:
+    void apply(qreal midX) {
+        auto& list = m_scene->m_connections;
+        for (int i = 0; i < list.size(); ++i) {
+            if (list[i].wire != m_wire) continue;
+            list[i].customMidX = midX;
+            m_scene->updateWire(i);
+            break;
+        }
     }
 };
 
@@ -159,19 +163,27 @@ PlcOpenViewer::PlcOpenViewer(QObject* parent)
 {
     setSceneRect(-80, -80, 2200, 2000);
 
+    // 图元移动只把相连导线标脏，每帧（16 ms）最多重排一次
     m_wireTimer = new QTimer(this);
     m_wireTimer->setSingleShot(true);
-    m_wireTimer->setInterval(0);
+    m_wireTimer->setInterval(16);
     connect(m_wireTimer, &QTimer::timeout,
-            this, &PlcOpenViewer::updateAllWires);
+            this, &PlcOpenViewer::flushWires);
 
     // m_undoStack 已由 LadderScene 构造函数创建
 }
 
 // ─────────────────────────────────────────────────────────────
 // 背景绘制：简单点阵（无 LD 电源母线），覆盖 LadderScene 默认
+//   点阵与位置无关，全图共用一块预渲染瓦片（BackgroundTiles periodic）
 // ─────────────────────────────────────────────────────────────
 void PlcOpenViewer::drawBackground(QPainter* painter, const QRectF& rect)
+{
+    BackgroundTiles::draw(painter, rect, QStringLiteral("dots"), true,
+                          &PlcOpenViewer::paintDotBackground);
+}
+
+void PlcOpenViewer::paintDotBackground(QPainter* painter, const QRectF& rect)
 {
     const QColor bg      = QApplication::palette().base().color();
     const QColor dotColor = bg.lightnessF() > 0.5
@@ -193,6 +205,7 @@ void PlcOpenViewer::loadFromXmlString(const QString& xmlBody)
 {
     // 先清理连接表（wire 指针即将因 clear() 失效）
     m_connections.clear();
+    connectionsChanged();
     clear();
     m_undoStack->clear();
     m_outPort.clear();
@@ -205,10 +218,12 @@ void PlcOpenViewer::loadFromXmlString(const QString& xmlBody)
     const QString xml  = xmlBody.mid(nl + 1);
 
     m_bodyDoc = QDomDocument();
+    m_elemById.clear();
     if (!m_bodyDoc.setContent(xml)) {
         addText("[ failed to parse PLCopen XML ]");
         return;
     }
+    indexBodyDoc();
 
     QDomElement body = m_bodyDoc.documentElement();
     if (body.isNull()) {
@@ -221,6 +236,11 @@ void PlcOpenViewer::loadFromXmlString(const QString& xmlBody)
     else
         buildFbd(body);
 
+    // 导线已按 XML 折点 / 当前端口建好；加载过程中图元入场产生的标脏作废
+    connectionsChanged();
+    m_dirtyWires.clear();
+    m_wireTimer->stop();
+
     // 根据实际内容更新 sceneRect
     QRectF bounds = itemsBoundingRect();
     if (!bounds.isEmpty())
@@ -800,62 +820,114 @@ static QPainterPath buildWirePath(const QPointF& src, const QPointF& dst,
     return path;
 }
 
+void PlcOpenViewer::updateWire(int idx)
+{
+    FbdConn& c = m_connections[idx];
+    if (!c.wire || c.wire->scene() != this) return;
+    QPointF src = getOutputPortScene(c.srcId, c.srcParam);
+    QPointF dst = getInputPortScene (c.dstId, c.dstParam);
+    if (src.x() < -1e8 || dst.x() < -1e8) {
+        c.wire->setPath(QPainterPath());
+        return;
+    }
+    qreal midX = qIsNaN(c.customMidX) ? (src.x() + dst.x()) / 2.0 : c.customMidX;
+    c.wire->setPath(buildWirePath(src, dst, midX, c.srcJogY, c.dstJogY));
+}
+
 void PlcOpenViewer::updateAllWires()
 {
     if (m_updatingWires) return;
     m_updatingWires = true;
 
-    for (FbdConn& c : m_connections) {
-        if (!c.wire || c.wire->scene() != this) continue;
-        QPointF src = getOutputPortScene(c.srcId, c.srcParam);
-        QPointF dst = getInputPortScene (c.dstId, c.dstParam);
-        if (src.x() < -1e8 || dst.x() < -1e8) {
-            c.wire->setPath(QPainterPath());
-            continue;
-        }
-        qreal midX = qIsNaN(c.customMidX) ? (src.x() + dst.x()) / 2.0 : c.customMidX;
-        c.wire->setPath(buildWirePath(src, dst, midX, c.srcJogY, c.dstJogY));
-    }
+    for (int i = 0; i < m_connections.size(); ++i)
+        updateWire(i);
+    m_dirtyWires.clear();
 
     m_updatingWires = false;
 }
 
+// ── 增量重排：localId → 导线邻接表 + 脏导线集合 ───────────────────
+
+void PlcOpenViewer::flushWires()
+{
+    if (m_updatingWires || m_dirtyWires.isEmpty()) return;
+    m_updatingWires = true;
+
+    for (int i : std::as_const(m_dirtyWires))
+        if (i < m_connections.size())
+            updateWire(i);
+    m_dirtyWires.clear();
+
+    m_updatingWires = false;
+}
+
+void PlcOpenViewer::scheduleWire(int idx)
+{
+    m_dirtyWires.insert(idx);
+    if (!m_wireTimer->isActive())
+        m_wireTimer->start();
+}
+
+void PlcOpenViewer::connectionsChanged()
+{
+    m_wiresOfDirty = true;   // 下次用到时重建
+}
+
+void PlcOpenViewer::removeConnectionAt(int idx)
+{
+    m_connections.removeAt(idx);
+    // 其后的下标前移一位
+    QSet<int> dirty;
+    for (int i : std::as_const(m_dirtyWires))
+        if (i != idx) dirty.insert(i > idx ? i - 1 : i);
+    m_dirtyWires = dirty;
+    connectionsChanged();
+}
+
+void PlcOpenViewer::itemPortsChanged(QGraphicsItem* item)
+{
+    LadderScene::itemPortsChanged(item);
+
+    bool ok = false;
+    const int lid = item->data(0).toInt(&ok);
+    if (!ok || m_items.value(lid) != item) return;
+
+    if (m_wiresOfDirty) {
+        m_wiresOf.clear();
+        for (int i = 0; i < m_connections.size(); ++i) {
+            m_wiresOf.insert(m_connections[i].srcId, i);
+            if (m_connections[i].dstId != m_connections[i].srcId)
+                m_wiresOf.insert(m_connections[i].dstId, i);
+        }
+        m_wiresOfDirty = false;
+    }
+    for (auto it = m_wiresOf.constFind(lid); it != m_wiresOf.cend() && it.key() == lid; ++it)
+        scheduleWire(it.value());
+}
+
 // ═══════════════════════════════════════════════════════════════
 // 端口反向查找 & 线段几何判断
 // ═══════════════════════════════════════════════════════════════
 
 PlcOpenViewer::PortRef PlcOpenViewer::findPortAt(const QPointF& pos, qreal radius) const
 {
-    PortRef best;
-    qreal bestD2 = radius * radius;
-
-    auto check = [&](int lid, const QString& param, bool isOut, const QPointF& pt) {
-        qreal dx = pt.x() - pos.x(), dy = pt.y() - pos.y();
-        qreal d2 = dx*dx + dy*dy;
-        if (d2 < bestD2) { bestD2 = d2; best = {lid, param, isOut}; }
+    // 端口网格索引只查 pos 附近的单元；过滤条件与逐项扫描 m_items 时一致
+    auto accept = [this](const PortIndex::Port& p) {
+        if (!p.isPin()) return false;
+        bool ok = false;
+        const int lid = p.item->data(0).toInt(&ok);
+        if (!ok || m_items.value(lid) != p.item) return false;
+        if (auto* vb = qgraphicsitem_cast<VarBoxItem*>(p.item))
+            return p.isOutput ? vb->role() != VarBoxItem::OutVar
+                              : vb->role() != VarBoxItem::InVar;
+        return true;
     };
+    const PortIndex::Port p = portIndex().nearest(pos, radius, accept);
+    if (!p.valid()) return {};
 
-    for (auto it = m_items.cbegin(); it != m_items.cend(); ++it) {
-        int lid = it.key();
-        QGraphicsItem* gi = it.value();
-        if (auto* fb = qgraphicsitem_cast<FunctionBlockItem*>(gi)) {
-            for (int i = 0; i < fb->inputCount(); ++i)
-                check(lid, fb->inputPortName(i),  false, fb->inputPortPos(i));
-            for (int i = 0; i < fb->outputCount(); ++i)
-                check(lid, fb->outputPortName(i), true,  fb->outputPortPos(i));
-        } else if (auto* vb = qgraphicsitem_cast<VarBoxItem*>(gi)) {
-            if (vb->role() != VarBoxItem::OutVar)
-                check(lid, {}, true,  vb->rightPort());
-            if (vb->role() != VarBoxItem::InVar)
-                check(lid, {}, false, vb->leftPort());
-        } else if (auto* ct = qgraphicsitem_cast<ContactItem*>(gi)) {
-            check(lid, {}, false, ct->leftPort());
-            check(lid, {}, true,  ct->rightPort());
-        } else if (auto* coil = qgraphicsitem_cast<CoilItem*>(gi)) {
-            check(lid, {}, false, coil->leftPort());
-            check(lid, {}, true,  coil->rightPort());
-        }
-    }
+    PortRef best{p.item->data(0).toInt(), {}, p.isOutput};
+    if (auto* fb = qgraphicsitem_cast<FunctionBlockItem*>(p.item))
+        best.param = p.isOutput ? fb->outputPortName(p.index) : fb->inputPortName(p.index);
     return best;
 }
 
@@ -1201,7 +1273,7 @@ void PlcOpenViewer::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
         } else {
             // 恢复原连接
             c = m_epDragOldConn;
-            updateAllWires();
+            updateWire(m_epDragIdx);
         }
         m_epDragIdx    = -1;
         m_showPortSnap = false;
@@ -1219,7 +1291,7 @@ void PlcOpenViewer::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
                 m_segDragOldMidX, newMidX));
         } else {
             m_connections[m_segDragIdx].customMidX = qQNaN();
-            updateAllWires();
+            updateWire(m_segDragIdx);
         }
         m_segDragIdx = -1;
         for (auto* v : views()) v->setCursor(Qt::ArrowCursor);
@@ -1237,7 +1309,7 @@ void PlcOpenViewer::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
             // 未移动 → 恢复原值
             if (m_horizDragIsSrc) c.srcJogY = qIsNaN(m_horizDragOldY) ? qQNaN() : m_horizDragOldY;
             else                  c.dstJogY = qIsNaN(m_horizDragOldY) ? qQNaN() : m_horizDragOldY;
-            updateAllWires();
+            updateWire(m_horizDragIdx);
         }
         m_horizDragIdx = -1;
         for (auto* v : views()) v->setCursor(Qt::ArrowCursor);
@@ -1276,22 +1348,24 @@ void PlcOpenViewer::drawForeground(QPainter* painter, const QRectF& rect)
     }
 }
 
-QDomElement PlcOpenViewer::findElemById(const QDomElement& root, int lid)
+void PlcOpenViewer::indexBodyDoc()
 {
+    m_elemById.clear();
+    const QDomElement root = m_bodyDoc.documentElement();
     for (QDomElement e = root.firstChildElement();
          !e.isNull(); e = e.nextSiblingElement()) {
-        if (e.attribute("localId", "-1").toInt() == lid) return e;
+        bool ok = false;
+        const int lid = e.attribute("localId").toInt(&ok);
+        if (ok && !m_elemById.contains(lid)) m_elemById.insert(lid, e);  // 重复 id 取第一个
     }
-    return {};
 }
 
 void PlcOpenViewer::syncPositionsToDoc()
 {
     if (m_bodyDoc.isNull()) return;
-    QDomElement root = m_bodyDoc.documentElement();
 
     for (auto it = m_items.cbegin(); it != m_items.cend(); ++it) {
-        QDomElement elem = findElemById(root, it.key());
+        QDomElement elem = elemById(it.key());
         if (elem.isNull()) continue;
 
         QPointF p = it.value()->pos() / kScale;
@@ -1306,14 +1380,13 @@ void PlcOpenViewer::syncPositionsToDoc()
 void PlcOpenViewer::syncWirePathsToDoc()
 {
     if (m_bodyDoc.isNull()) return;
-    QDomElement root = m_bodyDoc.documentElement();
 
     for (const FbdConn& c : m_connections) {
         if (!c.wire) continue;
         QPainterPath path = c.wire->path();
         if (path.elementCount() < 2) continue;
 
-        QDomElement dstElem = findElemById(root, c.dstId);
+        QDomElement dstElem = elemById(c.dstId);
         if (dstElem.isNull()) continue;
 
         QDomElement connElem;
@@ -1369,6 +1442,7 @@ QString PlcOpenViewer::toXmlString()
 {
     if (m_bodyLanguage.isEmpty()) return {};
 
+    flushWires();           // 尚未重排的导线先落定，再写折点
     if (m_isNewScene) {
         buildBodyFromScene();
     } else {
@@ -1466,6 +1540,7 @@ void PlcOpenViewer::buildBodyFromScene()
             root.appendChild(e);
         }
     }
+    indexBodyDoc();
 
     // 处理用户画的导线：匹配端口坐标 → 写入目标元素的 <connectionPointIn>
     const qreal tol = 15.0;
@@ -1491,7 +1566,7 @@ void PlcOpenViewer::buildBodyFromScene()
 
         if (srcId < 0 || dstId < 0) continue;
 
-        QDomElement dstElem = findElemById(root, dstId);
+        QDomElement dstElem = elemById(dstId);
         if (dstElem.isNull()) continue;
 
         QDomElement cpIn = dstElem.firstChildElement("connectionPointIn");
@@ -1508,6 +1583,9 @@ void PlcOpenViewer::buildBodyFromScene()
 void PlcOpenViewer::initEmpty(const QString& lang)
 {
     m_connections.clear();
+    connectionsChanged();
+    m_dirtyWires.clear();
+    m_wireTimer->stop();
     clear();
     m_undoStack->clear();
     m_outPort.clear();
@@ -1517,6 +1595,7 @@ void PlcOpenViewer::initEmpty(const QString& lang)
     m_bodyLanguage = lang.toUpper().isEmpty() ? "LD" : lang.toUpper();
     m_bodyDoc      = QDomDocument();
     m_bodyDoc.appendChild(m_bodyDoc.createElement(m_bodyLanguage));
+    m_elemById.clear();
     m_isNewScene   = true;
 
     // 左电源母线（放在左上角，用户可自由移动）
@@ -1,7 +1,10 @@
 #pragma once
 #include <QDomElement>
 #include <QDomDocument>
+#include <QHash>
 #include <QMap>
+#include <QMultiHash>
+#include <QSet>
 #include <QList>
 #include <QPointF>
 #include <QString>
@@ -39,6 +42,14 @@ public:
     // 序列化场景 → "FBD\n<FBD>...</FBD>"（同步 item 位置后返回）
     QString toXmlString();
 
+    // 立即重排被标脏的导线（平时由每帧一次的 m_wireTimer 触发）
+    void flushWires();
+    // 全部导线按当前端口重新布线
+    void updateAllWires();
+
+    // 图元端口移动：相连导线标脏（邻接表查找，与导线总数无关）
+    void itemPortsChanged(QGraphicsItem* item) override;
+
     // setMode / currentMode / undoStack / modeChanged 均继承自 LadderScene
 
 protected:
@@ -53,6 +64,9 @@ protected:
     void drawForeground   (QPainter* painter, const QRectF& rect) override;
 
 private:
+    // 点阵的直接绘制（BackgroundTiles 瓦片未命中时调用）
+    static void paintDotBackground(QPainter* painter, const QRectF& rect);
+
     // ── PLCopen XML 渲染 ──────────────────────────────────────
     void buildFbd(const QDomElement& body);
     void buildSfc(const QDomElement& body);
@@ -85,14 +99,18 @@ private:
         bool    valid()  const { return lid >= 0; }
     };
 
-    void    updateAllWires();
+    void    updateWire(int idx);        // 单条导线按当前端口重新布线
+    void    scheduleWire(int idx);      // 标脏，下一帧 flushWires
+    void    connectionsChanged();       // m_connections 增删 / 端点改变：邻接表失效
+    void    removeConnectionAt(int idx);
     void    syncPositionsToDoc();       // item 坐标 → m_bodyDoc <position>
     void    syncWirePathsToDoc();       // 导线折点 → m_bodyDoc <connection>/<position>
     void    buildBodyFromScene();       // 从场景 item 重建 m_bodyDoc（新建画布用）
 
     QPointF getOutputPortScene(int lid, const QString& param) const;
     QPointF getInputPortScene (int lid, const QString& param) const;
-    static QDomElement findElemById(const QDomElement& root, int lid);
+    QDomElement elemById(int lid) const { return m_elemById.value(lid); }
+    void        indexBodyDoc();         // 重建 m_elemById（m_bodyDoc 整体替换后调用）
 
     // 端口反向查找
     PortRef findPortAt(const QPointF& pos, qreal radius = 20.0) const;
@@ -111,6 +129,10 @@ private:
     QList<FbdConn> m_connections;
     bool           m_updatingWires = false;
     QTimer*        m_wireTimer     = nullptr;
+    // localId → 与之相连的 m_connections 下标（src、dst 两端），结构变化后惰性重建
+    QMultiHash<int, int> m_wiresOf;
+    bool                 m_wiresOfDirty = true;
+    QSet<int>            m_dirtyWires;   // 待重排的导线下标
 
     // ── 导线线段拖拽状态 ──────────────────────────────────────
     int   m_segDragIdx    = -1;   // 正在拖拽的 m_connections 索引（-1=未激活）
@@ -132,6 +154,10 @@ private:
     QString      m_bodyLanguage;       // "FBD" / "LD" / "SFC"
     QDomDocument m_bodyDoc;
     bool         m_isNewScene = false; // true = initEmpty() 创建，需 buildBodyFromScene()
+    // localId → m_bodyDoc 根下的元素。m_bodyDoc 只在加载 / buildBodyFromScene 时整体替换，
+    // 编辑期间的增删与撤销不改 DOM（新图元不在其中，删除的图元不在 m_items 中被跳过），
+    // 故只需在替换后重建一次
+    QHash<int, QDomElement> m_elemById;
 
     // ── 折线画线模式折点积累 ──────────────────────────────────
     QList<QPointF> m_wirePoints;  // 已点击固定的折点（第一点到倒数第二点）
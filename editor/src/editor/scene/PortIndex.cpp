@@ -0,0 +1,144 @@
+#include "PortIndex.h"
+#include "LadderScene.h"
+
+#include "../items/CoilItem.h"
+#include "../items/ContactItem.h"
+#include "../items/FunctionBlockItem.h"
+#include "../items/VarBoxItem.h"
+
+#include <QtMath>
+#include <algorithm>
+
+static int cellOf(qreal v)
+{
+    return qFloor(v / PortIndex::CellSize);
+}
+
+static quint64 cellKey(int cx, int cy)
+{
+    return (quint64(quint32(cx)) << 32) | quint32(cy);
+}
+
+// ─────────────────────────────────────────────────────────────
+// 场景挂接
+// ─────────────────────────────────────────────────────────────
+PortIndex* PortIndex::of(QGraphicsScene* scene)
+{
+    // 场景析构过程中（~LadderScene 之后）动态类型已退回 QGraphicsScene，
+    // 此处返回 nullptr，图元析构不会触及已销毁的索引
+    auto* ls = qobject_cast<LadderScene*>(scene);
+    return ls ? &ls->portIndex() : nullptr;
+}
+
+void PortIndex::itemChanged(QGraphicsScene* scene, QGraphicsItem* item)
+{
+    if (auto* ls = qobject_cast<LadderScene*>(scene))
+        ls->itemPortsChanged(item);
+}
+
+void PortIndex::itemRemoved(QGraphicsScene* scene, QGraphicsItem* item)
+{
+    if (PortIndex* idx = of(scene)) idx->remove(item);
+}
+
+// ─────────────────────────────────────────────────────────────
+// 图元端口枚举
+// ─────────────────────────────────────────────────────────────
+QVector<PortIndex::Port> PortIndex::collect(QGraphicsItem* item)
+{
+    QVector<Port> ports;
+    if (auto* fb = qgraphicsitem_cast<FunctionBlockItem*>(item)) {
+        for (int i = 0; i < fb->inputCount(); ++i)
+            ports.append({item, i, false, fb->inputPortPos(i)});
+        for (int i = 0; i < fb->outputCount(); ++i)
+            ports.append({item, i, true,  fb->outputPortPos(i)});
+        // 能流端（LD 中 EN / ENO 式连接）排在引脚之后：与引脚重合时 nearest 取引脚
+        ports.append({item, PowerFlow, false, fb->leftPort()});
+        ports.append({item, PowerFlow, true,  fb->rightPort()});
+    } else if (auto* vb = qgraphicsitem_cast<VarBoxItem*>(item)) {
+        ports.append({item, 0, false, vb->leftPort()});
+        ports.append({item, 0, true,  vb->rightPort()});
+    } else if (auto* ct = qgraphicsitem_cast<ContactItem*>(item)) {
+        ports.append({item, 0, false, ct->leftPort()});
+        ports.append({item, 0, true,  ct->rightPort()});
+    } else if (auto* co = qgraphicsitem_cast<CoilItem*>(item)) {
+        ports.append({item, 0, false, co->leftPort()});
+        ports.append({item, 0, true,  co->rightPort()});
+    }
+    return ports;
+}
+
+// ─────────────────────────────────────────────────────────────
+// 维护
+// ─────────────────────────────────────────────────────────────
+void PortIndex::unlink(QGraphicsItem* item) const
+{
+    const QVector<Port> old = m_ports.take(item);
+    for (const Port& p : old) {
+        auto cell = m_cells.find(cellKey(cellOf(p.pos.x()), cellOf(p.pos.y())));
+        if (cell == m_cells.end()) continue;    // 同一单元已在前一个端口处清理
+        QVector<Port>& v = cell.value();
+        v.erase(std::remove_if(v.begin(), v.end(),
+                               [item](const Port& q) { return q.item == item; }),
+                v.end());
+        if (v.isEmpty()) m_cells.erase(cell);
+    }
+}
+
+void PortIndex::flush() const
+{
+    if (m_dirty.isEmpty()) return;
+    for (QGraphicsItem* item : std::as_const(m_dirty)) {
+        unlink(item);
+        if (item->scene() != m_scene) continue;
+        const QVector<Port> ports = collect(item);
+        if (ports.isEmpty()) continue;
+        for (const Port& p : ports)
+            m_cells[cellKey(cellOf(p.pos.x()), cellOf(p.pos.y()))].append(p);
+        m_ports.insert(item, ports);
+    }
+    m_dirty.clear();
+}
+
+void PortIndex::remove(QGraphicsItem* item)
+{
+    m_dirty.remove(item);
+    unlink(item);
+}
+
+void PortIndex::rebuild()
+{
+    m_cells.clear();
+    m_ports.clear();
+    m_dirty.clear();
+    for (QGraphicsItem* item : m_scene->items())
+        m_dirty.insert(item);
+}
+
+// ─────────────────────────────────────────────────────────────
+// 查询
+// ─────────────────────────────────────────────────────────────
+PortIndex::Port PortIndex::nearest(const QPointF& pos, qreal radius, const Filter& accept) const
+{
+    flush();
+
+    Port  best;
+    qreal bestD2 = radius * radius;
+    const int x0 = cellOf(pos.x() - radius), x1 = cellOf(pos.x() + radius);
+    const int y0 = cellOf(pos.y() - radius), y1 = cellOf(pos.y() + radius);
+    for (int cx = x0; cx <= x1; ++cx) {
+        for (int cy = y0; cy <= y1; ++cy) {
+            const auto cell = m_cells.constFind(cellKey(cx, cy));
+            if (cell == m_cells.cend()) continue;
+            for (const Port& p : cell.value()) {
+                const qreal dx = p.pos.x() - pos.x(), dy = p.pos.y() - pos.y();
+                const qreal d2 = dx*dx + dy*dy;
+                if (d2 < bestD2 && (!accept || accept(p))) {
+                    bestD2 = d2;
+                    best   = p;
+                }
+            }
+        }
+    }
+    return best;
+}
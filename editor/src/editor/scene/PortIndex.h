@@ -0,0 +1,68 @@
+#pragma once
+#include <QHash>
+#include <QPointF>
+#include <QSet>
+#include <QVector>
+#include <functional>
+
+class QGraphicsItem;
+class QGraphicsScene;
+
+// ─────────────────────────────────────────────────────────────
+// PortIndex — 场景内元件端口的均匀网格空间索引
+//
+//   端口 = ContactItem / CoilItem / VarBoxItem 的左（输入）/右（输出）端，
+//          FunctionBlockItem 的各输入/输出引脚及其能流端 leftPort / rightPort
+//          （index = PowerFlow，仅供端口吸附），均为场景坐标。
+//   nearest() 只检查查询圆覆盖的网格单元，耗时与场景图元总数无关。
+//
+//   增量、惰性维护：BaseItem::itemChange 在位置 / 变换 / 所属场景变化时、
+//   端口几何 setter 在尺寸 / 端口列表变化时调用 itemChanged()，
+//   只登记脏图元；下一次查询前重算这些图元的端口。
+//   离开场景或析构的图元立即移除，索引中不保留悬空指针。
+//
+//   LadderScene 持有一份（portIndex()），端口吸附、PlcOpenViewer::findPortAt
+//   与 CodeGenerator 共用。
+// ─────────────────────────────────────────────────────────────
+class PortIndex {
+public:
+    static constexpr qreal CellSize  = 40.0;
+    static constexpr int   PowerFlow = -1;  // FunctionBlockItem::leftPort / rightPort
+
+    struct Port {
+        QGraphicsItem* item     = nullptr;
+        int            index    = 0;       // FunctionBlockItem 为引脚序号，其余为 0
+        bool           isOutput = false;
+        QPointF        pos;                // 场景坐标
+        bool valid() const { return item != nullptr; }
+        bool isPin() const { return index != PowerFlow; }
+    };
+    using Filter = std::function<bool(const Port&)>;
+
+    explicit PortIndex(QGraphicsScene* scene) : m_scene(scene) {}
+
+    // scene 为 LadderScene 时返回其索引，否则 nullptr
+    static PortIndex* of(QGraphicsScene* scene);
+    // 图元端口几何可能变化（scene 无索引时忽略；经 LadderScene::itemPortsChanged 转发）
+    static void itemChanged(QGraphicsScene* scene, QGraphicsItem* item);
+    // 图元离开 scene 或即将析构（scene 无索引时忽略）
+    static void itemRemoved(QGraphicsScene* scene, QGraphicsItem* item);
+
+    void markDirty(QGraphicsItem* item) { m_dirty.insert(item); }
+    void remove(QGraphicsItem* item);
+    // 按场景当前图元全量重建（临时索引用）
+    void rebuild();
+
+    // radius 内离 pos 最近、且通过 accept 的端口；没有则 valid() == false
+    Port nearest(const QPointF& pos, qreal radius, const Filter& accept = {}) const;
+
+private:
+    static QVector<Port> collect(QGraphicsItem* item);
+    void flush() const;
+    void unlink(QGraphicsItem* item) const;
+
+    QGraphicsScene*                              m_scene;
+    mutable QHash<quint64, QVector<Port>>        m_cells;   // 网格单元 → 端口
+    mutable QHash<QGraphicsItem*, QVector<Port>> m_ports;   // 图元 → 已登记端口
+    mutable QSet<QGraphicsItem*>                 m_dirty;
+};
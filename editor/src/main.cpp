@@ -1,5 +1,6 @@
 // 程序入口
 
+#include "app/Benchmarks.h"
 #include "app/MainWindow.h"
 #include <QApplication>
 
@@ -10,6 +11,11 @@ int main(int argc, char *argv[]) {
     app.setApplicationVersion("0.1.0");
     app.setOrganizationName("TiZiTeam");
 
+    // 命令行性能基准：TiZi --bench <名称> [参数...]，不显示主窗口
+    const QStringList args = app.arguments();
+    if (args.size() > 1 && args.at(1) == "--bench")
+        return Benchmarks::run(args.mid(2));
+
     MainWindow window;
     window.show();
 
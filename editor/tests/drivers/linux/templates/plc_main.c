@@ -1,9 +1,27 @@
 /* Generated by TiZi -- POSIX PLC main (Linux) */
 /* DO NOT EDIT -- regenerate via TiZi Build     */
+#include <errno.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
 #include "iec_std_lib.h"
 #include "config.h"
+#include "tizi_image.h"
+#include "tizi_tasks.h"   /* TIZI_TASK_LIST / TIZI_TASK_COUNT, generated from IEC TASKs */
 
 /* matiec runtime globals */
 TIME __CURRENT_TIME;
@@ -13,22 +31,632 @@ extern void config_init__(void);
 extern void config_run__(unsigned long tick);
 extern unsigned long long common_ticktime__;
 
-static void update_time(void) {
+/* matiec located 变量：后备存储 + POU 引用的指针。
+ * image_open() 在 config_init__() 把指针复制进 POU 实例之前，将其改指向过程映像 */
+#define __LOCATED_VAR(type, name, ...) type __##name;
+#include "LOCATED_VARIABLES.h"
+#undef __LOCATED_VAR
+#define __LOCATED_VAR(type, name, ...) type *name = &__##name;
+#include "LOCATED_VARIABLES.h"
+#undef __LOCATED_VAR
+
+/* ─────────────────────────────────────────────────────────────
+ * 过程映像（布局与一致性协议见 tizi_image.h）
+ *   %Q / %M：指针直接指向 out / mem，扫描前后各递增一次 out_seq
+ *   %I     ：指针指向 in；扫描开始时若驱动发布了新输入，
+ *            只把程序引用到的 %I 单元从 in_buf 前台缓冲取到 in
+ * shm 不可用时退回进程内映像，程序照常运行。
+ * ───────────────────────────────────────────────────────────── */
+typedef struct {
+    const char           *loc;   /* "IX", "QW", "MD", ... */
+    const unsigned short *idx;   /* location indices, e.g. {0, 3} for %IX0.3 */
+    unsigned              nidx;
+    void                **ptr;   /* matiec 的 located 指针 */
+} LocatedVar_t;
+
+#define __LOCATED_VAR(type, name, dir, size, ...) \
+    static const unsigned short name##_idx[] = { __VA_ARGS__ };
+#include "LOCATED_VARIABLES.h"
+#undef __LOCATED_VAR
+#define __LOCATED_VAR(type, name, dir, size, ...) \
+    { #dir #size, name##_idx, sizeof(name##_idx) / sizeof(name##_idx[0]), (void **)&name },
+static const LocatedVar_t s_located[] = {
+#include "LOCATED_VARIABLES.h"
+    { 0, 0, 0, 0 }
+};
+#undef __LOCATED_VAR
+
+#define MAX_BOUND_INPUTS  (sizeof(s_located) / sizeof(s_located[0]))
+
+static TiziImage_t  s_local_image;            /* shm 不可用时的后备 */
+static TiziImage_t *s_img = &s_local_image;
+static unsigned     s_in_front;
+static unsigned     s_in_count;               /* 已绑定的 %I 单元 */
+static unsigned     s_in_off[MAX_BOUND_INPUTS];
+static unsigned     s_in_width[MAX_BOUND_INPUTS];
+
+/* located 地址在 TiziArea_t 中的偏移与宽度；超出范围返回 -1 */
+static long area_offset(const LocatedVar_t *l, unsigned *width) {
+    const unsigned a = l->idx[0];
+    switch (l->loc[1]) {
+    case 'X':
+        *width = 1;
+        if (l->nidx == 2 && l->idx[1] < 8 && a * 8u + l->idx[1] < TIZI_IMG_X)
+            return (long)(offsetof(TiziArea_t, x) + a * 8u + l->idx[1]);
+        break;
+    case 'B':
+        *width = 1;
+        if (l->nidx == 1 && a < TIZI_IMG_B) return (long)(offsetof(TiziArea_t, b) + a);
+        break;
+    case 'W':
+        *width = 2;
+        if (l->nidx == 1 && a < TIZI_IMG_W) return (long)(offsetof(TiziArea_t, w) + a * 2u);
+        break;
+    case 'D':
+        *width = 4;
+        if (l->nidx == 1 && a < TIZI_IMG_D) return (long)(offsetof(TiziArea_t, d) + a * 4u);
+        break;
+    case 'L':
+        *width = 8;
+        if (l->nidx == 1 && a < TIZI_IMG_L) return (long)(offsetof(TiziArea_t, l) + a * 8u);
+        break;
+    }
+    return -1;
+}
+
+static TiziImage_t *image_map(const char *name) {
+    TiziImage_t *img = MAP_FAILED;
+    int fd = shm_open(name, O_RDWR | O_CREAT, 0660);
+    if (fd >= 0) {
+        if (ftruncate(fd, sizeof(TiziImage_t)) == 0)
+            img = (TiziImage_t *)mmap(0, sizeof(TiziImage_t), PROT_READ | PROT_WRITE,
+                                      MAP_SHARED, fd, 0);
+        close(fd);
+    }
+    if (img == MAP_FAILED) {
+        perror("tizi: shm_open/mmap");
+        fprintf(stderr, "tizi: %s unavailable, using a process-local image\n", name);
+        return &s_local_image;
+    }
+    return img;
+}
+
+/* 映射过程映像并把 located 指针指向其中；须在 config_init__() 之前调用 */
+static void image_open(void) {
+    const char        *name = getenv("TIZI_SHM");
+    const LocatedVar_t *l;
+    TiziImage_t       *img;
+    TiziArea_t        *area;
+    unsigned           width;
+    long               off;
+
+    img = image_map(name && *name ? name : TIZI_IMAGE_NAME);
+    /* 布局一致则沿用（运行时重启时驱动可不停），否则重新初始化 */
+    if (img->magic != TIZI_IMAGE_MAGIC || img->version != TIZI_IMAGE_VERSION ||
+        img->size != sizeof(TiziImage_t)) {
+        memset(img, 0, sizeof(TiziImage_t));
+        img->version  = TIZI_IMAGE_VERSION;
+        img->size     = sizeof(TiziImage_t);
+        img->in_state = 1u;
+        img->in_front = 0u;
+        __atomic_store_n(&img->magic, TIZI_IMAGE_MAGIC, __ATOMIC_RELEASE);
+    }
+    img->owner_pid = (int32_t)getpid();
+    img->out_seq  &= ~1u;          /* 上次运行可能停在扫描中 */
+    s_img      = img;
+    s_in_front = img->in_front;
+
+    for (l = s_located; l->loc; l++) {
+        off = area_offset(l, &width);
+        if (off < 0 || (l->loc[0] != 'I' && l->loc[0] != 'Q' && l->loc[0] != 'M')) {
+            fprintf(stderr, "tizi: %%%s%u%s not in process image, kept private\n",
+                    l->loc, l->idx[0], l->nidx > 1 ? ".." : "");
+            continue;
+        }
+        area = l->loc[0] == 'I' ? &img->in : l->loc[0] == 'Q' ? &img->out : &img->mem;
+        *l->ptr = (char *)area + off;
+        if (l->loc[0] == 'I') {
+            s_in_off[s_in_count]   = (unsigned)off;
+            s_in_width[s_in_count] = width;
+            s_in_count++;
+        }
+    }
+}
+
+static void image_scan_begin(void) {
+    TiziImage_t *img = s_img;
+    const char  *src;
+    char        *dst;
+    unsigned     i;
+
+    if (__atomic_load_n(&img->in_state, __ATOMIC_ACQUIRE) & TIZI_IN_NEW) {
+        s_in_front = __atomic_exchange_n(&img->in_state, s_in_front, __ATOMIC_ACQ_REL) & 3u;
+        __atomic_store_n(&img->in_front, s_in_front, __ATOMIC_RELEASE);
+        src = (const char *)&img->in_buf[s_in_front];
+        dst = (char *)&img->in;
+        for (i = 0; i < s_in_count; i++)
+            memcpy(dst + s_in_off[i], src + s_in_off[i], s_in_width[i]);
+    }
+    /* seqlock 写端：置奇数后再改 %Q / %M */
+    __atomic_store_n(&img->out_seq, img->out_seq + 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void image_scan_end(void) {
+    __atomic_store_n(&s_img->out_seq, s_img->out_seq + 1u, __ATOMIC_RELEASE);
+    s_img->scan_count++;
+}
+
+/* ─────────────────────────────────────────────────────────────
+ * 扫描调度：绝对截止时间
+ *   deadline[k] = t0 + k * period，用 clock_nanosleep(TIMER_ABSTIME)
+ *   睡到该时刻；扫描自身耗时和调度延迟不会累积成漂移。
+ *
+ * 超时（扫描结束时已过下一截止时间）策略，环境变量 TIZI_OVERRUN 覆盖：
+ *   skip    — 丢弃已错过的周期，对齐到下一个未来的截止时间（默认）
+ *   catchup — 逐个补跑已错过的周期；落后超过 CATCHUP_MAX 个周期时按 skip 重新对齐
+ *
+ * 统计：kill -USR1 <pid> 输出到 stderr；设置 TIZI_STATS_SOCKET=<path>
+ * 时另在该 Unix 域套接字上应答（连接即返回一份文本，如 socat - UNIX:<path>）。
+ * ───────────────────────────────────────────────────────────── */
+#define OVERRUN_SKIP     0
+#define OVERRUN_CATCHUP  1
+#ifndef TIZI_OVERRUN_POLICY
+#define TIZI_OVERRUN_POLICY  OVERRUN_SKIP
+#endif
+#define CATCHUP_MAX      8
+#define STATS_POLL_NS    100000000LL   /* 统计套接字轮询间隔 100 ms */
+
+/* ─────────────────────────────────────────────────────────────
+ * 实时加固（driver.json compiler.ncc.defines 中 TIZI_RT 置 true 开启）
+ *   1. mlockall(MCL_CURRENT|MCL_FUTURE)：matiec 全局变量所在的 .data/.bss、
+ *      代码段及之后的映射全部调入并锁定；malloc 不再 mmap / 归还内存
+ *   2. 预触 TIZI_RT_PREFAULT_KB 的栈
+ *   3. 绑定到 TIZI_RT_CPU（-1 = 不绑定）
+ *   4. SCHED_FIFO，优先级 TIZI_RT_PRIORITY
+ * 以上完成后扫描期间不应再有缺页，统计中的 page_faults 用于确认。
+ * 权限不足（无 CAP_SYS_NICE / CAP_IPC_LOCK）时打印警告并继续运行。
+ * ───────────────────────────────────────────────────────────── */
+#ifndef TIZI_RT
+#define TIZI_RT              0
+#endif
+#ifndef TIZI_RT_PRIORITY
+#define TIZI_RT_PRIORITY     80
+#endif
+#ifndef TIZI_RT_CPU
+#define TIZI_RT_CPU          -1
+#endif
+#ifndef TIZI_RT_PREFAULT_KB
+#define TIZI_RT_PREFAULT_KB  256
+#endif
+
+static long s_faults_base;
+
+static long page_faults(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_minflt + ru.ru_majflt;
+}
+
+#if TIZI_RT
+static void __attribute__((noinline)) prefault_stack(void) {
+    volatile unsigned char buf[TIZI_RT_PREFAULT_KB * 1024];
+    size_t i;
+    for (i = 0; i < sizeof(buf); i += 4096)
+        buf[i] = 0;
+}
+#endif
+
+/* 以下两项在 Linux 上只作用于调用线程 */
+static void set_affinity(int cpu) {
+    /* 直接走系统调用：cpu_set_t 宏需要 _GNU_SOURCE，而 time.h 已被 -include 先行引入 */
+    unsigned long mask[16];
+    if (cpu < 0 || cpu >= (int)(sizeof(mask) * 8)) return;
+    memset(mask, 0, sizeof(mask));
+    mask[cpu / (8 * sizeof(long))] |= 1UL << (cpu % (8 * sizeof(long)));
+    if (syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask) != 0)
+        perror("tizi-rt: sched_setaffinity");
+}
+
+#if TIZI_RT
+static void set_sched(int policy, int prio) {
+    struct sched_param sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = prio;
+    if (sched_setscheduler(0, policy, &sp) != 0)
+        perror("tizi-rt: sched_setscheduler");
+}
+#endif
+
+static void rt_setup(void) {
+#if TIZI_RT
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        perror("tizi-rt: mlockall");
+    prefault_stack();
+    set_affinity(TIZI_RT_CPU);
+    set_sched(SCHED_FIFO, TIZI_RT_PRIORITY);
+#endif
+    s_faults_base = page_faults();
+}
+
+typedef struct {
+    uint64_t cycles;
+    uint64_t overruns;     /* 扫描结束时已错过下一截止时间的次数 */
+    uint64_t skipped;      /* 被丢弃的周期数 */
+    int64_t  lat_min;      /* 唤醒延迟 = 实际唤醒 - 截止时间（ns） */
+    int64_t  lat_max;
+    int64_t  lat_sum;
+    int64_t  exec_max;     /* 扫描执行时间（ns） */
+    int64_t  exec_sum;
+    int64_t  jitter_max;   /* |相邻两次唤醒间隔 - 周期| 的最大值（ns） */
+} ScanStats;
+
+/* 一个调度单元：单任务模式下为 config_run__，多任务模式下每个 IEC TASK 一个 */
+typedef struct {
+    void      (*run)(unsigned long tick);
+    int64_t     period_ns;
+    int         iec_prio;  /* IEC PRIORITY，0 最高 */
+    int         cpu;       /* -1 = 不单独绑定 */
+    ScanStats   stats;
+} ScanTask;
+
+static int64_t   s_period_ns;
+static int       s_policy = TIZI_OVERRUN_POLICY;
+static int       s_stats_fd = -1;
+static volatile sig_atomic_t s_dump_req;
+
+static int64_t now_ns(void) {
     struct timespec ts;
     clock_gettime(CLOCK_MONOTONIC, &ts);
-    __CURRENT_TIME.tv_sec  = ts.tv_sec;
-    __CURRENT_TIME.tv_nsec = ts.tv_nsec;
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_until(int64_t t) {
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(t / 1000000000LL);
+    ts.tv_nsec = (long)(t % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+static void update_time(int64_t t) {
+    __CURRENT_TIME.tv_sec  = (long)(t / 1000000000LL);
+    __CURRENT_TIME.tv_nsec = (long)(t % 1000000000LL);
+}
+
+static void stats_cycle(ScanStats* s, int64_t lat, int64_t exec, int64_t jitter) {
+    if (jitter < 0) jitter = -jitter;
+    if (s->cycles == 0 || lat < s->lat_min) s->lat_min = lat;
+    if (lat > s->lat_max)       s->lat_max = lat;
+    if (exec > s->exec_max)     s->exec_max = exec;
+    if (jitter > s->jitter_max) s->jitter_max = jitter;
+    s->lat_sum  += lat;
+    s->exec_sum += exec;
+    s->cycles++;
+}
+
+/* ─────────────────────────────────────────────────────────────
+ * 多任务（tizi_tasks.h 中 TIZI_TASK_COUNT > 0）
+ *   每个 IEC TASK 一个线程，按各自 INTERVAL 走绝对截止时间调度。
+ *   TIZI_RT 开启时 SCHED_FIFO 优先级 = TIZI_RT_PRIORITY - PRIORITY（至少 1）；
+ *   TIZI_TASK_CPUS（define 或同名环境变量，如 "2,3,-1"）按任务顺序指定绑定的 CPU；
+ *   未指定（或 -1）的任务线程在 TIZI_RT 开启时显式绑定到 TIZI_RT_CPU，
+ *   不依赖从主线程继承的亲和性。
+ *
+ * 一致性模型（TIZI_TASK_PARALLEL）：
+ *   0（默认）任务体之间互斥（优先级继承锁）。全局变量与过程映像只在任务边界
+ *     交接：任务开始时看到此前已完成任务的全部写入，执行期间不受其他任务影响。
+ *     高优先级任务最多被一个正在执行的低优先级任务体阻塞。
+ *   1 任务体在各自核上并行执行，不加锁；仅适用于任务之间不共享全局变量的程序。
+ *   两种模式下 %I 都只在没有任务体执行时更新，%Q / %M 的 seqlock 在
+ *   第一个任务进入时置奇数、最后一个任务退出时置偶数。
+ * ───────────────────────────────────────────────────────────── */
+#ifndef TIZI_TASK_PARALLEL
+#define TIZI_TASK_PARALLEL  0
+#endif
+#ifndef TIZI_TASK_CPUS
+#define TIZI_TASK_CPUS
+#endif
+#define TIZI_STR_(...)  #__VA_ARGS__
+#define TIZI_STR(...)   TIZI_STR_(__VA_ARGS__)
+#define TASK_STACK_SIZE (512 * 1024)
+
+#if TIZI_TASK_COUNT > 0
+#define TIZI_TASK_RUN(body, ms, prio) \
+    static void body##_run(unsigned long tick) { (void)tick; body(); }
+TIZI_TASK_LIST(TIZI_TASK_RUN)
+
+#define TIZI_TASK_DESC(body, ms, prio) \
+    { .run = body##_run, .period_ns = (ms) * 1000000LL, .iec_prio = (prio), .cpu = -1 },
+static ScanTask s_scan[TIZI_TASK_COUNT] = {
+    TIZI_TASK_LIST(TIZI_TASK_DESC)
+};
+#else
+static void config_run(unsigned long tick) { config_run__(tick); }
+static ScanTask s_scan[1] = { { .run = config_run, .period_ns = 0, .iec_prio = 0, .cpu = -1 } };
+#endif
+#define SCAN_COUNT  (sizeof(s_scan) / sizeof(s_scan[0]))
+
+static pthread_mutex_t s_task_lock;   /* TIZI_TASK_PARALLEL == 0 时串行化任务体 */
+static pthread_mutex_t s_img_lock;    /* 保护 s_active 与映像边界操作 */
+static int             s_active;      /* 正在执行的任务体个数 */
+
+static void task_locks_init(void) {
+    pthread_mutexattr_t a;
+    pthread_mutexattr_init(&a);
+    pthread_mutexattr_setprotocol(&a, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&s_task_lock, &a);
+    pthread_mutex_init(&s_img_lock, &a);
+    pthread_mutexattr_destroy(&a);
 }
 
-int main(void) {
+static void task_begin(void) {
+    if (SCAN_COUNT > 1 && !TIZI_TASK_PARALLEL) pthread_mutex_lock(&s_task_lock);
+    if (SCAN_COUNT > 1) pthread_mutex_lock(&s_img_lock);
+    if (s_active++ == 0) image_scan_begin();
+    update_time(now_ns());
+    if (SCAN_COUNT > 1) pthread_mutex_unlock(&s_img_lock);
+}
+
+static void task_end(void) {
+    if (SCAN_COUNT > 1) pthread_mutex_lock(&s_img_lock);
+    if (--s_active == 0) image_scan_end();
+    if (SCAN_COUNT > 1) pthread_mutex_unlock(&s_img_lock);
+    if (SCAN_COUNT > 1 && !TIZI_TASK_PARALLEL) pthread_mutex_unlock(&s_task_lock);
+}
+
+/* TIZI_TASK_CPUS：逗号分隔，按任务顺序；缺省或 -1 的任务由 task_thread 退回 TIZI_RT_CPU */
+static void task_cpus_parse(void) {
+    const char *p = getenv("TIZI_TASK_CPUS");
+    char       *end;
+    unsigned    i;
+    long        v;
+    if (!p) p = TIZI_STR(TIZI_TASK_CPUS);
+    for (i = 0; i < SCAN_COUNT && *p; i++) {
+        v = strtol(p, &end, 10);
+        if (end == p) break;
+        s_scan[i].cpu = (int)v;
+        p = end;
+        if (*p == ',') p++;
+    }
+}
+
+#if TIZI_RT
+static int task_rt_prio(const ScanTask* t) {
+    const int prio = TIZI_RT_PRIORITY - t->iec_prio;
+    return prio < 1 ? 1 : prio;
+}
+#endif
+
+static int stats_format(char* buf, size_t size) {
+    size_t   len;
+    unsigned i;
+    int      r;
+
+    r = snprintf(buf, size, "tasks=%u policy=%s rt=%d parallel=%d page_faults=%ld\n",
+                 (unsigned)SCAN_COUNT, s_policy == OVERRUN_CATCHUP ? "catchup" : "skip",
+                 TIZI_RT, SCAN_COUNT > 1 && TIZI_TASK_PARALLEL,
+                 page_faults() - s_faults_base);
+    if (r < 0) return r;
+    len = (size_t)r;
+    for (i = 0; i < SCAN_COUNT && len < size; i++) {
+        const ScanStats* s = &s_scan[i].stats;
+        const int64_t n = s->cycles ? (int64_t)s->cycles : 1;
+        r = snprintf(buf + len, size - len,
+            "[%u] period_us=%lld cycles=%llu overruns=%llu skipped=%llu\n"
+            "[%u] latency_us min=%lld avg=%lld max=%lld\n"
+            "[%u] exec_us avg=%lld max=%lld jitter_us max=%lld\n",
+            i, (long long)(s_scan[i].period_ns / 1000),
+            (unsigned long long)s->cycles, (unsigned long long)s->overruns,
+            (unsigned long long)s->skipped,
+            i, (long long)(s->lat_min / 1000), (long long)(s->lat_sum / n / 1000),
+            (long long)(s->lat_max / 1000),
+            i, (long long)(s->exec_sum / n / 1000), (long long)(s->exec_max / 1000),
+            (long long)(s->jitter_max / 1000));
+        if (r < 0) return r;
+        len += (size_t)r;
+    }
+    return (int)(len < size ? len : size - 1);
+}
+
+static void on_sigusr1(int sig) {
+    (void)sig;
+    s_dump_req = 1;
+}
+
+static void stats_open_socket(const char* path) {
+    struct sockaddr_un addr;
+    int fd;
+    if (!path || !*path || strlen(path) >= sizeof(addr.sun_path)) return;
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 4) < 0) {
+        close(fd);
+        return;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    s_stats_fd = fd;
+}
+
+/* 扫描间隙调用：处理 SIGUSR1 请求和待应答的套接字连接（均不阻塞） */
+static void stats_service(void) {
+    char buf[4096];
+    int  len, c;
+    if (s_dump_req) {
+        s_dump_req = 0;
+        len = stats_format(buf, sizeof(buf));
+        if (len > 0) write(STDERR_FILENO, buf, (size_t)len);
+    }
+    if (s_stats_fd < 0) return;
+    while ((c = accept(s_stats_fd, NULL, NULL)) >= 0) {
+        len = stats_format(buf, sizeof(buf));
+        if (len > 0) send(c, buf, (size_t)len, MSG_NOSIGNAL);
+        close(c);
+    }
+}
+
+/* ─────────────────────────────────────────────────────────────
+ * 自测：plc_program --bench [秒] [周期us]
+ * 与 cyclictest 相同，按绝对截止时间空转（不执行 PLC 逻辑），
+ * 统计唤醒延迟分布，用于确认本机在当前 RT 配置下的最坏延迟。
+ * ───────────────────────────────────────────────────────────── */
+#define BENCH_BUCKETS  1000            /* 1 us 一格，>= 1000 us 计入溢出 */
+
+static uint64_t s_hist[BENCH_BUCKETS + 1];
+
+static int64_t hist_percentile(uint64_t total, double p) {
+    const uint64_t want = (uint64_t)((double)total * p);
+    uint64_t acc = 0;
+    int i;
+    for (i = 0; i <= BENCH_BUCKETS; i++) {
+        acc += s_hist[i];
+        if (acc > want) return i;
+    }
+    return BENCH_BUCKETS;
+}
+
+static int run_bench(int seconds, int64_t period) {
+    int64_t  t0, deadline, lat, lat_min = 0, lat_max = 0, lat_sum = 0;
+    uint64_t i, loops = (uint64_t)((int64_t)seconds * 1000000000LL / period);
+    long     faults;
+
+    if (loops == 0) loops = 1;
+    fprintf(stderr, "bench: %d s, period %lld us, rt=%d ...\n",
+            seconds, (long long)(period / 1000), TIZI_RT);
+    faults = page_faults();
+    t0 = now_ns() + period;
+    for (i = 0; i < loops; i++) {
+        deadline = t0 + (int64_t)i * period;
+        sleep_until(deadline);
+        lat = now_ns() - deadline;
+        if (i == 0 || lat < lat_min) lat_min = lat;
+        if (lat > lat_max) lat_max = lat;
+        lat_sum += lat;
+        s_hist[lat / 1000 < BENCH_BUCKETS ? lat / 1000 : BENCH_BUCKETS]++;
+    }
+    faults = page_faults() - faults;
+
+    printf("loops=%llu period_us=%lld rt=%d prio=%d cpu=%d page_faults=%ld\n"
+           "latency_us min=%lld avg=%lld max=%lld\n"
+           "latency_us p99=%lld p99.9=%lld p99.99=%lld over_%dus=%llu\n",
+           (unsigned long long)loops, (long long)(period / 1000), TIZI_RT,
+           TIZI_RT ? TIZI_RT_PRIORITY : 0, TIZI_RT ? TIZI_RT_CPU : -1, faults,
+           (long long)(lat_min / 1000), (long long)(lat_sum / (int64_t)loops / 1000),
+           (long long)(lat_max / 1000),
+           (long long)hist_percentile(loops, 0.99),
+           (long long)hist_percentile(loops, 0.999),
+           (long long)hist_percentile(loops, 0.9999),
+           BENCH_BUCKETS, (unsigned long long)s_hist[BENCH_BUCKETS]);
+    return 0;
+}
+
+/* 一个调度单元的扫描循环（deadline[k] = t0 + k * period）；service 非 0 时在扫描间隙处理统计请求 */
+static void scan_loop(ScanTask* t, int service) {
+    const int64_t period = t->period_ns;
+    int64_t  t0, deadline, next, wake, end, prev_wake = 0, next_poll;
+    uint64_t k = 0;
+
+    t0 = now_ns();
+    next_poll = t0;
+    for (;;) {
+        deadline = t0 + (int64_t)k * period;
+        sleep_until(deadline);
+        wake = now_ns();
+        task_begin();
+        /* tick 即截止时间序号：skip 后 matiec 的多速率任务仍与时间对齐 */
+        t->run((unsigned long)k);
+        task_end();
+        end = now_ns();
+
+        stats_cycle(&t->stats, wake - deadline, end - wake,
+                    prev_wake ? (wake - prev_wake) - period : 0);
+        prev_wake = wake;
+
+        k++;
+        next = t0 + (int64_t)k * period;
+        if (end > next) {
+            /* 已错过的截止时间个数（含 next），跳过后 deadline[k] > end */
+            const int64_t behind = (end - next) / period + 1;
+            t->stats.overruns++;
+            if (s_policy == OVERRUN_SKIP || behind > CATCHUP_MAX) {
+                k += (uint64_t)behind;
+                t->stats.skipped += (uint64_t)behind;
+            }
+        }
+
+        if (service && (s_dump_req || (s_stats_fd >= 0 && end >= next_poll))) {
+            stats_service();
+            next_poll = end + STATS_POLL_NS;
+        }
+    }
+}
+
+static void *task_thread(void* arg) {
+    ScanTask* t = (ScanTask*)arg;
+    set_affinity(t->cpu >= 0 ? t->cpu : (TIZI_RT ? TIZI_RT_CPU : -1));
+#if TIZI_RT
+    set_sched(SCHED_FIFO, task_rt_prio(t));
+#endif
+    scan_loop(t, 0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* env;
+    unsigned    i;
+
+    s_period_ns = (int64_t)common_ticktime__;
+    if (s_period_ns <= 0) s_period_ns = 10000000LL;
+
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        const int     seconds = argc > 2 ? atoi(argv[2]) : 10;
+        const int64_t us      = argc > 3 ? atoll(argv[3]) : 0;
+        rt_setup();
+        return run_bench(seconds > 0 ? seconds : 10, us > 0 ? us * 1000 : s_period_ns);
+    }
+
+    image_open();
     config_init__();
-    unsigned int tick_us = (unsigned int)(common_ticktime__ / 1000ULL);
-    if (tick_us == 0) tick_us = 10000;
-    unsigned long tick = 0;
+    rt_setup();
+
+    env = getenv("TIZI_OVERRUN");
+    if (env && strcmp(env, "catchup") == 0) s_policy = OVERRUN_CATCHUP;
+    if (env && strcmp(env, "skip") == 0)    s_policy = OVERRUN_SKIP;
+    signal(SIGUSR1, on_sigusr1);
+    stats_open_socket(getenv("TIZI_STATS_SOCKET"));
+
+    if (SCAN_COUNT == 1 && TIZI_TASK_COUNT == 0) {
+        s_scan[0].period_ns = s_period_ns;
+        scan_loop(&s_scan[0], 1);
+        return 0;
+    }
+
+    /* 多任务：每个 IEC TASK 一个线程，主线程降为普通优先级只处理统计请求 */
+    task_locks_init();
+    task_cpus_parse();
+    for (i = 0; i < SCAN_COUNT; i++) {
+        pthread_attr_t attr;
+        pthread_t      th;
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, TASK_STACK_SIZE);
+        if (pthread_create(&th, &attr, task_thread, &s_scan[i]) != 0) {
+            perror("tizi: pthread_create");
+            return 1;
+        }
+        pthread_attr_destroy(&attr);
+    }
+#if TIZI_RT
+    set_sched(SCHED_OTHER, 0);
+#endif
     for (;;) {
-        update_time();
-        config_run__(tick++);
-        usleep(tick_us);
+        sleep_until(now_ns() + STATS_POLL_NS);
+        stats_service();
     }
     return 0;
 }
@@ -5,6 +5,12 @@
  * Exports:
  *   plc_init()      -- called once at PLC startup
  *   plc_run(ms)     -- called every scan cycle; ms = host time in milliseconds
+ *   plc_image()     -- linear-memory offset of the process image (PlcImage_t)
+ *
+ * Process image: located variables point straight into s_image, so the
+ * program reads and writes it with plain loads/stores. The host resolves
+ * plc_image() once, writes %I before plc_run and reads %Q after it --
+ * no host-function call per variable.
  */
 #include <stdint.h>
 #include "iec_std_lib.h"
@@ -16,10 +22,84 @@ BOOL __DEBUG = 0;
 extern void config_init__(void);
 extern void config_run__(unsigned long tick);
 
+/* Process image layout, mirrored by the host (runtime/app/xcode_runner.c,
+ * tools/xcode_host.c). BOOL takes one byte, as in matiec:
+ *   %IXa.b -> ix[a*8+b]   %QXa.b -> qx[a*8+b]
+ *   %IWa   -> iw[a]       %QWa   -> qw[a]
+ * Other locations (%M, %IB, %ID, out-of-range ...) keep private storage. */
+#define PLC_IMAGE_MAGIC    0x58494D47u   /* "XIMG" */
+#define PLC_IMAGE_VERSION  1u
+#define PLC_IMAGE_X        256u          /* %IX0.0 .. %IX31.7 */
+#define PLC_IMAGE_W        64u
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;       /* sizeof(PlcImage_t); host checks the layout with it */
+    uint32_t reserved;
+    uint8_t  ix[PLC_IMAGE_X];
+    uint8_t  qx[PLC_IMAGE_X];
+    uint16_t iw[PLC_IMAGE_W];
+    uint16_t qw[PLC_IMAGE_W];
+} PlcImage_t;
+
+static PlcImage_t s_image = { PLC_IMAGE_MAGIC, PLC_IMAGE_VERSION, sizeof(PlcImage_t), 0u };
+
+/* matiec located variables: storage + the pointers referenced by POUs.
+ * plc_init() repoints the ones covered by the image before config_init__()
+ * copies them into the POU instances. */
+#define __LOCATED_VAR(type, name, ...) type __##name;
+#include "LOCATED_VARIABLES.h"
+#undef __LOCATED_VAR
+#define __LOCATED_VAR(type, name, ...) type *name = &__##name;
+#include "LOCATED_VARIABLES.h"
+#undef __LOCATED_VAR
+
+typedef struct {
+    const char           *loc;   /* "IX", "QW", "MD", ... */
+    const unsigned short *idx;   /* location indices, e.g. {0, 3} for %IX0.3 */
+    unsigned              nidx;
+    void                **ptr;   /* matiec located pointer */
+} LocatedVar_t;
+
+#define __LOCATED_VAR(type, name, dir, size, ...) \
+    static const unsigned short name##_idx[] = { __VA_ARGS__ };
+#include "LOCATED_VARIABLES.h"
+#undef __LOCATED_VAR
+#define __LOCATED_VAR(type, name, dir, size, ...) \
+    { #dir #size, name##_idx, sizeof(name##_idx) / sizeof(name##_idx[0]), (void **)&name },
+static const LocatedVar_t s_located[] = {
+#include "LOCATED_VARIABLES.h"
+    { 0, 0, 0, 0 }
+};
+#undef __LOCATED_VAR
+
+/* Image cell for a located variable, 0 if the image does not cover it */
+static void *image_cell(const LocatedVar_t *l) {
+    const unsigned a  = l->idx[0];
+    const int      in = l->loc[0] == 'I';
+    if (!in && l->loc[0] != 'Q') return 0;
+    switch (l->loc[1]) {
+    case 'X':
+        if (l->nidx == 2 && l->idx[1] < 8u && a * 8u + l->idx[1] < PLC_IMAGE_X)
+            return (in ? s_image.ix : s_image.qx) + a * 8u + l->idx[1];
+        break;
+    case 'W':
+        if (l->nidx == 1 && a < PLC_IMAGE_W)
+            return (in ? s_image.iw : s_image.qw) + a;
+        break;
+    }
+    return 0;
+}
+
 static unsigned long s_tick = 0;
 
 __attribute__((visibility("default")))
 void plc_init(void) {
+    const LocatedVar_t *l;
+    void               *cell;
+    for (l = s_located; l->loc; l++)
+        if ((cell = image_cell(l)) != 0) *l->ptr = cell;
     config_init__();
 }
 
@@ -29,3 +109,8 @@ void plc_run(uint32_t ms) {
     __CURRENT_TIME.tv_nsec = (long)((ms % 1000u) * 1000000u);
     config_run__(s_tick++);
 }
+
+__attribute__((visibility("default")))
+uint32_t plc_image(void) {
+    return (uint32_t)(uintptr_t)&s_image;
+}
@@ -30,11 +30,27 @@
 #define USER_FLASH_SECTOR_START  16u
 #define USER_FLASH_SECTOR_END    31u
 
+/* -----------------------------------------------------------------------
+ * B 区指纹尾页 — B 区最后 256 字节不属于用户映像，由 Runtime A 在下载校验
+ * 通过后写入映像长度与 CRC-32，上位机据此判断是否需要重新下载
+ * -----------------------------------------------------------------------*/
+#define USER_TRAILER_SIZE        256u
+#define USER_TRAILER_ADDR        (USER_FLASH_BASE + USER_FLASH_SIZE - USER_TRAILER_SIZE)
+#define USER_IMAGE_MAX_SIZE      (USER_FLASH_SIZE - USER_TRAILER_SIZE)
+#define USER_TRAILER_MAGIC       0x50524E46u   /* "FNRP" */
+
+typedef struct {
+    uint32_t magic;          /* USER_TRAILER_MAGIC */
+    uint32_t length;         /* 映像字节数（自 USER_FLASH_BASE 起，按页补齐）*/
+    uint32_t crc32;          /* 映像 CRC-32/IEEE */
+} UserTrailer_t;
+
 /* -----------------------------------------------------------------------
  * 接口版本与魔数
  * -----------------------------------------------------------------------*/
 #define USER_LOGIC_MAGIC    0xDEADBEEFu
-#define USER_LOGIC_VERSION  1u
+#define USER_LOGIC_VERSION  2u     /* v2: 增加多任务表 task_count / tasks */
+#define USER_MAX_TASKS      4u     /* Runtime A 支持的最大任务数 */
 
 /* -----------------------------------------------------------------------
  * PLC I/O 配置
@@ -46,6 +62,16 @@
 #define PLC_DI_BASE_PIN  16u
 #define PLC_DO_BASE_PIN  12u
 
+/* -----------------------------------------------------------------------
+ * 过程映像 — 每次任务执行前 Runtime 一次读端口锁存全部 DI，
+ * 执行后一次屏蔽写端口输出全部 DO；一次扫描内 I/O 状态一致
+ * 位 i 对应 DIi / DOi
+ * -----------------------------------------------------------------------*/
+typedef struct {
+    uint32_t inputs;         /* 输入映像（只读）*/
+    uint32_t outputs;        /* 输出映像（扫描后写到端口）*/
+} ProcessImage_t;
+
 /* -----------------------------------------------------------------------
  * System API — Runtime 提供给 UserLogic 的系统服务函数表
  * UserLogic 只调用这些函数，不链接 Runtime 的任何符号
@@ -55,8 +81,19 @@ typedef struct {
     void     (*uart_puts)(const char *s);            /* 输出字符串到 UART */
     void     (*set_do)(uint8_t idx, bool val);       /* 写数字输出 */
     bool     (*get_di)(uint8_t idx);                 /* 读数字输入 */
+    ProcessImage_t *image;                           /* 过程映像（set_do/get_di 也读写此映像）*/
 } SystemAPI_t;
 
+/* -----------------------------------------------------------------------
+ * 周期任务描述 — 对应 IEC 61131-3 的 TASK(INTERVAL, PRIORITY)
+ * -----------------------------------------------------------------------*/
+typedef struct {
+    void    (*run)(void);    /* 任务入口：执行该任务关联的全部 PROGRAM 实例 */
+    uint16_t period_ms;      /* 周期 ms，必须 > 0 */
+    uint8_t  priority;       /* 优先级，0 = 最高；多个任务同时就绪时先执行数值小的 */
+    uint8_t  reserved;
+} UserTask_t;
+
 /* -----------------------------------------------------------------------
  * UserLogic 接口表 — 必须放置在 USER_FLASH_BASE (0x00004000) 的最开头
  * -----------------------------------------------------------------------*/
@@ -68,6 +105,10 @@ typedef struct {
     uint8_t  di_count;       /* 用户逻辑期望的 DI 数量 */
     uint8_t  do_count;       /* 用户逻辑期望的 DO 数量 */
     uint16_t scan_ms;        /* 请求的扫描周期 ms，0 = 使用 Runtime 默认值 */
+    /* ---- version >= 2 ---- */
+    uint8_t  task_count;     /* tasks 表项数，0 = 单任务：按 scan_ms 周期调用 loop() */
+    uint8_t  reserved[3];
+    const UserTask_t *tasks; /* 周期任务表（task_count > 0 时 loop 不再被调用）*/
 } UserLogic_t;
 
 #endif /* SHARED_INTERFACE_H */
@@ -3,6 +3,7 @@
 #include "shared_interface.h"
 #include "iec_std_lib.h"
 #include "config.h"
+#include "tizi_tasks.h"   /* TIZI_TASK_LIST / TIZI_TASK_COUNT, generated from IEC TASKs */
 
 /* matiec runtime globals required by iec_std_lib */
 TIME __CURRENT_TIME;
@@ -23,9 +24,62 @@ static void user_ram_init(void) {
     while (dst < &_ebss_b) *dst++ = 0u;
 }
 
+/* matiec located variables: storage + the pointers referenced by POUs */
+#define __LOCATED_VAR(type, name, ...) type __##name;
+#include "LOCATED_VARIABLES.h"
+#undef __LOCATED_VAR
+#define __LOCATED_VAR(type, name, ...) type *name = &__##name;
+#include "LOCATED_VARIABLES.h"
+#undef __LOCATED_VAR
+
+/* Bit locations bound to the Runtime A process image:
+ *   %IX0.n <- image->inputs bit n,  %QX0.n -> image->outputs bit n
+ * Other locations (including single-index %IX0 / %QX0) keep plain
+ * storage only.                                                      */
+typedef struct {
+    const char           *loc;   /* "IX", "QX", "IW", ... */
+    const unsigned short *idx;   /* location indices, e.g. {0, 3} for %IX0.3 */
+    unsigned              nidx;
+    BOOL                 *var;
+} LocatedVar_t;
+
+#define __LOCATED_VAR(type, name, dir, size, ...) \
+    static const unsigned short name##_idx[] = { __VA_ARGS__ };
+#include "LOCATED_VARIABLES.h"
+#undef __LOCATED_VAR
+#define __LOCATED_VAR(type, name, dir, size, ...) \
+    { #dir #size, name##_idx, sizeof(name##_idx) / sizeof(name##_idx[0]), (BOOL *)&__##name },
+static const LocatedVar_t s_located[] = {
+#include "LOCATED_VARIABLES.h"
+    { 0, 0, 0, 0 }
+};
+#undef __LOCATED_VAR
+
 static const SystemAPI_t *g_api  = 0;
 static unsigned long      s_tick = 0u;
 
+static int is_bit(const LocatedVar_t *l, char dir, unsigned count) {
+    return l->loc[0] == dir && l->loc[1] == 'X' && l->nidx == 2u &&
+           l->idx[0] == 0u && l->idx[1] < count;
+}
+
+static void image_in(void) {
+    unsigned int in = g_api->image->inputs;
+    for (const LocatedVar_t *l = s_located; l->loc; l++)
+        if (is_bit(l, 'I', PLC_DI_COUNT))
+            *l->var = (BOOL)((in >> l->idx[1]) & 1u);
+}
+
+static void image_out(void) {
+    unsigned int out = g_api->image->outputs;
+    for (const LocatedVar_t *l = s_located; l->loc; l++) {
+        if (!is_bit(l, 'Q', PLC_DO_COUNT)) continue;
+        if (*l->var) out |=  (1u << l->idx[1]);
+        else         out &= ~(1u << l->idx[1]);
+    }
+    g_api->image->outputs = out;
+}
+
 static void setup(const SystemAPI_t *api) {
     user_ram_init();
     g_api = api;
@@ -33,13 +87,35 @@ static void setup(const SystemAPI_t *api) {
     g_api->uart_puts("UserLogic B: PLC ready\r\n");
 }
 
-static void loop(void) {
+static void update_time(void) {
     unsigned int ms = g_api->get_tick_ms();
     __CURRENT_TIME.tv_sec  = (long)(ms / 1000u);
     __CURRENT_TIME.tv_nsec = (long)((ms % 1000u) * 1000000u);
+}
+
+/* Single-task fallback: run every resource once per Runtime A scan */
+static void loop(void) {
+    update_time();
+    image_in();
     config_run__(s_tick++);
+    image_out();
 }
 
+#if TIZI_TASK_COUNT > 0
+#if TIZI_TASK_COUNT > USER_MAX_TASKS
+#error "too many IEC tasks for Runtime A (USER_MAX_TASKS)"
+#endif
+/* One Runtime A task per IEC TASK, scheduled by period/priority */
+#define TIZI_TASK_ENTRY(body, ms, prio) \
+    static void body##_entry(void) { update_time(); image_in(); body(); image_out(); }
+TIZI_TASK_LIST(TIZI_TASK_ENTRY)
+
+#define TIZI_TASK_DESC(body, ms, prio) { body##_entry, (ms), (prio), 0u },
+static const UserTask_t s_tasks[TIZI_TASK_COUNT] = {
+    TIZI_TASK_LIST(TIZI_TASK_DESC)
+};
+#endif
+
 /* Interface table: MUST be first in .user_header section at 0x00004000 */
 const UserLogic_t user_api __attribute__((section(".user_header"))) = {
     .magic    = USER_LOGIC_MAGIC,
@@ -49,4 +125,8 @@ const UserLogic_t user_api __attribute__((section(".user_header"))) = {
     .di_count = PLC_DI_COUNT,
     .do_count = PLC_DO_COUNT,
     .scan_ms  = 0u,   /* 0 = use Runtime A default scan period */
+#if TIZI_TASK_COUNT > 0
+    .task_count = TIZI_TASK_COUNT,
+    .tasks      = s_tasks,
+#endif
 };
@@ -3,7 +3,8 @@
  *
  * 功能：
  *   - 硬件初始化（GPIO、UART、SysTick）
- *   - PLC 周期扫描（默认 10ms 一次）
+ *   - PLC 周期扫描（默认 10ms 一次；v2 接口表可声明多个不同周期的任务，见 scheduler.c）
+ *   - 过程映像 I/O：任务执行前一次读端口锁存 DI，执行后一次屏蔽写端口输出 DO
  *   - 通过 UART 接收上位机的下载/控制命令
  *   - 加载并调用 B 区（USER_FLASH_BASE）的用户逻辑
  *
@@ -25,6 +26,13 @@
  * -----------------------------------------------------------------------*/
 #define TICKRATE_HZ         1000u  /* SysTick 频率：1kHz → 1ms 分辨率 */
 #define DEFAULT_SCAN_MS     10u    /* 默认扫描周期 10ms */
+#define UART_RX_BATCH       32u    /* 每批从 RX 缓冲取出的字节数 */
+#define UART_RX_BUDGET_US   200u   /* 每轮主循环解析 UART 的时间预算，超出即让出给扫描 */
+
+/* 过程映像位 ↔ 端口引脚 */
+#define PLC_DI_BITS         ((1u << PLC_DI_COUNT) - 1u)
+#define PLC_DO_BITS         ((1u << PLC_DO_COUNT) - 1u)
+#define PLC_DO_PORT_MASK    (PLC_DO_BITS << PLC_DO_BASE_PIN)
 
 /* -----------------------------------------------------------------------
  * 共享状态（runtime.c 也访问这些变量）
@@ -37,8 +45,19 @@ volatile uint8_t  plc_do_state      = 0u;
  * 内部状态
  * -----------------------------------------------------------------------*/
 static volatile uint32_t s_tick_ms    = 0u;
-static volatile bool     s_scan_flag  = false;
 static uint32_t          s_scan_ms    = DEFAULT_SCAN_MS;
+static ProcessImage_t    s_image;
+
+/* -----------------------------------------------------------------------
+ * 声明（scheduler.c 中实现）
+ * -----------------------------------------------------------------------*/
+bool     Sched_AddTask(void (*run)(void), uint16_t period_ms, uint8_t priority);
+uint8_t  Sched_TaskCount(void);
+uint16_t Sched_TaskPeriod(uint8_t idx);
+void     Sched_Tick(void);
+bool     Sched_Pending(void);
+void     Sched_RunNext(void);
+void     Sched_Discard(void);
 
 /* -----------------------------------------------------------------------
  * SysTick 中断处理
@@ -46,11 +65,17 @@ static uint32_t          s_scan_ms    = DEFAULT_SCAN_MS;
 void SysTick_Handler(void)
 {
     s_tick_ms++;
-    if ((s_tick_ms % s_scan_ms) == 0u) {
-        s_scan_flag = true;
-    }
+    Sched_Tick();
 }
 
+/* -----------------------------------------------------------------------
+ * 声明（uart_io.c 中实现）
+ * -----------------------------------------------------------------------*/
+void     UartIO_Init(void);
+uint16_t UartIO_Read(uint8_t *buf, uint16_t max);
+void     UartIO_PutChar(uint8_t ch);
+void     UartIO_PutStr(const char *s);
+
 /* -----------------------------------------------------------------------
  * System API 实现（提供给 UserLogic B 调用）
  * -----------------------------------------------------------------------*/
@@ -61,24 +86,24 @@ static uint32_t sapi_get_tick_ms(void)
 
 static void sapi_uart_puts(const char *s)
 {
-    Board_UARTPutSTR(s);
+    UartIO_PutStr(s);
 }
 
+/* set_do / get_di 只读写过程映像，端口访问集中在 plc_io_latch / plc_io_flush */
 static void sapi_set_do(uint8_t idx, bool val)
 {
     if (idx >= PLC_DO_COUNT) { return; }
-    Chip_GPIO_SetPinState(LPC_GPIO_PORT, 0u, (uint8_t)(PLC_DO_BASE_PIN + idx), val);
     if (val) {
-        plc_do_state |=  (uint8_t)(1u << idx);
+        s_image.outputs |=  (1u << idx);
     } else {
-        plc_do_state &= (uint8_t)~(1u << idx);
+        s_image.outputs &= ~(1u << idx);
     }
 }
 
 static bool sapi_get_di(uint8_t idx)
 {
     if (idx >= PLC_DI_COUNT) { return false; }
-    return Chip_GPIO_GetPinState(LPC_GPIO_PORT, 0u, (uint8_t)(PLC_DI_BASE_PIN + idx));
+    return ((s_image.inputs >> idx) & 1u) != 0u;
 }
 
 static const SystemAPI_t s_sapi = {
@@ -86,12 +111,21 @@ static const SystemAPI_t s_sapi = {
     .uart_puts   = sapi_uart_puts,
     .set_do      = sapi_set_do,
     .get_di      = sapi_get_di,
+    .image       = &s_image,
 };
 
 /* -----------------------------------------------------------------------
  * 声明（runtime.c 中实现）
  * -----------------------------------------------------------------------*/
 void Runtime_HandleUARTByte(uint8_t byte);
+void Runtime_Poll(void);
+
+/* -----------------------------------------------------------------------
+ * 声明（scan_timer.c 中实现）
+ * -----------------------------------------------------------------------*/
+void     ScanTimer_Init(uint32_t period_us);
+uint32_t ScanTimer_Now(void);
+uint32_t ScanTimer_ElapsedUs(uint32_t from, uint32_t to);
 
 /* -----------------------------------------------------------------------
  * XCODE 模式：xcode_runner.c 中实现
@@ -120,6 +154,24 @@ static void plc_gpio_init(void)
         Chip_GPIO_SetPinState(LPC_GPIO_PORT, 0u, pin, false);
         Chip_GPIO_SetPinDIROutput(LPC_GPIO_PORT, 0u, pin);
     }
+
+    /* 屏蔽寄存器：MPIN 写只影响 DO 引脚（MASK 位为 0 的引脚可写）*/
+    Chip_GPIO_SetPortMask(LPC_GPIO_PORT, 0u, ~PLC_DO_PORT_MASK);
+}
+
+/* -----------------------------------------------------------------------
+ * 过程映像：一次读端口锁存全部 DI / 一次屏蔽写端口输出全部 DO
+ * -----------------------------------------------------------------------*/
+static void plc_io_latch(void)
+{
+    s_image.inputs = (Chip_GPIO_GetPortValue(LPC_GPIO_PORT, 0u) >> PLC_DI_BASE_PIN) & PLC_DI_BITS;
+}
+
+static void plc_io_flush(void)
+{
+    uint32_t out = s_image.outputs & PLC_DO_BITS;
+    Chip_GPIO_SetMaskedPortValue(LPC_GPIO_PORT, 0u, out << PLC_DO_BASE_PIN);
+    plc_do_state = (uint8_t)out;
 }
 
 /* -----------------------------------------------------------------------
@@ -127,10 +179,26 @@ static void plc_gpio_init(void)
  * -----------------------------------------------------------------------*/
 static void plc_outputs_clear(void)
 {
-    for (uint8_t i = 0u; i < PLC_DO_COUNT; i++) {
-        sapi_set_do(i, false);
-    }
+    s_image.outputs = 0u;
+    plc_io_flush();
+}
+
+/* -----------------------------------------------------------------------
+ * 单任务入口（v1 接口表 / XCODE 模式）
+ * -----------------------------------------------------------------------*/
+#if defined(XCODE_MODE)
+static void plc_single_task(void)
+{
+    /* XCODE 模式：通过 WAMR 执行 plc_run(ms) */
+    xcode_runner_loop(s_tick_ms);
+}
+#else
+static void plc_single_task(void)
+{
+    /* NCC 模式：调用原生用户逻辑（魔数已由主循环校验）*/
+    ((const UserLogic_t *)USER_FLASH_BASE)->loop();
 }
+#endif
 
 /* -----------------------------------------------------------------------
  * 打印十进制数（不使用 printf/snprintf）
@@ -141,14 +209,14 @@ static void uart_put_u32(uint32_t val)
     int  idx = 11;
     buf[idx] = '\0';
     if (val == 0u) {
-        Board_UARTPutChar('0');
+        UartIO_PutChar('0');
         return;
     }
     while (val > 0u) {
         buf[--idx] = (char)('0' + (val % 10u));
         val /= 10u;
     }
-    Board_UARTPutSTR(&buf[idx]);
+    UartIO_PutStr(&buf[idx]);
 }
 
 /* -----------------------------------------------------------------------
@@ -158,88 +226,131 @@ int main(void)
 {
     SystemCoreClockUpdate();
     Board_Init();
+    UartIO_Init();
     plc_gpio_init();
 
-    Board_UARTPutSTR("\r\n=== TiZi PLC Runtime v1.0 ===\r\n");
-    Board_UARTPutSTR("build: " __DATE__ " " __TIME__ "\r\n");
-    Board_UARTPutSTR("Flash A: 0x00000000 (16KB)  RAM A: 0x10000000 (4KB)\r\n");
-    Board_UARTPutSTR("Flash B: 0x00004000 (16KB)  RAM B: 0x10001000 (4KB)\r\n");
+    UartIO_PutStr("\r\n=== TiZi PLC Runtime v1.0 ===\r\n");
+    UartIO_PutStr("build: " __DATE__ " " __TIME__ "\r\n");
+    UartIO_PutStr("Flash A: 0x00000000 (16KB)  RAM A: 0x10000000 (4KB)\r\n");
+    UartIO_PutStr("Flash B: 0x00004000 (16KB)  RAM B: 0x10001000 (4KB)\r\n");
 
 #if defined(XCODE_MODE)
     /* ---- XCODE 模式：加载 B 区 .wasm，通过 WAMR 执行 ---- */
-    Board_UARTPutSTR("Mode: XCODE (WASM/WAMR)\r\n");
+    UartIO_PutStr("Mode: XCODE (WASM/WAMR)\r\n");
     if (xcode_runner_init(&s_sapi)) {
         plc_running = true;
-        Board_UARTPutSTR("WASM PLC started. Scan period: ");
+        UartIO_PutStr("WASM PLC started. Scan period: ");
         uart_put_u32(s_scan_ms);
-        Board_UARTPutSTR(" ms\r\n");
+        UartIO_PutStr(" ms\r\n");
     } else {
-        Board_UARTPutSTR("No valid WASM in Flash B.\r\n");
-        Board_UARTPutSTR("Waiting for download via UART...\r\n");
+        UartIO_PutStr("No valid WASM in Flash B.\r\n");
+        UartIO_PutStr("Waiting for download via UART...\r\n");
     }
+    Sched_AddTask(plc_single_task, (uint16_t)s_scan_ms, 0u);
 #else
     /* ---- NCC 模式（默认）：读取 B 区原生 UserLogic_t 接口表 ---- */
-    Board_UARTPutSTR("Mode: NCC (native)\r\n");
+    UartIO_PutStr("Mode: NCC (native)\r\n");
     const UserLogic_t *user = (const UserLogic_t *)USER_FLASH_BASE;
 
     if (user->magic == USER_LOGIC_MAGIC) {
-        Board_UARTPutSTR("UserLogic found: version=");
+        UartIO_PutStr("UserLogic found: version=");
         uart_put_u32(user->version);
-        Board_UARTPutSTR("  DI=");
+        UartIO_PutStr("  DI=");
         uart_put_u32(user->di_count);
-        Board_UARTPutSTR("  DO=");
+        UartIO_PutStr("  DO=");
         uart_put_u32(user->do_count);
-        Board_UARTPutSTR("\r\n");
+        UartIO_PutStr("\r\n");
 
         /* 若用户逻辑指定了扫描周期，使用它 */
         if (user->scan_ms > 0u) {
             s_scan_ms = user->scan_ms;
         }
 
+        /* v2 接口表：按任务表注册多个周期任务 */
+        if (user->version >= 2u && user->task_count > 0u) {
+            for (uint8_t i = 0u; i < user->task_count; i++) {
+                const UserTask_t *t = &user->tasks[i];
+                if (!Sched_AddTask(t->run, t->period_ms, t->priority)) {
+                    UartIO_PutStr("Task table rejected: task ");
+                    uart_put_u32(i);
+                    UartIO_PutStr("\r\n");
+                }
+            }
+        }
+
         /* 调用用户初始化，传入 System API 表 */
         user->setup(&s_sapi);
 
         plc_running = true;
-        Board_UARTPutSTR("PLC started. Scan period: ");
-        uart_put_u32(s_scan_ms);
-        Board_UARTPutSTR(" ms\r\n");
+        if (Sched_TaskCount() > 0u) {
+            s_scan_ms = Sched_TaskPeriod(0u);
+            UartIO_PutStr("PLC started. Tasks: ");
+            uart_put_u32(Sched_TaskCount());
+            UartIO_PutStr("  period(ms):");
+            for (uint8_t i = 0u; i < Sched_TaskCount(); i++) {
+                UartIO_PutChar(' ');
+                uart_put_u32(Sched_TaskPeriod(i));
+            }
+            UartIO_PutStr("\r\n");
+        } else {
+            UartIO_PutStr("PLC started. Scan period: ");
+            uart_put_u32(s_scan_ms);
+            UartIO_PutStr(" ms\r\n");
+        }
     } else {
-        Board_UARTPutSTR("No UserLogic (magic mismatch).\r\n");
-        Board_UARTPutSTR("Waiting for download via UART...\r\n");
+        UartIO_PutStr("No UserLogic (magic mismatch).\r\n");
+        UartIO_PutStr("Waiting for download via UART...\r\n");
+    }
+
+    /* v1 接口表或尚无用户逻辑：单任务按 scan_ms 调用 loop() */
+    if (Sched_TaskCount() == 0u) {
+        Sched_AddTask(plc_single_task, (uint16_t)s_scan_ms, 0u);
     }
 #endif
 
-    /* --- 启动 SysTick --- */
+    /* --- 启动扫描计时器（MRT，标称周期取任务 0）与 SysTick（UART 预算计时同样依赖 MRT）--- */
+    ScanTimer_Init(s_scan_ms * 1000u);
     SysTick_Config(SystemCoreClock / TICKRATE_HZ);
 
     /* --- 主循环 --- */
     while (1) {
-        /* 轮询 UART，将字节交给下载协议状态机 */
-        int ch = Board_UARTGetChar();
-        if (ch != -1) {
-            Runtime_HandleUARTByte((uint8_t)ch);
+        /* 分批取出 RX 缓冲交给下载协议状态机：每轮至少处理一批，
+         * 即使扫描已到期（任务超时时 Sched_Pending() 可能一直为真，
+         * 不能让下载通道饿死）；后续批次在扫描到期或超出预算时停止，
+         * 剩余字节留在缓冲中下一轮再处理，保证扫描启动抖动有上界 */
+        uint32_t rx_t0 = ScanTimer_Now();
+        for (;;) {
+            uint8_t  rx[UART_RX_BATCH];
+            uint16_t n = UartIO_Read(rx, UART_RX_BATCH);
+            for (uint16_t i = 0u; i < n; i++) {
+                Runtime_HandleUARTByte(rx[i]);
+            }
+            if (n < UART_RX_BATCH || Sched_Pending() ||
+                ScanTimer_ElapsedUs(rx_t0, ScanTimer_Now()) >= UART_RX_BUDGET_US) {
+                break;
+            }
         }
 
-        /* PLC 周期扫描 */
-        if (s_scan_flag) {
-            s_scan_flag = false;
+        /* 推进分段执行的后台命令（按扇区擦除等），每轮一步 */
+        Runtime_Poll();
 
+        /* PLC 周期扫描：每轮执行一个就绪任务（最高优先级），
+         * 同时就绪的其余任务在随后几轮依次执行 */
+        if (Sched_Pending()) {
             if (plc_running) {
-                uint32_t t0 = s_tick_ms;
-
-#if defined(XCODE_MODE)
-                /* XCODE 模式：通过 WAMR 执行 plc_run(ms) */
-                xcode_runner_loop(s_tick_ms);
-#else
-                /* NCC 模式：调用原生用户逻辑 */
-                if (user->magic == USER_LOGIC_MAGIC) {
-                    user->loop();
+#if !defined(XCODE_MODE)
+                /* B 区被擦除后任务表入口已失效，魔数不符时不执行 */
+                if (user->magic != USER_LOGIC_MAGIC) {
+                    Sched_Discard();
+                    continue;
                 }
 #endif
-                /* 记录本次扫描耗时（近似，单位 ms，*1000 得 us） */
-                plc_scan_time_us = (s_tick_ms - t0) * 1000u;
+                plc_io_latch();
+                Sched_RunNext();
+                plc_io_flush();
             } else {
                 /* 停止状态：确保所有输出安全关闭 */
+                Sched_Discard();
                 plc_outputs_clear();
             }
         }
@@ -4,25 +4,53 @@
  * 负责：
  *   1. UART 下载协议状态机（接收上位机发来的用户逻辑 .bin）
  *   2. IAP Flash 编程（将接收到的数据写入 B 区 Flash）
- *   3. 对外暴露 Runtime_HandleUARTByte() 供 main.c 调用
+ *   3. 对外暴露 Runtime_HandleUARTByte() / Runtime_Poll() 供 main.c 调用
  *
  * 协议帧格式：
- *   [SOF:1][CMD:1][LEN_LO:1][LEN_HI:1][DATA:LEN][CRC8:1]
+ *   [SOF:1][CMD:1][LEN_LO:1][LEN_HI:1][DATA:LEN][CRC:1 或 4]
  *   SOF = 0xAA
+ *   CRC 默认为 CRC-8/MAXIM（1 字节）；PING 协商后改为 CRC-32/IEEE（4 字节小端），
+ *   均只覆盖 DATA 段。PING 帧本身（请求与响应）始终使用 CRC-8。
  *
  * 命令列表：
- *   0x01 PING        → 回复 "TiZi" 版本串
- *   0x02 ERASE       → 擦除 B 区全部扇区 (16-31)
+ *   0x01 PING        → 回复 "TiZi" 版本串，载荷 = [flags:1]（可选，见 PING_REQ_*）
+ *   0x02 ERASE       → 擦除 B 区全部扇区 (16-31)，按扇区分段执行，全部完成后才 ACK
  *   0x03 WRITE_PAGE  → 写 256 字节到 Flash，载荷 = [addr:4LE][data:256]
  *   0x04 VERIFY      → CRC 校验，载荷 = [addr:4LE][len:2LE][crc8:1]
+ *                      或 [addr:4LE][len:2LE][crc32:4LE]（CRC-32/IEEE，硬件计算）
  *   0x05 RESET       → 软复位，重新加载用户逻辑
+ *   0x06 SECTOR_CRC  → 各扇区 CRC-32，载荷 = [first:1][count:1]，
+ *                      响应 = [first:1][count:1][crc32:4LE × count]（增量下载用）
+ *   0x07 ERASE_SECTOR→ 擦除单个 B 区扇区，载荷 = [sector:1]
+ *   0x08 WRITE_SEQ   → 窗口化写页，载荷 = [seq:2LE][flags:1][addr:4LE][data:256]
+ *                      收满 WRITE_WINDOW 页或 flags 含 WRITE_SEQ_LAST 时统一编程，
+ *                      每页回复 [seq:2LE][status:1]（0 = 成功）
+ *   0x09 GET_HASH    → B 区映像指纹，响应 = [valid:1][length:4LE][crc32:4LE]
  *   0x10 GET_STATUS  → 获取 PLC 状态
  *   0x11 SET_RUN     → 启动/停止 PLC 扫描
  *   0x12 READ_IO     → 读当前 DI/DO 状态
+ *   0x13 GET_STATS   → 扫描时间/抖动统计，载荷 = [reset:1]（可选，非 0 则读后清零）
+ *   0x14 GET_TASKS   → 各周期任务的执行次数/超时/丢拍统计，载荷 = [reset:1]（可选）
  *
  * 响应：
  *   成功 → ACK (0x06) 或完整响应帧
  *   失败 → NAK (0x15)
+ *
+ * PING 响应 = "TiZiv1.1" + [caps:1][window:1]，caps 位见 CAP_*。
+ * 能力字节只在 PING 请求带载荷时附加：旧版上位机发送空载荷 PING，
+ * 并把整个响应当作版本串显示，对它只回 8 字节版本串。
+ *
+ * 帧 CRC 协商：上位机在 PING 载荷中置 PING_REQ_CRC32，且响应 caps 含 CAP_CRC32 时，
+ * 此后双方的非 PING 帧都使用 CRC-32 尾；不带该位的 PING 恢复 CRC-8。
+ * 旧版上位机发送空载荷 PING，始终停留在 CRC-8。
+ *
+ * 映像指纹：CRC-32 形式的 VERIFY 通过后，把 [length][crc32] 写入 B 区尾页
+ * （USER_TRAILER_ADDR）；GET_HASH 读出尾页并对 Flash 重新计算一次 CRC，
+ * 只有与当前 Flash 内容一致时 valid = 1，中途中断的下载不会留下"有效"指纹。
+ *
+ * 窗口化写页：IAP 编程期间必须关中断，UART 收到的字节会丢失，
+ * 因此不边收边写，而是先把一批页缓存在 RAM 槽位，整批收完再编程、逐页回复；
+ * 上位机收齐本批回复后才发送下一批，编程期间线路上没有数据。
  */
 
 #include "bsp/lpc_chip/board.h"
@@ -41,14 +69,37 @@
 #define CMD_WRITE_PAGE   0x03u
 #define CMD_VERIFY       0x04u
 #define CMD_RESET        0x05u
+#define CMD_SECTOR_CRC   0x06u
+#define CMD_ERASE_SECTOR 0x07u
+#define CMD_WRITE_SEQ    0x08u
+#define CMD_GET_HASH     0x09u
 #define CMD_GET_STATUS   0x10u
 #define CMD_SET_RUN      0x11u
 #define CMD_READ_IO      0x12u
+#define CMD_GET_STATS    0x13u
+#define CMD_GET_TASKS    0x14u
+
+/* PING 能力位 */
+#define CAP_WRITE_SEQ    0x01u  /* 支持 WRITE_SEQ 窗口化写页 */
+#define CAP_CRC32        0x02u  /* 支持 CRC-32 帧校验与 VERIFY */
+#define CAP_LOGIC_HASH   0x04u  /* 支持 GET_HASH 映像指纹 */
+
+/* PING 请求标志 */
+#define PING_REQ_CRC32   0x01u  /* 请求此后的帧使用 CRC-32 尾 */
+
+#define WRITE_WINDOW     4u     /* 每批最多缓存的页数（每页占 RAM ~264B）*/
+#define WRITE_SEQ_LAST   0x01u  /* flags：本批最后一页，收到后立即编程 */
 
 /* IAP 写入/擦除要求的最小单元 */
 #define FLASH_PAGE_SIZE  256u   /* IAP CopyRamToFlash 最小 256 字节 */
 #define FLASH_SECTOR_SIZE 1024u /* LPC824 每扇区 1KB */
 
+/* GET_STATS 响应长度（与 scan_timer.c 的 ScanTimer_Serialize 布局一致）*/
+#define SCAN_STATS_SIZE  68u
+
+/* GET_TASKS 响应最大长度（与 scheduler.c 的 Sched_Serialize 布局一致）*/
+#define TASK_STATS_SIZE  (1u + USER_MAX_TASKS * 20u)
+
 /* -----------------------------------------------------------------------
  * 解析状态机
  * -----------------------------------------------------------------------*/
@@ -68,7 +119,35 @@ static ParseState_t s_state   = PARSE_SOF;
 static uint8_t      s_cmd;
 static uint16_t     s_len;
 static uint16_t     s_rx_idx;
-static uint8_t      s_rx_buf[RX_BUF_SIZE + 1u]; /* +1 存 CRC 字节 */
+static uint8_t      s_rx_buf[RX_BUF_SIZE + 4u]; /* +4 存 CRC 字节 */
+static uint8_t      s_crc_idx;
+static bool         s_crc32_mode = false;      /* PING 协商结果：帧尾为 CRC-32 */
+
+/* 分段作业：每次 Runtime_Poll() 只处理一个扇区，避免长时间阻塞主循环 */
+typedef enum {
+    JOB_NONE,
+    JOB_ERASE,          /* 擦除扇区 s_job_next..s_job_last，完成后 ACK */
+    JOB_SECTOR_CRC,     /* 计算扇区 CRC-32，完成后回复 SECTOR_CRC 响应帧 */
+    JOB_WRITE_SEQ,      /* 逐个编程已缓存的 WRITE_SEQ 页槽并回复 */
+} Job_t;
+
+#define USER_SECTOR_COUNT  (USER_FLASH_SECTOR_END - USER_FLASH_SECTOR_START + 1u)
+
+static Job_t        s_job = JOB_NONE;
+static uint32_t     s_job_next;
+static uint32_t     s_job_last;
+static uint8_t      s_crc_resp[2u + USER_SECTOR_COUNT * 4u];
+static uint16_t     s_crc_len;
+
+/* WRITE_SEQ 页槽（data 按字对齐，满足 IAP CopyRamToFlash 要求）*/
+typedef struct {
+    bool     used;
+    uint16_t seq;
+    uint32_t addr;
+    uint32_t data[FLASH_PAGE_SIZE / 4u];
+} PageSlot_t;
+
+static PageSlot_t   s_slots[WRITE_WINDOW];
 
 /* -----------------------------------------------------------------------
  * 外部变量（定义在 main.c）
@@ -78,48 +157,106 @@ extern volatile uint32_t plc_scan_time_us;
 extern volatile uint8_t  plc_do_state;
 
 /* -----------------------------------------------------------------------
- * CRC-8/MAXIM (polynomial 0x31, init 0x00)
+ * UART 收发（uart_io.c 中实现）
+ * -----------------------------------------------------------------------*/
+void UartIO_PutChar(uint8_t ch);
+void UartIO_Write(const uint8_t *data, uint16_t len);
+void UartIO_Flush(void);
+
+/* -----------------------------------------------------------------------
+ * 扫描统计（scan_timer.c 中实现）
+ * -----------------------------------------------------------------------*/
+uint16_t ScanTimer_Serialize(uint8_t *buf);
+void     ScanTimer_Reset(void);
+
+/* -----------------------------------------------------------------------
+ * 任务统计（scheduler.c 中实现）
  * -----------------------------------------------------------------------*/
+uint16_t Sched_Serialize(uint8_t *buf);
+void     Sched_ResetStats(void);
+
+/* -----------------------------------------------------------------------
+ * CRC-8/MAXIM (polynomial 0x31, init 0x00) — 查表，每字节一次读 Flash
+ * -----------------------------------------------------------------------*/
+static const uint8_t k_crc8_table[256] = {
+    0x00u, 0x31u, 0x62u, 0x53u, 0xC4u, 0xF5u, 0xA6u, 0x97u, 0xB9u, 0x88u, 0xDBu, 0xEAu, 0x7Du, 0x4Cu, 0x1Fu, 0x2Eu,
+    0x43u, 0x72u, 0x21u, 0x10u, 0x87u, 0xB6u, 0xE5u, 0xD4u, 0xFAu, 0xCBu, 0x98u, 0xA9u, 0x3Eu, 0x0Fu, 0x5Cu, 0x6Du,
+    0x86u, 0xB7u, 0xE4u, 0xD5u, 0x42u, 0x73u, 0x20u, 0x11u, 0x3Fu, 0x0Eu, 0x5Du, 0x6Cu, 0xFBu, 0xCAu, 0x99u, 0xA8u,
+    0xC5u, 0xF4u, 0xA7u, 0x96u, 0x01u, 0x30u, 0x63u, 0x52u, 0x7Cu, 0x4Du, 0x1Eu, 0x2Fu, 0xB8u, 0x89u, 0xDAu, 0xEBu,
+    0x3Du, 0x0Cu, 0x5Fu, 0x6Eu, 0xF9u, 0xC8u, 0x9Bu, 0xAAu, 0x84u, 0xB5u, 0xE6u, 0xD7u, 0x40u, 0x71u, 0x22u, 0x13u,
+    0x7Eu, 0x4Fu, 0x1Cu, 0x2Du, 0xBAu, 0x8Bu, 0xD8u, 0xE9u, 0xC7u, 0xF6u, 0xA5u, 0x94u, 0x03u, 0x32u, 0x61u, 0x50u,
+    0xBBu, 0x8Au, 0xD9u, 0xE8u, 0x7Fu, 0x4Eu, 0x1Du, 0x2Cu, 0x02u, 0x33u, 0x60u, 0x51u, 0xC6u, 0xF7u, 0xA4u, 0x95u,
+    0xF8u, 0xC9u, 0x9Au, 0xABu, 0x3Cu, 0x0Du, 0x5Eu, 0x6Fu, 0x41u, 0x70u, 0x23u, 0x12u, 0x85u, 0xB4u, 0xE7u, 0xD6u,
+    0x7Au, 0x4Bu, 0x18u, 0x29u, 0xBEu, 0x8Fu, 0xDCu, 0xEDu, 0xC3u, 0xF2u, 0xA1u, 0x90u, 0x07u, 0x36u, 0x65u, 0x54u,
+    0x39u, 0x08u, 0x5Bu, 0x6Au, 0xFDu, 0xCCu, 0x9Fu, 0xAEu, 0x80u, 0xB1u, 0xE2u, 0xD3u, 0x44u, 0x75u, 0x26u, 0x17u,
+    0xFCu, 0xCDu, 0x9Eu, 0xAFu, 0x38u, 0x09u, 0x5Au, 0x6Bu, 0x45u, 0x74u, 0x27u, 0x16u, 0x81u, 0xB0u, 0xE3u, 0xD2u,
+    0xBFu, 0x8Eu, 0xDDu, 0xECu, 0x7Bu, 0x4Au, 0x19u, 0x28u, 0x06u, 0x37u, 0x64u, 0x55u, 0xC2u, 0xF3u, 0xA0u, 0x91u,
+    0x47u, 0x76u, 0x25u, 0x14u, 0x83u, 0xB2u, 0xE1u, 0xD0u, 0xFEu, 0xCFu, 0x9Cu, 0xADu, 0x3Au, 0x0Bu, 0x58u, 0x69u,
+    0x04u, 0x35u, 0x66u, 0x57u, 0xC0u, 0xF1u, 0xA2u, 0x93u, 0xBDu, 0x8Cu, 0xDFu, 0xEEu, 0x79u, 0x48u, 0x1Bu, 0x2Au,
+    0xC1u, 0xF0u, 0xA3u, 0x92u, 0x05u, 0x34u, 0x67u, 0x56u, 0x78u, 0x49u, 0x1Au, 0x2Bu, 0xBCu, 0x8Du, 0xDEu, 0xEFu,
+    0x82u, 0xB3u, 0xE0u, 0xD1u, 0x46u, 0x77u, 0x24u, 0x15u, 0x3Bu, 0x0Au, 0x59u, 0x68u, 0xFFu, 0xCEu, 0x9Du, 0xACu
+};
+
 static uint8_t crc8(const uint8_t *data, uint16_t len)
 {
     uint8_t crc = 0u;
     for (uint16_t i = 0u; i < len; i++) {
-        crc ^= data[i];
-        for (int b = 0; b < 8; b++) {
-            crc = (crc & 0x80u) ? ((crc << 1u) ^ 0x31u) : (crc << 1u);
-        }
+        crc = k_crc8_table[crc ^ data[i]];
     }
     return crc;
 }
 
+/* -----------------------------------------------------------------------
+ * CRC-32（IEEE 802.3，硬件 CRC 引擎）— 用于扇区内容比对
+ * -----------------------------------------------------------------------*/
+static uint32_t crc32_hw(const uint8_t *data, uint32_t len)
+{
+    Chip_CRC_Init();     /* 仅打开外设时钟，可重复调用 */
+    Chip_CRC_UseCRC32();
+    while (len > 0u) {
+        Chip_CRC_Write8(*data++);
+        len--;
+    }
+    return Chip_CRC_Sum();
+}
+
 /* -----------------------------------------------------------------------
  * 发送辅助
  * -----------------------------------------------------------------------*/
-static void send_ack(void) { Board_UARTPutChar(ACK); }
-static void send_nak(void) { Board_UARTPutChar(NAK); }
+static void send_ack(void) { UartIO_PutChar(ACK); }
+static void send_nak(void) { UartIO_PutChar(NAK); }
+
+/* 帧尾 CRC 字节数：PING 帧固定 CRC-8，便于随时重新协商 */
+static uint8_t frame_crc_len(uint8_t cmd)
+{
+    return (s_crc32_mode && cmd != CMD_PING) ? 4u : 1u;
+}
 
 static void send_response(uint8_t cmd, const uint8_t *data, uint16_t len)
 {
-    Board_UARTPutChar(PROTO_SOF);
-    Board_UARTPutChar(cmd);
-    Board_UARTPutChar((uint8_t)(len & 0xFFu));
-    Board_UARTPutChar((uint8_t)(len >> 8u));
-    for (uint16_t i = 0u; i < len; i++) {
-        Board_UARTPutChar(data[i]);
+    uint8_t hdr[4] = { PROTO_SOF, cmd, (uint8_t)(len & 0xFFu), (uint8_t)(len >> 8u) };
+    UartIO_Write(hdr, 4u);
+    UartIO_Write(data, len);
+    if (frame_crc_len(cmd) == 4u) {
+        uint32_t crc = crc32_hw(data, len);
+        uint8_t  tail[4] = { (uint8_t)(crc & 0xFFu), (uint8_t)(crc >> 8u),
+                             (uint8_t)(crc >> 16u),  (uint8_t)(crc >> 24u) };
+        UartIO_Write(tail, 4u);
+    } else {
+        UartIO_PutChar(crc8(data, len));
     }
-    Board_UARTPutChar(crc8(data, len));
 }
 
 /* -----------------------------------------------------------------------
  * IAP Flash 编程辅助
  * -----------------------------------------------------------------------*/
-static uint8_t flash_erase_user(void)
+static uint8_t flash_erase_sector(uint32_t sector)
 {
     uint8_t r;
     __disable_irq();
-    r = Chip_IAP_PreSectorForReadWrite(USER_FLASH_SECTOR_START, USER_FLASH_SECTOR_END);
+    r = Chip_IAP_PreSectorForReadWrite(sector, sector);
     if (r == IAP_CMD_SUCCESS) {
-        r = Chip_IAP_EraseSector(USER_FLASH_SECTOR_START, USER_FLASH_SECTOR_END);
+        r = Chip_IAP_EraseSector(sector, sector);
     }
     __enable_irq();
     return r;
@@ -144,15 +281,98 @@ static uint8_t flash_write_page(uint32_t dst_addr, uint8_t *src, uint32_t size)
     return r;
 }
 
+static void slots_clear(void)
+{
+    for (uint32_t i = 0u; i < WRITE_WINDOW; i++) {
+        s_slots[i].used = false;
+    }
+}
+
+/* -----------------------------------------------------------------------
+ * B 区指纹尾页
+ * -----------------------------------------------------------------------*/
+
+/* 尾页记录的映像仍与 Flash 内容一致时返回该记录，否则返回 NULL */
+static const UserTrailer_t *trailer_valid(void)
+{
+    const UserTrailer_t *t = (const UserTrailer_t *)USER_TRAILER_ADDR;
+    if (t->magic != USER_TRAILER_MAGIC ||
+        t->length == 0u || t->length > USER_IMAGE_MAX_SIZE) {
+        return NULL;
+    }
+    if (crc32_hw((const uint8_t *)USER_FLASH_BASE, t->length) != t->crc32) {
+        return NULL;
+    }
+    return t;
+}
+
+/*
+ * VERIFY（CRC-32）通过后记录指纹
+ * 尾页已擦除则直接编程；有旧记录且映像未占用最后一个扇区时先擦除该扇区；
+ * 否则放弃（上位机增量下载时该扇区 CRC 必然不同，会被整扇区重写）
+ */
+static void trailer_store(uint32_t length, uint32_t crc)
+{
+    const UserTrailer_t *t    = (const UserTrailer_t *)USER_TRAILER_ADDR;
+    const uint32_t      *word = (const uint32_t *)USER_TRAILER_ADDR;
+
+    if (length > USER_IMAGE_MAX_SIZE) {
+        return;
+    }
+    if (t->magic == USER_TRAILER_MAGIC && t->length == length && t->crc32 == crc) {
+        return;
+    }
+
+    bool blank = true;
+    for (uint32_t i = 0u; i < USER_TRAILER_SIZE / 4u; i++) {
+        if (word[i] != 0xFFFFFFFFu) {
+            blank = false;
+            break;
+        }
+    }
+    if (!blank) {
+        if (USER_FLASH_BASE + length > USER_FLASH_SECTOR_END * FLASH_SECTOR_SIZE ||
+            flash_erase_sector(USER_FLASH_SECTOR_END) != IAP_CMD_SUCCESS) {
+            return;
+        }
+    }
+
+    /* 借用空闲的页槽作 256 字节对齐缓冲（VERIFY 时没有未编程的页）*/
+    uint32_t *page = s_slots[0].data;
+    for (uint32_t i = 0u; i < FLASH_PAGE_SIZE / 4u; i++) {
+        page[i] = 0xFFFFFFFFu;
+    }
+    page[0] = USER_TRAILER_MAGIC;
+    page[1] = length;
+    page[2] = crc;
+    slots_clear();
+    (void)flash_write_page(USER_TRAILER_ADDR, (uint8_t *)page, FLASH_PAGE_SIZE);
+}
+
 /* -----------------------------------------------------------------------
  * 命令处理
  * -----------------------------------------------------------------------*/
 static void process_command(void)
 {
-    /* 校验 CRC */
-    uint8_t expected = crc8(s_rx_buf, s_len);
-    uint8_t actual   = s_rx_buf[s_len]; /* CRC 存在载荷末尾+1 处 */
-    if (actual != expected) {
+    /* 校验 CRC（存在载荷末尾之后）*/
+    const uint8_t *tail = &s_rx_buf[s_len];
+    bool crc_ok;
+    if (frame_crc_len(s_cmd) == 4u) {
+        uint32_t actual = (uint32_t)tail[0]
+                        | ((uint32_t)tail[1] << 8u)
+                        | ((uint32_t)tail[2] << 16u)
+                        | ((uint32_t)tail[3] << 24u);
+        crc_ok = (actual == crc32_hw(s_rx_buf, s_len));
+    } else {
+        crc_ok = (tail[0] == crc8(s_rx_buf, s_len));
+    }
+    if (!crc_ok) {
+        send_nak();
+        return;
+    }
+
+    /* 分段作业进行中（擦除/CRC），不接受新命令 */
+    if (s_job != JOB_NONE) {
         send_nak();
         return;
     }
@@ -161,16 +381,57 @@ static void process_command(void)
 
     /* ---- PING -------------------------------------------------------- */
     case CMD_PING: {
-        uint8_t resp[8] = {'T','i','Z','i',
-                           'v', '1', '.', '0'};
-        send_response(CMD_PING, resp, 8u);
+        uint8_t resp[10] = {'T','i','Z','i',
+                            'v', '1', '.', '1',
+                            CAP_WRITE_SEQ | CAP_CRC32 | CAP_LOGIC_HASH, WRITE_WINDOW};
+        /* 空载荷 = 旧版上位机：不附加能力字节，保持 CRC-8 */
+        s_crc32_mode = (s_len >= 1u) && ((s_rx_buf[0] & PING_REQ_CRC32) != 0u);
+        send_response(CMD_PING, resp, (s_len >= 1u) ? 10u : 8u);
         break;
     }
 
     /* ---- ERASE ------------------------------------------------------- */
     case CMD_ERASE: {
-        uint8_t r = flash_erase_user();
-        if (r == IAP_CMD_SUCCESS) send_ack(); else send_nak();
+        /* B 区即将失效：先停止扫描，防止 loop() 跳入被擦除/半写入的 Flash */
+        plc_running    = false;
+        slots_clear();   /* 丢弃上次未完成批次的缓存页 */
+        s_job_next     = USER_FLASH_SECTOR_START;
+        s_job_last     = USER_FLASH_SECTOR_END;
+        s_job          = JOB_ERASE;   /* 由 Runtime_Poll() 逐扇区完成并回复 ACK/NAK */
+        break;
+    }
+
+    /* ---- ERASE_SECTOR ------------------------------------------------ */
+    case CMD_ERASE_SECTOR: {
+        /* 载荷：[sector:1]，只允许 B 区扇区 */
+        if (s_len != 1u ||
+            s_rx_buf[0] < USER_FLASH_SECTOR_START || s_rx_buf[0] > USER_FLASH_SECTOR_END) {
+            send_nak();
+            break;
+        }
+        plc_running    = false;
+        slots_clear();   /* 丢弃上次未完成批次的缓存页 */
+        s_job_next     = s_rx_buf[0];
+        s_job_last     = s_rx_buf[0];
+        s_job          = JOB_ERASE;
+        break;
+    }
+
+    /* ---- SECTOR_CRC -------------------------------------------------- */
+    case CMD_SECTOR_CRC: {
+        /* 载荷：[first:1][count:1]，范围须在 B 区内；只读，不停止扫描 */
+        if (s_len != 2u || s_rx_buf[1] == 0u ||
+            s_rx_buf[0] < USER_FLASH_SECTOR_START ||
+            (uint32_t)s_rx_buf[0] + s_rx_buf[1] - 1u > USER_FLASH_SECTOR_END) {
+            send_nak();
+            break;
+        }
+        s_crc_resp[0] = s_rx_buf[0];
+        s_crc_resp[1] = s_rx_buf[1];
+        s_crc_len     = 2u;
+        s_job_next    = s_rx_buf[0];
+        s_job_last    = (uint32_t)s_rx_buf[0] + s_rx_buf[1] - 1u;
+        s_job         = JOB_SECTOR_CRC;
         break;
     }
 
@@ -191,10 +452,67 @@ static void process_command(void)
         break;
     }
 
+    /* ---- WRITE_SEQ --------------------------------------------------- */
+    case CMD_WRITE_SEQ: {
+        /* 载荷：[seq:2LE][flags:1][addr:4LE][data:256] */
+        if (s_len != 7u + FLASH_PAGE_SIZE) {
+            send_nak();
+            break;
+        }
+        uint16_t seq   = (uint16_t)s_rx_buf[0] | ((uint16_t)s_rx_buf[1] << 8u);
+        uint8_t  flags = s_rx_buf[2];
+
+        /* 同一 seq 重传则覆盖原槽位，否则取空闲槽位 */
+        PageSlot_t *slot = NULL;
+        uint32_t    used = 0u;
+        for (uint32_t i = 0u; i < WRITE_WINDOW; i++) {
+            if (s_slots[i].used) {
+                used++;
+                if (s_slots[i].seq == seq) { slot = &s_slots[i]; }
+            } else if (slot == NULL) {
+                slot = &s_slots[i];
+            }
+        }
+        if (slot == NULL) {
+            /* 超出窗口：回复失败状态，由上位机下一批重传 */
+            uint8_t resp[3] = { s_rx_buf[0], s_rx_buf[1], 1u };
+            send_response(CMD_WRITE_SEQ, resp, 3u);
+            break;
+        }
+        if (!slot->used) { used++; }
+        slot->used = true;
+        slot->seq  = seq;
+        slot->addr = (uint32_t)s_rx_buf[3]
+                   | ((uint32_t)s_rx_buf[4] << 8u)
+                   | ((uint32_t)s_rx_buf[5] << 16u)
+                   | ((uint32_t)s_rx_buf[6] << 24u);
+        __builtin_memcpy(slot->data, &s_rx_buf[7], FLASH_PAGE_SIZE);
+
+        if ((flags & WRITE_SEQ_LAST) != 0u || used >= WRITE_WINDOW) {
+            s_job = JOB_WRITE_SEQ;   /* 整批收齐，由 Runtime_Poll() 逐页编程 */
+        }
+        break;
+    }
+
+    /* ---- GET_HASH ---------------------------------------------------- */
+    case CMD_GET_HASH: {
+        /* 响应：[valid:1][length:4LE][crc32:4LE]，无有效指纹时 valid = 0、其余为 0 */
+        const UserTrailer_t *t = trailer_valid();
+        uint32_t len = t ? t->length : 0u;
+        uint32_t crc = t ? t->crc32  : 0u;
+        uint8_t  resp[9] = {
+            t ? 1u : 0u,
+            (uint8_t)(len & 0xFFu), (uint8_t)(len >> 8u), (uint8_t)(len >> 16u), (uint8_t)(len >> 24u),
+            (uint8_t)(crc & 0xFFu), (uint8_t)(crc >> 8u), (uint8_t)(crc >> 16u), (uint8_t)(crc >> 24u),
+        };
+        send_response(CMD_GET_HASH, resp, 9u);
+        break;
+    }
+
     /* ---- VERIFY ------------------------------------------------------ */
     case CMD_VERIFY: {
-        /* 载荷：[addr:4LE][len:2LE][expected_crc8:1] */
-        if (s_len != 7u) {
+        /* 载荷：[addr:4LE][len:2LE][expected_crc8:1] 或 [...][expected_crc32:4LE] */
+        if (s_len != 7u && s_len != 10u) {
             send_nak();
             break;
         }
@@ -204,15 +522,27 @@ static void process_command(void)
                        | ((uint32_t)s_rx_buf[3] << 24u);
         uint16_t vlen  = (uint16_t)s_rx_buf[4]
                        | ((uint16_t)s_rx_buf[5] << 8u);
-        uint8_t  ecrc  = s_rx_buf[6];
-        uint8_t  acrc  = crc8((const uint8_t *)addr, vlen);
-        if (acrc == ecrc) send_ack(); else send_nak();
+        bool ok;
+        if (s_len == 10u) {
+            uint32_t ecrc = (uint32_t)s_rx_buf[6]
+                          | ((uint32_t)s_rx_buf[7] << 8u)
+                          | ((uint32_t)s_rx_buf[8] << 16u)
+                          | ((uint32_t)s_rx_buf[9] << 24u);
+            ok = (crc32_hw((const uint8_t *)addr, vlen) == ecrc);
+            if (ok && addr == USER_FLASH_BASE) {
+                trailer_store(vlen, ecrc);
+            }
+        } else {
+            ok = (crc8((const uint8_t *)addr, vlen) == s_rx_buf[6]);
+        }
+        if (ok) send_ack(); else send_nak();
         break;
     }
 
     /* ---- RESET ------------------------------------------------------- */
     case CMD_RESET: {
         send_ack();
+        UartIO_Flush();
         NVIC_SystemReset();
         break;
     }
@@ -252,12 +582,94 @@ static void process_command(void)
         break;
     }
 
+    /* ---- GET_STATS --------------------------------------------------- */
+    case CMD_GET_STATS: {
+        if (s_len > 1u) { send_nak(); break; }
+        uint8_t  resp[SCAN_STATS_SIZE];
+        uint16_t n = ScanTimer_Serialize(resp);
+        send_response(CMD_GET_STATS, resp, n);
+        if (s_len == 1u && s_rx_buf[0] != 0u) {
+            ScanTimer_Reset();
+        }
+        break;
+    }
+
+    /* ---- GET_TASKS --------------------------------------------------- */
+    case CMD_GET_TASKS: {
+        if (s_len > 1u) { send_nak(); break; }
+        uint8_t  resp[TASK_STATS_SIZE];
+        uint16_t n = Sched_Serialize(resp);
+        send_response(CMD_GET_TASKS, resp, n);
+        if (s_len == 1u && s_rx_buf[0] != 0u) {
+            Sched_ResetStats();
+        }
+        break;
+    }
+
     default:
         send_nak();
         break;
     }
 }
 
+/* -----------------------------------------------------------------------
+ * 公开接口：main.c 每轮主循环调用，推进分段执行的后台命令
+ * -----------------------------------------------------------------------*/
+void Runtime_Poll(void)
+{
+    switch (s_job) {
+
+    case JOB_ERASE:
+        if (flash_erase_sector(s_job_next) != IAP_CMD_SUCCESS) {
+            s_job = JOB_NONE;
+            send_nak();
+        } else if (++s_job_next > s_job_last) {
+            s_job = JOB_NONE;
+            send_ack();
+        }
+        break;
+
+    case JOB_SECTOR_CRC: {
+        uint32_t crc = crc32_hw((const uint8_t *)(s_job_next * FLASH_SECTOR_SIZE),
+                                FLASH_SECTOR_SIZE);
+        s_crc_resp[s_crc_len++] = (uint8_t)(crc & 0xFFu);
+        s_crc_resp[s_crc_len++] = (uint8_t)(crc >> 8u);
+        s_crc_resp[s_crc_len++] = (uint8_t)(crc >> 16u);
+        s_crc_resp[s_crc_len++] = (uint8_t)(crc >> 24u);
+        if (++s_job_next > s_job_last) {
+            s_job = JOB_NONE;
+            send_response(CMD_SECTOR_CRC, s_crc_resp, s_crc_len);
+        }
+        break;
+    }
+
+    case JOB_WRITE_SEQ: {
+        PageSlot_t *slot = NULL;
+        bool        more = false;
+        for (uint32_t i = 0u; i < WRITE_WINDOW; i++) {
+            if (!s_slots[i].used) { continue; }
+            if (slot == NULL) { slot = &s_slots[i]; } else { more = true; }
+        }
+        if (slot == NULL) {
+            s_job = JOB_NONE;
+            break;
+        }
+        uint8_t r = flash_write_page(slot->addr, (uint8_t *)slot->data, FLASH_PAGE_SIZE);
+        uint8_t resp[3] = { (uint8_t)(slot->seq & 0xFFu), (uint8_t)(slot->seq >> 8u),
+                            (r == IAP_CMD_SUCCESS) ? 0u : r };
+        slot->used = false;
+        if (!more) {
+            s_job = JOB_NONE;   /* 先结束作业再回复最后一页，上位机随即发送的下一批不会被拒 */
+        }
+        send_response(CMD_WRITE_SEQ, resp, 3u);
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
 /* -----------------------------------------------------------------------
  * 公开接口：main.c 每收到一个 UART 字节调用此函数
  * -----------------------------------------------------------------------*/
@@ -281,7 +693,8 @@ void Runtime_HandleUARTByte(uint8_t byte)
 
     case PARSE_LEN_HI:
         s_len  |= ((uint16_t)byte << 8u);
-        s_rx_idx = 0u;
+        s_rx_idx  = 0u;
+        s_crc_idx = 0u;
         if (s_len > (uint16_t)(RX_BUF_SIZE)) {
             s_state = PARSE_SOF; /* 载荷超长，丢弃 */
         } else if (s_len == 0u) {
@@ -297,9 +710,11 @@ void Runtime_HandleUARTByte(uint8_t byte)
         break;
 
     case PARSE_CRC:
-        s_rx_buf[s_len] = byte; /* 存 CRC 在载荷末尾 */
-        process_command();
-        s_state = PARSE_SOF;
+        s_rx_buf[s_len + s_crc_idx++] = byte; /* 存 CRC 在载荷末尾 */
+        if (s_crc_idx >= frame_crc_len(s_cmd)) {
+            process_command();
+            s_state = PARSE_SOF;
+        }
         break;
     }
 }
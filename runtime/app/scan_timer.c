@@ -0,0 +1,186 @@
+/*
+ * app/scan_timer.c — PLC 扫描周期计时与抖动统计
+ *
+ * 使用 MRT 通道 0 作为自由运行的 31 位递减计数器（主频计数，30MHz → 33ns 分辨率），
+ * 取代原先基于 SysTick 毫秒计数的近似扫描时间。
+ *
+ * 统计两类分布：
+ *   exec   — 单次扫描执行时间（loop() 耗时）
+ *   jitter — 扫描启动抖动 = |相邻两次启动间隔 - 标称周期|
+ *
+ * 每类分布保存 count / min / max / avg，以及固定分档直方图。
+ * avg 为 1/16 指数滑动平均，避免长时间运行后累加和溢出（M0+ 无硬件除法，也不做 64 位运算）。
+ *
+ * 计数器每 2^31 / 30MHz ≈ 71s 回绕一次，差值按 31 位掩码计算，
+ * 只要相邻两次采样间隔小于回绕周期即正确。
+ */
+
+#include "bsp/lpc_chip/board.h"
+
+/* -----------------------------------------------------------------------
+ * 配置
+ * -----------------------------------------------------------------------*/
+#define SCAN_TIMER_CH       0u     /* 使用 MRT 通道 0 */
+#define SCAN_HIST_BUCKETS   8u     /* 直方图分档数（最后一档为溢出档）*/
+
+/* 直方图分档上界（us，左闭右开），最后一档收集 >= 最大上界的样本 */
+static const uint32_t k_exec_edges_us[SCAN_HIST_BUCKETS - 1u] = {
+    50u, 100u, 200u, 500u, 1000u, 2000u, 5000u
+};
+static const uint32_t k_jitter_edges_us[SCAN_HIST_BUCKETS - 1u] = {
+    5u, 10u, 20u, 50u, 100u, 200u, 500u
+};
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t avg_us;
+    uint16_t hist[SCAN_HIST_BUCKETS];   /* 饱和计数 */
+} ScanDist_t;
+
+/* -----------------------------------------------------------------------
+ * 内部状态
+ * -----------------------------------------------------------------------*/
+static LPC_MRT_CH_T *s_mrt;
+static uint32_t      s_ticks_per_us  = 1u;
+static uint32_t      s_period_us     = 0u;
+static uint32_t      s_prev_start    = 0u;
+static bool          s_have_prev     = false;
+
+static ScanDist_t    s_exec;
+static ScanDist_t    s_jitter;
+
+/* -----------------------------------------------------------------------
+ * 分布统计
+ * -----------------------------------------------------------------------*/
+static void dist_reset(ScanDist_t *d)
+{
+    __builtin_memset(d, 0, sizeof(*d));
+    d->min_us = 0xFFFFFFFFu;
+}
+
+static void dist_add(ScanDist_t *d, const uint32_t *edges, uint32_t us)
+{
+    d->count++;
+    if (us < d->min_us) { d->min_us = us; }
+    if (us > d->max_us) { d->max_us = us; }
+
+    if (d->count == 1u) {
+        d->avg_us = us;
+    } else {
+        d->avg_us = (uint32_t)((int32_t)d->avg_us + ((int32_t)(us - d->avg_us) / 16));
+    }
+
+    uint32_t b = 0u;
+    while (b < SCAN_HIST_BUCKETS - 1u && us >= edges[b]) {
+        b++;
+    }
+    if (d->hist[b] != 0xFFFFu) {
+        d->hist[b]++;
+    }
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v & 0xFFu);
+    p[1] = (uint8_t)(v >> 8u);
+    p[2] = (uint8_t)(v >> 16u);
+    p[3] = (uint8_t)(v >> 24u);
+    return p + 4;
+}
+
+static uint8_t *dist_serialize(uint8_t *p, const ScanDist_t *d)
+{
+    p = put_u32(p, d->count);
+    p = put_u32(p, d->count ? d->min_us : 0u);
+    p = put_u32(p, d->max_us);
+    p = put_u32(p, d->avg_us);
+    for (uint32_t i = 0u; i < SCAN_HIST_BUCKETS; i++) {
+        p[0] = (uint8_t)(d->hist[i] & 0xFFu);
+        p[1] = (uint8_t)(d->hist[i] >> 8u);
+        p += 2;
+    }
+    return p;
+}
+
+/* -----------------------------------------------------------------------
+ * 公开接口
+ * -----------------------------------------------------------------------*/
+
+/* 启动 MRT 自由运行计数器；period_us 为标称扫描周期（用于计算抖动）*/
+void ScanTimer_Init(uint32_t period_us)
+{
+    Chip_MRT_Init();
+    s_mrt = Chip_MRT_GetRegPtr(SCAN_TIMER_CH);
+    Chip_MRT_SetMode(s_mrt, MRT_MODE_REPEAT);
+    Chip_MRT_SetInterval(s_mrt, MRT_INTVAL_IVALUE | MRT_INTVAL_LOAD);
+
+    s_ticks_per_us = SystemCoreClock / 1000000u;
+    if (s_ticks_per_us == 0u) { s_ticks_per_us = 1u; }
+    s_period_us = period_us;
+
+    dist_reset(&s_exec);
+    dist_reset(&s_jitter);
+    s_have_prev = false;
+}
+
+/* 当前计数值（原始 tick，递减）*/
+uint32_t ScanTimer_Now(void)
+{
+    return Chip_MRT_GetTimer(s_mrt);
+}
+
+/* 两个采样点之间的微秒数（递减计数器：先采样的值更大）*/
+uint32_t ScanTimer_ElapsedUs(uint32_t from, uint32_t to)
+{
+    return ((from - to) & MRT_INTVAL_IVALUE) / s_ticks_per_us;
+}
+
+/*
+ * 记录一次扫描：start/end 为 ScanTimer_Now() 采样值
+ * 返回本次执行时间（us）
+ */
+uint32_t ScanTimer_Record(uint32_t start, uint32_t end)
+{
+    uint32_t exec_us = ScanTimer_ElapsedUs(start, end);
+    dist_add(&s_exec, k_exec_edges_us, exec_us);
+
+    if (s_have_prev) {
+        uint32_t interval_us = ScanTimer_ElapsedUs(s_prev_start, start);
+        uint32_t jitter_us   = (interval_us > s_period_us)
+                             ? (interval_us - s_period_us)
+                             : (s_period_us - interval_us);
+        dist_add(&s_jitter, k_jitter_edges_us, jitter_us);
+    }
+    s_prev_start = start;
+    s_have_prev  = true;
+    return exec_us;
+}
+
+/* PLC 停止时调用：下次启动不计算与停止前的间隔 */
+void ScanTimer_Pause(void)
+{
+    s_have_prev = false;
+}
+
+void ScanTimer_Reset(void)
+{
+    dist_reset(&s_exec);
+    dist_reset(&s_jitter);
+    s_have_prev = false;
+}
+
+/*
+ * 序列化统计数据（GET_STATS 响应载荷），返回写入字节数
+ *   [period_us:4][exec:32][jitter:32]
+ *   每个分布：[count:4][min:4][max:4][avg:4][hist:8×2]，均为小端
+ */
+uint16_t ScanTimer_Serialize(uint8_t *buf)
+{
+    uint8_t *p = buf;
+    p = put_u32(p, s_period_us);
+    p = dist_serialize(p, &s_exec);
+    p = dist_serialize(p, &s_jitter);
+    return (uint16_t)(p - buf);
+}
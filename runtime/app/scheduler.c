@@ -0,0 +1,218 @@
+/*
+ * app/scheduler.c — 多任务周期调度与超时统计
+ *
+ * 取代原先单一 s_scan_flag 的扫描触发：每个任务有独立周期（ms）与优先级，
+ * 由 SysTick（1ms）递减计数并置位 pending，主循环按优先级逐个执行。
+ *
+ * 调度为非抢占式：一个任务执行完才会选择下一个，优先级只决定多个任务
+ * 同时就绪时的执行顺序（数值越小越优先，与 IEC 61131-3 TASK PRIORITY 一致）。
+ *
+ * 每个任务统计：
+ *   runs     — 已执行次数
+ *   overruns — 周期到达时该任务仍在执行（执行时间超过周期）
+ *   missed   — 周期到达时上一次触发还未被执行（被更高优先级任务或 UART 处理耽误），
+ *              本次触发被合并丢弃
+ *   max_us   — 最长单次执行时间
+ *
+ * 任务表第 0 项同时驱动 scan_timer.c 的扫描时间/抖动统计（GET_STATS）
+ * 以及 GET_STATUS 报告的 plc_scan_time_us。
+ */
+
+#include "bsp/lpc_chip/board.h"
+
+/* -----------------------------------------------------------------------
+ * 配置
+ * -----------------------------------------------------------------------*/
+#define SCHED_MAX_TASKS     4u     /* 与 shared_interface.h 的 USER_MAX_TASKS 一致 */
+
+typedef struct {
+    void            (*run)(void);
+    uint16_t          period_ms;
+    uint8_t           priority;
+    volatile bool     pending;     /* SysTick 置位，主循环清零 */
+    volatile bool     running;
+    uint16_t          countdown;   /* 仅 SysTick 访问 */
+    uint32_t          runs;
+    volatile uint32_t overruns;    /* SysTick 中累加 */
+    volatile uint32_t missed;      /* SysTick 中累加 */
+    uint32_t          max_us;
+} SchedTask_t;
+
+/* -----------------------------------------------------------------------
+ * 内部状态
+ * -----------------------------------------------------------------------*/
+static SchedTask_t s_tasks[SCHED_MAX_TASKS];
+static uint8_t     s_count = 0u;
+
+/* -----------------------------------------------------------------------
+ * 外部变量（定义在 main.c）
+ * -----------------------------------------------------------------------*/
+extern volatile uint32_t plc_scan_time_us;
+
+/* -----------------------------------------------------------------------
+ * 声明（scan_timer.c 中实现）
+ * -----------------------------------------------------------------------*/
+uint32_t ScanTimer_Now(void);
+uint32_t ScanTimer_ElapsedUs(uint32_t from, uint32_t to);
+uint32_t ScanTimer_Record(uint32_t start, uint32_t end);
+void     ScanTimer_Pause(void);
+
+/* -----------------------------------------------------------------------
+ * 公开接口
+ * -----------------------------------------------------------------------*/
+
+/*
+ * 注册一个周期任务（须在 SysTick 启动前调用）
+ * 返回 false 表示任务表已满或参数无效
+ */
+bool Sched_AddTask(void (*run)(void), uint16_t period_ms, uint8_t priority)
+{
+    if (s_count >= SCHED_MAX_TASKS || run == NULL || period_ms == 0u) {
+        return false;
+    }
+    SchedTask_t *t = &s_tasks[s_count++];
+    __builtin_memset(t, 0, sizeof(*t));
+    t->run       = run;
+    t->period_ms = period_ms;
+    t->priority  = priority;
+    t->countdown = period_ms;
+    return true;
+}
+
+uint8_t Sched_TaskCount(void)
+{
+    return s_count;
+}
+
+/* 第 idx 个任务的周期（ms），用于启动信息与 ScanTimer 标称周期 */
+uint16_t Sched_TaskPeriod(uint8_t idx)
+{
+    return (idx < s_count) ? s_tasks[idx].period_ms : 0u;
+}
+
+/* SysTick_Handler 每 1ms 调用一次 */
+void Sched_Tick(void)
+{
+    for (uint8_t i = 0u; i < s_count; i++) {
+        SchedTask_t *t = &s_tasks[i];
+        if (--t->countdown != 0u) {
+            continue;
+        }
+        t->countdown = t->period_ms;
+        if (t->running) {
+            t->overruns++;
+        } else if (t->pending) {
+            t->missed++;
+        }
+        t->pending = true;
+    }
+}
+
+/* 是否有任务就绪（主循环据此决定是否继续处理 UART）*/
+bool Sched_Pending(void)
+{
+    for (uint8_t i = 0u; i < s_count; i++) {
+        if (s_tasks[i].pending) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* 执行优先级最高的就绪任务（数值最小；同优先级按注册顺序）*/
+void Sched_RunNext(void)
+{
+    SchedTask_t *best = NULL;
+    uint8_t      idx  = 0u;
+
+    __disable_irq();
+    for (uint8_t i = 0u; i < s_count; i++) {
+        SchedTask_t *t = &s_tasks[i];
+        if (t->pending && (best == NULL || t->priority < best->priority)) {
+            best = t;
+            idx  = i;
+        }
+    }
+    if (best != NULL) {
+        best->pending = false;
+        best->running = true;
+    }
+    __enable_irq();
+
+    if (best == NULL) {
+        return;
+    }
+
+    uint32_t t0 = ScanTimer_Now();
+    best->run();
+    uint32_t t1 = ScanTimer_Now();
+
+    best->running = false;
+    best->runs++;
+
+    uint32_t us;
+    if (idx == 0u) {
+        us = ScanTimer_Record(t0, t1);
+        plc_scan_time_us = us;
+    } else {
+        us = ScanTimer_ElapsedUs(t0, t1);
+    }
+    if (us > best->max_us) {
+        best->max_us = us;
+    }
+}
+
+/* PLC 停止时调用：丢弃所有就绪触发，不计入 missed */
+void Sched_Discard(void)
+{
+    __disable_irq();
+    for (uint8_t i = 0u; i < s_count; i++) {
+        s_tasks[i].pending = false;
+    }
+    __enable_irq();
+    ScanTimer_Pause();
+}
+
+void Sched_ResetStats(void)
+{
+    __disable_irq();
+    for (uint8_t i = 0u; i < s_count; i++) {
+        s_tasks[i].runs     = 0u;
+        s_tasks[i].overruns = 0u;
+        s_tasks[i].missed   = 0u;
+        s_tasks[i].max_us   = 0u;
+    }
+    __enable_irq();
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v & 0xFFu);
+    p[1] = (uint8_t)(v >> 8u);
+    p[2] = (uint8_t)(v >> 16u);
+    p[3] = (uint8_t)(v >> 24u);
+    return p + 4;
+}
+
+/*
+ * 序列化任务统计（GET_TASKS 响应载荷），返回写入字节数
+ *   [count:1] + count × [period_ms:2][priority:1][rsv:1]
+ *                       [runs:4][overruns:4][missed:4][max_us:4]，均为小端
+ */
+uint16_t Sched_Serialize(uint8_t *buf)
+{
+    uint8_t *p = buf;
+    *p++ = s_count;
+    for (uint8_t i = 0u; i < s_count; i++) {
+        const SchedTask_t *t = &s_tasks[i];
+        p[0] = (uint8_t)(t->period_ms & 0xFFu);
+        p[1] = (uint8_t)(t->period_ms >> 8u);
+        p[2] = t->priority;
+        p[3] = 0u;
+        p = put_u32(p + 4, t->runs);
+        p = put_u32(p, t->overruns);
+        p = put_u32(p, t->missed);
+        p = put_u32(p, t->max_us);
+    }
+    return (uint16_t)(p - buf);
+}
@@ -0,0 +1,168 @@
+/*
+ * app/uart_io.c — 中断驱动的 UART 收发环形缓冲
+ *
+ * 取代主循环中每轮一次的 Board_UARTGetChar() 轮询：
+ *   RX — UART1 中断把字节搬进 RX 环形缓冲，user->loop() 执行期间也不会因
+ *        UART 单字节接收寄存器来不及读取而丢字节。
+ *   TX — 发送数据先进入 TX 环形缓冲，由 TXRDY 中断逐字节送出；
+ *        定义 UART_TX_DMA=1 时改用 DMA 通道 3（USART1_TX）按连续段整块搬运，
+ *        CPU 只在每段结束时进一次 DMA 中断。
+ *
+ * 主循环通过 UartIO_Read() 批量取出字节交给协议状态机，见 main.c。
+ *
+ * DEBUG_UART 固定为 USART1（board.h），因此中断入口为 UART1_IRQHandler。
+ */
+
+#include "bsp/lpc_chip/board.h"
+
+/* -----------------------------------------------------------------------
+ * 配置
+ * -----------------------------------------------------------------------*/
+#ifndef UART_TX_DMA
+#define UART_TX_DMA         0      /* 1 = TX 使用 DMA（占用 Chip_DMA_Table，512B 对齐）*/
+#endif
+
+#define UART_RX_RB_SIZE     512u   /* 必须为 2 的幂；≥ 1 帧 WRITE_PAGE (265B) */
+#define UART_TX_RB_SIZE     128u   /* 必须为 2 的幂 */
+
+#if UART_TX_DMA
+#define UART_TX_DMA_CH      DMAREQ_USART1_TX
+#endif
+
+/* -----------------------------------------------------------------------
+ * 内部状态
+ * -----------------------------------------------------------------------*/
+static RINGBUFF_T s_rx_rb;
+static RINGBUFF_T s_tx_rb;
+static uint8_t    s_rx_mem[UART_RX_RB_SIZE];
+static uint8_t    s_tx_mem[UART_TX_RB_SIZE];
+
+#if UART_TX_DMA
+static volatile uint32_t s_dma_len = 0u;   /* 正在传输的字节数，0 = DMA 空闲 */
+
+/* 从 TX 环形缓冲尾部取一段连续数据启动 DMA（调用方保证 DMA 中断不会并发）*/
+static void tx_dma_kick(void)
+{
+    if (s_dma_len != 0u || RingBuffer_IsEmpty(&s_tx_rb)) {
+        return;
+    }
+    uint32_t idx = s_tx_rb.tail & (UART_TX_RB_SIZE - 1u);
+    uint32_t n   = (uint32_t)RingBuffer_GetCount(&s_tx_rb);
+    if (idx + n > UART_TX_RB_SIZE) {
+        n = UART_TX_RB_SIZE - idx;   /* 只搬到缓冲末尾，回绕部分下一段再发 */
+    }
+
+    DMA_CHDESC_T desc;
+    desc.xfercfg = 0u;
+    desc.source  = DMA_ADDR(&s_tx_mem[idx + n - 1u]);   /* LPC8xx DMA 使用末地址 */
+    desc.dest    = DMA_ADDR(&DEBUG_UART->TXDATA);
+    desc.next    = DMA_ADDR(0);
+
+    s_dma_len = n;
+    Chip_DMA_SetupTranChannel(LPC_DMA, UART_TX_DMA_CH, &desc);
+    Chip_DMA_SetupChannelTransfer(LPC_DMA, UART_TX_DMA_CH,
+        DMA_XFERCFG_CFGVALID | DMA_XFERCFG_SETINTA | DMA_XFERCFG_SWTRIG |
+        DMA_XFERCFG_WIDTH_8 | DMA_XFERCFG_SRCINC_1 | DMA_XFERCFG_DSTINC_0 |
+        DMA_XFERCFG_XFERCOUNT(n));
+}
+
+void DMA_IRQHandler(void)
+{
+    if (Chip_DMA_GetActiveIntAChannels(LPC_DMA) & (1u << UART_TX_DMA_CH)) {
+        Chip_DMA_ClearActiveIntAChannel(LPC_DMA, UART_TX_DMA_CH);
+        s_tx_rb.tail += s_dma_len;
+        s_dma_len = 0u;
+        tx_dma_kick();
+    }
+}
+#endif /* UART_TX_DMA */
+
+/* -----------------------------------------------------------------------
+ * UART1 中断：RX 入队；非 DMA 模式下同时负责 TX 出队
+ * -----------------------------------------------------------------------*/
+void UART1_IRQHandler(void)
+{
+    /* RX 缓冲满时新字节被丢弃，由上层帧 CRC 检出 */
+    Chip_UART_RXIntHandlerRB(DEBUG_UART, &s_rx_rb);
+
+#if !UART_TX_DMA
+    if ((Chip_UART_GetIntsEnabled(DEBUG_UART) & UART_INTEN_TXRDY) != 0u) {
+        Chip_UART_TXIntHandlerRB(DEBUG_UART, &s_tx_rb);
+        if (RingBuffer_IsEmpty(&s_tx_rb)) {
+            Chip_UART_IntDisable(DEBUG_UART, UART_INTEN_TXRDY);
+        }
+    }
+#endif
+}
+
+/* -----------------------------------------------------------------------
+ * 公开接口
+ * -----------------------------------------------------------------------*/
+
+/* 在 Board_Init() 之后调用：挂接环形缓冲并打开 UART（及 DMA）中断 */
+void UartIO_Init(void)
+{
+    RingBuffer_Init(&s_rx_rb, s_rx_mem, 1, UART_RX_RB_SIZE);
+    RingBuffer_Init(&s_tx_rb, s_tx_mem, 1, UART_TX_RB_SIZE);
+
+#if UART_TX_DMA
+    Chip_DMA_Init(LPC_DMA);
+    Chip_DMA_Enable(LPC_DMA);
+    Chip_DMA_SetSRAMBase(LPC_DMA, DMA_ADDR(Chip_DMA_Table));
+    Chip_DMA_EnableChannel(LPC_DMA, UART_TX_DMA_CH);
+    Chip_DMA_EnableIntChannel(LPC_DMA, UART_TX_DMA_CH);
+    Chip_DMA_SetupChannelConfig(LPC_DMA, UART_TX_DMA_CH,
+        DMA_CFG_PERIPHREQEN | DMA_CFG_TRIGBURST_SNGL | DMA_CFG_CHPRIORITY(3));
+    NVIC_EnableIRQ(DMA_IRQn);
+#endif
+
+    Chip_UART_IntEnable(DEBUG_UART, UART_INTEN_RXRDY);
+    NVIC_EnableIRQ(UART1_IRQn);
+}
+
+/* 非阻塞读取：最多取 max 字节，返回实际字节数 */
+uint16_t UartIO_Read(uint8_t *buf, uint16_t max)
+{
+    return (uint16_t)RingBuffer_PopMult(&s_rx_rb, buf, max);
+}
+
+/* 写入 TX 缓冲；缓冲满时等待中断腾出空间 */
+void UartIO_Write(const uint8_t *data, uint16_t len)
+{
+    while (len > 0u) {
+        uint32_t n;
+#if UART_TX_DMA
+        NVIC_DisableIRQ(DMA_IRQn);
+        n = (uint32_t)RingBuffer_InsertMult(&s_tx_rb, data, len);
+        tx_dma_kick();
+        NVIC_EnableIRQ(DMA_IRQn);
+#else
+        n = Chip_UART_SendRB(DEBUG_UART, &s_tx_rb, data, len);
+#endif
+        data += n;
+        len  -= (uint16_t)n;
+    }
+}
+
+void UartIO_PutChar(uint8_t ch)
+{
+    UartIO_Write(&ch, 1u);
+}
+
+void UartIO_PutStr(const char *s)
+{
+    uint16_t n = 0u;
+    while (s[n] != '\0') {
+        n++;
+    }
+    UartIO_Write((const uint8_t *)s, n);
+}
+
+/* 等待 TX 缓冲与移位寄存器全部发完（复位前调用）*/
+void UartIO_Flush(void)
+{
+    while (!RingBuffer_IsEmpty(&s_tx_rb)) {
+    }
+    while ((Chip_UART_GetStatus(DEBUG_UART) & UART_STAT_TXIDLE) == 0u) {
+    }
+}
@@ -6,11 +6,20 @@
  *   而是通过 WAMR (WebAssembly Micro Runtime) 加载并执行 B 区的 .wasm 字节码。
  *
  * B 区内存布局（XCODE 模式）：
- *   Flash B (0x00004000): [4字节魔数 XCODE_MAGIC][4字节wasm大小][wasm字节码...]
+ *   Flash B (0x00004000): [4字节魔数][4字节镜像大小][.wasm 字节码 或 WAMR AOT 镜像...]
+ *   魔数 XCODE_WASM_MAGIC = 解释执行的 .wasm；XCODE_AOT_MAGIC = wamrc 预编译的 AOT 镜像
+ *   （需以 make MODE=XCODE WAMR_AOT=1 构建，AOT 镜像用 wamrc --xip 生成以便直接在 Flash 中执行）
  *
  * .wasm 导出接口（由 editor 的 plc_wasm_main.c 生成）：
  *   plc_init()       — PLC 初始化，调用一次
  *   plc_run(uint32)  — PLC 扫描周期，参数为当前时间(ms)
+ *   plc_image()      — 过程映像（XcodeImage_t）在线性内存中的偏移；可选
+ *
+ * 过程映像：模块的 located 变量直接指向其线性内存中的 XcodeImage_t，
+ *   初始化时调用一次 plc_image() 取得偏移并校验布局；每个扫描周期
+ *   plc_run 前把 image->inputs 写入 ix[]，返回后从 qx[] 收集 image->outputs。
+ *   不为单个变量注册 host function，扫描中没有额外的 WASM↔原生切换。
+ *   未导出 plc_image 的旧模块照常运行，但没有 I/O。
  *
  * 编译条件：仅在 MODE=XCODE 时编译（Makefile 控制）
  */
@@ -24,14 +33,35 @@
  * XCODE B 区头部魔数（与 NCC 的 USER_LOGIC_MAGIC 区分）
  * -----------------------------------------------------------------------*/
 #define XCODE_WASM_MAGIC    0x57415300U  /* "WAS\0" */
+#define XCODE_AOT_MAGIC     0x414F5400U  /* "AOT\0" */
 
 /* B 区头部结构（XCODE 模式下 Flash B 起始处的布局）*/
 typedef struct {
-    uint32_t magic;       /* XCODE_WASM_MAGIC */
+    uint32_t magic;       /* XCODE_WASM_MAGIC / XCODE_AOT_MAGIC */
     uint32_t wasm_size;   /* .wasm 字节码大小（字节）*/
     /* 紧随其后：wasm_size 字节的 .wasm 内容 */
 } XcodeHeader_t;
 
+/* -----------------------------------------------------------------------
+ * WASM 侧过程映像（与 editor 模板 plc_wasm_main.c 的 PlcImage_t 一致）
+ *   %IX0.n → ix[n]，%QX0.n → qx[n]，BOOL 占 1 字节
+ * -----------------------------------------------------------------------*/
+#define XCODE_IMAGE_MAGIC   0x58494D47U  /* "XIMG" */
+#define XCODE_IMAGE_VERSION 1U
+#define XCODE_IMAGE_X       256u
+#define XCODE_IMAGE_W       64u
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;        /* sizeof(XcodeImage_t) */
+    uint32_t reserved;
+    uint8_t  ix[XCODE_IMAGE_X];
+    uint8_t  qx[XCODE_IMAGE_X];
+    uint16_t iw[XCODE_IMAGE_W];
+    uint16_t qw[XCODE_IMAGE_W];
+} XcodeImage_t;
+
 /* -----------------------------------------------------------------------
  * WAMR 运行时状态
  * -----------------------------------------------------------------------*/
@@ -44,27 +74,75 @@ static wasm_module_inst_t s_inst      = NULL;
 static wasm_exec_env_t   s_exec_env  = NULL;
 static wasm_function_inst_t s_fn_init = NULL;
 static wasm_function_inst_t s_fn_run  = NULL;
+static uint32_t          s_image_off = 0u;  /* 过程映像的线性内存偏移，0 = 模块未导出 */
+static ProcessImage_t   *s_pimage    = NULL;
 
 static bool s_ready = false;
 
+/* -----------------------------------------------------------------------
+ * 过程映像
+ * -----------------------------------------------------------------------*/
+static void image_bind(void)
+{
+    wasm_function_inst_t fn = wasm_runtime_lookup_function(s_inst, "plc_image", NULL);
+    uint32_t argv[1] = { 0u };
+    const XcodeImage_t *img;
+
+    if (!fn) return;
+    if (!wasm_runtime_call_wasm(s_exec_env, fn, 0, argv)) {
+        wasm_runtime_clear_exception(s_inst);
+        return;
+    }
+    if (argv[0] == 0u || !wasm_runtime_validate_app_addr(s_inst, argv[0], sizeof(XcodeImage_t))) {
+        return;
+    }
+    img = (const XcodeImage_t *)wasm_runtime_addr_app_to_native(s_inst, argv[0]);
+    if (img->magic != XCODE_IMAGE_MAGIC || img->version != XCODE_IMAGE_VERSION ||
+        img->size != sizeof(XcodeImage_t)) {
+        return;  /* 布局不一致：宁可不接 I/O，也不写错位置 */
+    }
+    s_image_off = argv[0];
+}
+
+/* 线性内存可能因 memory.grow 重新分配，每次扫描按偏移重新换算（仅一次加法） */
+static void image_in(void)
+{
+    XcodeImage_t *img = (XcodeImage_t *)wasm_runtime_addr_app_to_native(s_inst, s_image_off);
+    uint32_t in = s_pimage->inputs;
+    for (uint8_t i = 0u; i < PLC_DI_COUNT; i++) {
+        img->ix[i] = (uint8_t)((in >> i) & 1u);
+    }
+}
+
+static void image_out(void)
+{
+    const XcodeImage_t *img = (const XcodeImage_t *)wasm_runtime_addr_app_to_native(s_inst, s_image_off);
+    uint32_t out = 0u;
+    for (uint8_t i = 0u; i < PLC_DO_COUNT; i++) {
+        if (img->qx[i]) out |= (1u << i);
+    }
+    s_pimage->outputs = out;
+}
+
 /* -----------------------------------------------------------------------
  * xcode_runner_init — 初始化 WAMR 并加载 B 区 .wasm
  *
  * 参数：
- *   api  — Runtime A 提供的 System API 函数表（暂留，供未来 host function 使用）
+ *   api  — Runtime A 提供的 System API 函数表（api->image 与 WASM 过程映像交换）
  *
  * 返回：true = 成功，false = B 区没有合法 .wasm 或 WAMR 初始化失败
  * -----------------------------------------------------------------------*/
 bool xcode_runner_init(const SystemAPI_t *api)
 {
-    (void)api;  /* 预留：未来用于注册 WASM host function（如 set_do / get_di）*/
-
     /* 1. 检查 B 区头部 */
     const XcodeHeader_t *hdr = (const XcodeHeader_t *)USER_FLASH_BASE;
     if (hdr->magic != XCODE_WASM_MAGIC) {
+#if WASM_ENABLE_AOT
+        if (hdr->magic != XCODE_AOT_MAGIC)
+#endif
         return false;  /* B 区没有合法 XCODE 固件 */
     }
-    if (hdr->wasm_size == 0u || hdr->wasm_size > (USER_FLASH_SIZE - sizeof(XcodeHeader_t))) {
+    if (hdr->wasm_size == 0u || hdr->wasm_size > (USER_IMAGE_MAX_SIZE - sizeof(XcodeHeader_t))) {
         return false;  /* 大小不合法 */
     }
 
@@ -82,7 +160,7 @@ bool xcode_runner_init(const SystemAPI_t *api)
         return false;
     }
 
-    /* 3. 加载 .wasm 模块 */
+    /* 3. 加载模块（wasm_runtime_load 按内容头 "\0asm" / "\0aot" 区分字节码与 AOT 镜像） */
     char error_buf[64];
     s_module = wasm_runtime_load(wasm_buf, wasm_size, error_buf, sizeof(error_buf));
     if (!s_module) {
@@ -122,6 +200,10 @@ bool xcode_runner_init(const SystemAPI_t *api)
         return false;
     }
 
+    /* 8. 绑定过程映像（可选） */
+    s_pimage = api->image;
+    image_bind();
+
     s_ready = true;
     return true;
 }
@@ -131,14 +213,20 @@ bool xcode_runner_init(const SystemAPI_t *api)
  *
  * 参数：
  *   tick_ms — 当前系统时间（毫秒），传给 WASM 的 plc_run(ms)
+ *
+ * 调用前 main.c 已锁存 DI 到 api->image，返回后由 main.c 输出 DO。
  * -----------------------------------------------------------------------*/
 void xcode_runner_loop(uint32_t tick_ms)
 {
     if (!s_ready) return;
 
+    if (s_image_off) image_in();
+
     /* 调用 plc_run(uint32_t ms) */
     uint32_t argv[1] = { tick_ms };
     wasm_runtime_call_wasm(s_exec_env, s_fn_run, 1, argv);
+
+    if (s_image_off) image_out();
 }
 
 #endif /* XCODE_MODE */
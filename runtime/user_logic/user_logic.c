@@ -75,11 +75,10 @@ static void loop(void)
 
     /* ---- 用户逻辑开始 ---- */
 
-    /* 示例：DI0-DI3 直通 DO0-DO3 */
-    for (uint8_t i = 0u; i < PLC_DI_COUNT && i < PLC_DO_COUNT; i++) {
-        bool di_val = g_api->get_di(i);
-        g_api->set_do(i, di_val);
-    }
+    /* 示例：DI0-DI3 直通 DO0-DO3
+     * 直接读写过程映像：Runtime A 已在本周期开始前锁存输入，结束后统一输出 */
+    ProcessImage_t *img = g_api->image;
+    img->outputs = img->inputs & ((1u << PLC_DO_COUNT) - 1u);
 
     /* ---- 用户逻辑结束 ---- */
 }
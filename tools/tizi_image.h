@@ -0,0 +1,133 @@
+/* TiZi Linux 运行时 — POSIX 共享内存过程映像
+ *
+ * 运行时（plc_main.c）创建 shm 对象（默认 "/tizi_image"，环境变量 TIZI_SHM 覆盖），
+ * matiec 的 located 变量指针直接指向映射内的对应单元，扫描中不进系统调用，
+ * %Q / %M 不做拷贝。
+ * 外部 I/O 驱动进程 tizi_image_attach() 后通过下面的辅助函数交换数据。
+ *
+ * 地址映射（每个区按宽度分表，BOOL 占 1 字节，与 matiec 一致）：
+ *   %IXa.b / %QXa.b / %MXa.b → x[a*8+b]
+ *   %IBa → b[a]   %IWa → w[a]   %IDa → d[a]   %ILa → l[a]
+ * 超出范围的地址保留在运行时私有存储，启动时打印警告。
+ *
+ * 一致性：
+ *   %I  驱动侧三缓冲（in_buf[3]）。驱动写后台缓冲后原子交换到中间位置并置新数据标志；
+ *       运行时在扫描开始时若有新数据，把中间缓冲换为前台，并把程序实际引用的
+ *       %I 单元从前台缓冲取到 in（located 指针所指处）。扫描期间 in 不变，
+ *       且总是某一次完整发布的输入。
+ *       （matiec 在 config_init__ 时把 located 指针复制进 POU 实例，
+ *        因此不能靠切换指针换缓冲。）
+ *   %Q / %M  seqlock（out_seq），located 指针直接指向 out / mem。
+ *       扫描期间为奇数，结束后为偶数；驱动用 tizi_out_read() 读取一致快照，
+ *       遇到扫描进行中或读取期间被改写则重试。外部进程只读 %Q / %M。
+ */
+#ifndef TIZI_IMAGE_H
+#define TIZI_IMAGE_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define TIZI_IMAGE_MAGIC    0x5449494DU     /* "TIIM" */
+#define TIZI_IMAGE_VERSION  1U
+#define TIZI_IMAGE_NAME     "/tizi_image"
+
+#define TIZI_IMG_X   1024    /* %?X0.0 .. %?X127.7 */
+#define TIZI_IMG_B   1024
+#define TIZI_IMG_W   1024
+#define TIZI_IMG_D   512
+#define TIZI_IMG_L   256
+
+typedef struct {
+    uint64_t l[TIZI_IMG_L];
+    uint32_t d[TIZI_IMG_D];
+    uint16_t w[TIZI_IMG_W];
+    uint8_t  b[TIZI_IMG_B];
+    uint8_t  x[TIZI_IMG_X];
+} TiziArea_t;
+
+#define TIZI_IN_NEW   4U     /* in_state：bit0-1 = 中间缓冲序号，bit2 = 有未取走的新数据 */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;           /* sizeof(TiziImage_t)，双方据此校验布局 */
+    int32_t  owner_pid;      /* 运行时进程号 */
+    uint64_t scan_count;     /* 每次扫描结束 +1 */
+    uint32_t in_state;       /* %I 三缓冲交换字 */
+    uint32_t in_front;       /* 运行时当前持有的 in_buf 序号 */
+    uint32_t out_seq;        /* %Q / %M seqlock */
+    uint32_t reserved[9];
+    TiziArea_t in_buf[3];    /* %I 驱动写入的三缓冲 */
+    TiziArea_t in;           /* %I 扫描所见（运行时写） */
+    TiziArea_t out;          /* %Q */
+    TiziArea_t mem;          /* %M */
+} TiziImage_t;
+
+/* ── 外部驱动侧 ─────────────────────────────────────────────── */
+
+/* 映射运行时创建的映像；运行时未启动或布局不一致返回 0 */
+static inline TiziImage_t *tizi_image_attach(const char *name) {
+    TiziImage_t *img;
+    int fd = shm_open(name ? name : TIZI_IMAGE_NAME, O_RDWR, 0);
+    if (fd < 0) return 0;
+    img = (TiziImage_t *)mmap(0, sizeof(TiziImage_t), PROT_READ | PROT_WRITE,
+                              MAP_SHARED, fd, 0);
+    close(fd);
+    if (img == MAP_FAILED) return 0;
+    if (img->magic != TIZI_IMAGE_MAGIC || img->version != TIZI_IMAGE_VERSION ||
+        img->size != sizeof(TiziImage_t)) {
+        munmap(img, sizeof(TiziImage_t));
+        return 0;
+    }
+    return img;
+}
+
+/* %I 写者状态（每个映像仅允许一个写者） */
+typedef struct {
+    unsigned back;           /* 当前可写缓冲 */
+    unsigned last;           /* 上次发布的缓冲 */
+} TiziInWriter_t;
+
+static inline void tizi_in_writer_init(TiziImage_t *img, TiziInWriter_t *w) {
+    unsigned mid, front;
+    /* 运行时交换时先改 in_state 再改 in_front，两者相等说明正处于交换中，重读 */
+    do {
+        mid   = __atomic_load_n(&img->in_state, __ATOMIC_ACQUIRE) & 3U;
+        front = __atomic_load_n(&img->in_front, __ATOMIC_ACQUIRE);
+    } while (mid == front || mid != (__atomic_load_n(&img->in_state, __ATOMIC_ACQUIRE) & 3U));
+    w->back = 3U - mid - front;
+    w->last = mid;
+}
+
+/* 取得可写缓冲，内容为上次发布的输入（只改部分输入的驱动无需自行保存全量） */
+static inline TiziArea_t *tizi_in_begin(TiziImage_t *img, TiziInWriter_t *w) {
+    if (w->last != w->back)
+        memcpy(&img->in_buf[w->back], &img->in_buf[w->last], sizeof(TiziArea_t));
+    return &img->in_buf[w->back];
+}
+
+/* 发布：后台缓冲与中间缓冲交换，下一次扫描开始时生效 */
+static inline void tizi_in_commit(TiziImage_t *img, TiziInWriter_t *w) {
+    const uint32_t old = __atomic_exchange_n(&img->in_state, w->back | TIZI_IN_NEW,
+                                             __ATOMIC_ACQ_REL);
+    w->last = w->back;
+    w->back = old & 3U;
+}
+
+/* %Q / %M 一致快照；q、m 可为 0 */
+static inline void tizi_out_read(const TiziImage_t *img, TiziArea_t *q, TiziArea_t *m) {
+    uint32_t s;
+    for (;;) {
+        s = __atomic_load_n(&img->out_seq, __ATOMIC_ACQUIRE);
+        if (s & 1U) continue;
+        if (q) memcpy(q, (const void *)&img->out, sizeof(TiziArea_t));
+        if (m) memcpy(m, (const void *)&img->mem, sizeof(TiziArea_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&img->out_seq, __ATOMIC_RELAXED) == s) return;
+    }
+}
+
+#endif /* TIZI_IMAGE_H */
@@ -0,0 +1,45 @@
+#!/bin/sh
+# 比较同一 PLC 程序在 WAMR 经典解释器、快速解释器和 AOT 下的扫描耗时
+#
+# 用法：tools/xcode_bench.sh <plc_program.wasm> [N]
+#
+# 环境变量：
+#   WAMR_ROOT  WAMR 源码目录（默认 library/wasm）
+#   WAMRC      wamrc 路径（默认 PATH 中的 wamrc）
+#   OUT        中间产物目录（默认 /tmp/tizi_xcode_bench）
+set -e
+
+WASM=$1
+N=${2:-100000}
+if [ -z "$WASM" ] || [ ! -f "$WASM" ]; then
+    echo "usage: $0 <plc_program.wasm> [N]" >&2
+    exit 2
+fi
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WAMR_ROOT=${WAMR_ROOT:-$ROOT/library/wasm}
+WAMRC=${WAMRC:-wamrc}
+OUT=${OUT:-/tmp/tizi_xcode_bench}
+mkdir -p "$OUT"
+
+# 以指定解释器类型构建 libvmlib，再链接 xcode_host（AOT 加载器两种构建都带）
+build_host() {
+    name=$1
+    shift
+    cmake -S "$WAMR_ROOT/product-mini/platforms/linux" -B "$OUT/$name" \
+        -DCMAKE_BUILD_TYPE=Release -DWAMR_BUILD_AOT=1 -DWAMR_BUILD_JIT=0 \
+        -DWAMR_BUILD_FAST_JIT=0 -DWAMR_BUILD_LIBC_WASI=1 "$@" > /dev/null
+    cmake --build "$OUT/$name" --target vmlib -j > /dev/null
+    cc -O2 -o "$OUT/xcode_host_$name" "$ROOT/tools/xcode_host.c" \
+        -I"$WAMR_ROOT/core/iwasm/include" "$OUT/$name/libvmlib.a" -lm -lpthread -ldl
+}
+
+echo "building hosts (WAMR: $WAMR_ROOT) ..."
+build_host classic -DWAMR_BUILD_FAST_INTERP=0
+build_host fast    -DWAMR_BUILD_FAST_INTERP=1
+"$WAMRC" --opt-level=3 -o "$OUT/plc_program.aot" "$WASM" > /dev/null
+
+echo "$WASM, $N scans each:"
+printf '  %-12s ' "interp";      "$OUT/xcode_host_classic" "$WASM" --bench "$N" 2> /dev/null
+printf '  %-12s ' "fast-interp"; "$OUT/xcode_host_fast"    "$WASM" --bench "$N" 2> /dev/null
+printf '  %-12s ' "aot";         "$OUT/xcode_host_fast"    "$OUT/plc_program.aot" --bench "$N" 2> /dev/null
@@ -0,0 +1,235 @@
+/*
+ * xcode_host.c — XCODE 模块的 Linux 宿主运行器 / 扫描耗时基准
+ *
+ * 加载 editor 生成的 plc_program.wasm，或 wamrc 预编译的 plc_program.aot
+ * （wasm_runtime_load 按文件头 "\0asm" / "\0aot" 自动区分）。
+ * 约定与 runtime/app/xcode_runner.c 相同：
+ *   plc_init()       — 调用一次
+ *   plc_run(uint32)  — 每个扫描周期调用一次，参数为当前时间（ms）
+ *   plc_image()      — 过程映像偏移（可选）；每次扫描前写 %IX0.0..%IX3.7，
+ *                      扫描后读 %QX0.0..%QX3.7
+ *
+ * 用法：
+ *   xcode_host <file> [period_ms]     周期运行（默认 10 ms），%QX 变化时打印
+ *   xcode_host <file> --bench [N]     连续调用 plc_run N 次（默认 100000），输出单次扫描耗时
+ *
+ * 经典解释器 / 快速解释器由链接的 libvmlib 编译选项（WAMR_BUILD_FAST_INTERP）决定，
+ * 三种方式的对比见 xcode_bench.sh。
+ *
+ * 环境变量 TIZI_XCODE_DI：%IX0.0..%IX3.7 的输入值（十六进制位图，默认 0）
+ *
+ * 编译：cc -O2 xcode_host.c -I$WAMR_ROOT/core/iwasm/include libvmlib.a -lm -lpthread -ldl
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "wasm_export.h"
+
+#define WASM_STACK_SIZE  (64u * 1024u)
+#define WASM_HEAP_SIZE   (64u * 1024u)
+
+/* 与 editor 模板 plc_wasm_main.c 的 PlcImage_t 一致 */
+#define XCODE_IMAGE_MAGIC   0x58494D47U  /* "XIMG" */
+#define XCODE_IMAGE_VERSION 1U
+#define XCODE_IMAGE_X       256u
+#define XCODE_IMAGE_W       64u
+#define HOST_IO_BITS        32u
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t reserved;
+    uint8_t  ix[XCODE_IMAGE_X];
+    uint8_t  qx[XCODE_IMAGE_X];
+    uint16_t iw[XCODE_IMAGE_W];
+    uint16_t qw[XCODE_IMAGE_W];
+} XcodeImage_t;
+
+static wasm_exec_env_t      s_exec_env;
+static wasm_function_inst_t s_fn_run;
+static wasm_module_inst_t   s_inst;
+static uint32_t             s_image_off;   /* 0 = 模块未导出过程映像 */
+static uint32_t             s_inputs;
+static uint32_t             s_outputs;
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static uint8_t *read_file(const char *path, uint32_t *size) {
+    FILE    *f = fopen(path, "rb");
+    uint8_t *buf;
+    long     n;
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = (uint8_t *)malloc(n > 0 ? (size_t)n : 1u);
+    if (buf && fread(buf, 1, (size_t)n, f) != (size_t)n) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    *size = (uint32_t)n;
+    return buf;
+}
+
+/* 调用 plc_image() 一次，校验布局后记下偏移 */
+static void image_bind(void) {
+    wasm_function_inst_t fn = wasm_runtime_lookup_function(s_inst, "plc_image", NULL);
+    uint32_t             argv[1] = { 0 };
+    const XcodeImage_t  *img;
+    if (!fn) {
+        fprintf(stderr, "module does not export plc_image, running without I/O\n");
+        return;
+    }
+    if (!wasm_runtime_call_wasm(s_exec_env, fn, 0, argv) || argv[0] == 0 ||
+        !wasm_runtime_validate_app_addr(s_inst, argv[0], sizeof(XcodeImage_t))) {
+        fprintf(stderr, "plc_image: invalid image\n");
+        wasm_runtime_clear_exception(s_inst);
+        return;
+    }
+    img = (const XcodeImage_t *)wasm_runtime_addr_app_to_native(s_inst, argv[0]);
+    if (img->magic != XCODE_IMAGE_MAGIC || img->version != XCODE_IMAGE_VERSION ||
+        img->size != sizeof(XcodeImage_t)) {
+        fprintf(stderr, "plc_image: layout mismatch (magic %08x, size %u)\n", img->magic, img->size);
+        return;
+    }
+    s_image_off = argv[0];
+}
+
+static int plc_run(uint32_t ms) {
+    uint32_t      argv[1] = { ms };
+    XcodeImage_t *img = NULL;
+    uint32_t      i, out = 0;
+    if (s_image_off) {
+        img = (XcodeImage_t *)wasm_runtime_addr_app_to_native(s_inst, s_image_off);
+        for (i = 0; i < HOST_IO_BITS; i++) img->ix[i] = (uint8_t)((s_inputs >> i) & 1u);
+    }
+    if (!wasm_runtime_call_wasm(s_exec_env, s_fn_run, 1, argv)) {
+        fprintf(stderr, "plc_run: %s\n", wasm_runtime_get_exception(s_inst));
+        return -1;
+    }
+    if (img) {
+        /* 线性内存可能在 plc_run 中增长并搬移，重新换算 */
+        img = (XcodeImage_t *)wasm_runtime_addr_app_to_native(s_inst, s_image_off);
+        for (i = 0; i < HOST_IO_BITS; i++)
+            if (img->qx[i]) out |= 1u << i;
+        s_outputs = out;
+    }
+    return 0;
+}
+
+static int cmp_i64(const void *a, const void *b) {
+    const int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* 连续执行 n 次扫描，输出 min / avg / p99 / max（ns） */
+static int run_bench(uint32_t n) {
+    int64_t *t = (int64_t *)malloc(sizeof(int64_t) * n);
+    int64_t  t0, sum = 0;
+    uint32_t i;
+    if (!t) return 1;
+    for (i = 0; i < n; i++) {
+        t0 = now_ns();
+        if (plc_run(i) != 0) return 1;
+        t[i] = now_ns() - t0;
+        sum += t[i];
+    }
+    qsort(t, n, sizeof(int64_t), cmp_i64);
+    printf("scans=%u min_ns=%lld avg_ns=%lld p99_ns=%lld max_ns=%lld\n", n,
+           (long long)t[0], (long long)(sum / n), (long long)t[(uint64_t)n * 99u / 100u],
+           (long long)t[n - 1]);
+    free(t);
+    return 0;
+}
+
+static int run_cyclic(uint32_t period_ms) {
+    const int64_t   period = (int64_t)period_ms * 1000000LL;
+    const int64_t   t0     = now_ns();
+    struct timespec ts;
+    int64_t         deadline;
+    uint64_t        k;
+    uint32_t        last = 0;
+    for (k = 0;; k++) {
+        deadline   = t0 + (int64_t)k * period;
+        ts.tv_sec  = (time_t)(deadline / 1000000000LL);
+        ts.tv_nsec = (long)(deadline % 1000000000LL);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        if (plc_run((uint32_t)((deadline - t0) / 1000000LL)) != 0) return 1;
+        if (s_outputs != last) {
+            printf("%llu ms: QX=%08x\n", (unsigned long long)((deadline - t0) / 1000000LL), s_outputs);
+            fflush(stdout);
+            last = s_outputs;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char                 error_buf[128];
+    RuntimeInitArgs      init_args;
+    wasm_module_t        module;
+    wasm_function_inst_t fn_init;
+    uint8_t             *buf;
+    uint32_t             size;
+    int                  bench = argc > 2 && strcmp(argv[2], "--bench") == 0;
+    const char          *di    = getenv("TIZI_XCODE_DI");
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <plc_program.wasm|.aot> [period_ms | --bench [N]]\n", argv[0]);
+        return 2;
+    }
+    buf = read_file(argv[1], &size);
+    if (!buf) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    memset(&init_args, 0, sizeof(init_args));
+    init_args.mem_alloc_type = Alloc_With_System_Allocator;
+    if (!wasm_runtime_full_init(&init_args)) {
+        fprintf(stderr, "wasm_runtime_full_init failed\n");
+        return 1;
+    }
+
+    module = wasm_runtime_load(buf, size, error_buf, sizeof(error_buf));
+    if (!module) {
+        fprintf(stderr, "load: %s\n", error_buf);
+        return 1;
+    }
+    /* wasi-clang 生成的模块导入 WASI；不开放任何目录和参数 */
+    wasm_runtime_set_wasi_args(module, NULL, 0, NULL, 0, NULL, 0, NULL, 0);
+    s_inst = wasm_runtime_instantiate(module, WASM_STACK_SIZE, WASM_HEAP_SIZE,
+                                      error_buf, sizeof(error_buf));
+    if (!s_inst) {
+        fprintf(stderr, "instantiate: %s\n", error_buf);
+        return 1;
+    }
+
+    fn_init  = wasm_runtime_lookup_function(s_inst, "plc_init", NULL);
+    s_fn_run = wasm_runtime_lookup_function(s_inst, "plc_run",  NULL);
+    if (!fn_init || !s_fn_run) {
+        fprintf(stderr, "module does not export plc_init / plc_run\n");
+        return 1;
+    }
+    s_exec_env = wasm_runtime_create_exec_env(s_inst, WASM_STACK_SIZE);
+    if (!s_exec_env || !wasm_runtime_call_wasm(s_exec_env, fn_init, 0, NULL)) {
+        fprintf(stderr, "plc_init: %s\n", wasm_runtime_get_exception(s_inst));
+        return 1;
+    }
+    image_bind();
+    s_inputs = di ? (uint32_t)strtoul(di, NULL, 16) : 0u;
+    fprintf(stderr, "%s: %s image, %u bytes\n", argv[1],
+            size >= 4 && memcmp(buf, "\0aot", 4) == 0 ? "AOT" : "wasm", size);
+
+    if (bench)
+        return run_bench(argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : 100000u);
+    return run_cyclic(argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 10u);
+}